@@ -0,0 +1,163 @@
+#include "AsynchronousLogger.h"
+#include <Poco/Logger.h>
+#include <chrono>
+
+// Global variables;
+CAsynchronousLogger g_logger; // <-- Writes the messages to the log in the background
+
+// The maximum number of messages waiting to be written
+static const size_t s_bufferCapacity = 8192;
+
+// The maximum number of messages written before checking for dropped messages and stop requests
+static const size_t s_batchSize = 256;
+
+// The longest time the background thread sleeps before checking for new messages
+static const std::chrono::milliseconds s_maxSleepTime(100);
+
+CAsynchronousLogger::CAsynchronousLogger()
+    : m_buffer(s_bufferCapacity)
+{
+}
+
+CAsynchronousLogger::~CAsynchronousLogger()
+{
+    Stop();
+}
+
+void CAsynchronousLogger::Start(bool dropMessagesWhenFull)
+{
+    if (m_running)
+    {
+        return;
+    }
+
+    m_dropMessagesWhenFull = dropMessagesWhenFull;
+    m_stopRequested = false;
+    m_running = true;
+    m_writerThread = std::thread(&CAsynchronousLogger::WriteMessages, this);
+}
+
+void CAsynchronousLogger::Stop()
+{
+    if (!m_running)
+    {
+        return;
+    }
+
+    // new messages are written directly from now on
+    m_running = false;
+    m_stopRequested = true;
+    WakeUpWriter();
+    m_writerThread.join();
+
+    // write the messages which were added while the background thread was finishing
+    WriteRemainingMessages();
+}
+
+void CAsynchronousLogger::Log(Poco::Message::Priority priority, const std::string& text)
+{
+    LogMessage message;
+    message.priority = priority;
+    message.text = text;
+
+    if (!m_running)
+    {
+        Write(message);
+        return;
+    }
+
+    while (!m_buffer.TryPush(message))
+    {
+        if (m_dropMessagesWhenFull)
+        {
+            ++m_droppedMessages;
+            return;
+        }
+        if (!m_running)
+        {
+            // the logger was stopped after this message was started, there is no one left to empty the buffer
+            Write(message);
+            return;
+        }
+
+        // wait for the background thread to make some room
+        WakeUpWriter();
+        std::this_thread::yield();
+    }
+
+    // if the logger was stopped while the message was added, then Stop() may already have
+    //  emptied the buffer and the message must be written from here.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_running)
+    {
+        WriteRemainingMessages();
+        return;
+    }
+
+    if (m_writerSleeping)
+    {
+        WakeUpWriter();
+    }
+}
+
+void CAsynchronousLogger::WriteRemainingMessages()
+{
+    LogMessage message;
+    while (m_buffer.TryPop(message))
+    {
+        Write(message);
+    }
+}
+
+void CAsynchronousLogger::WakeUpWriter()
+{
+    std::lock_guard<std::mutex> lock(m_wakeUpGuard);
+    m_wakeUp.notify_one();
+}
+
+void CAsynchronousLogger::WriteMessages()
+{
+    LogMessage message;
+    while (true)
+    {
+        // write out one batch of messages
+        size_t nWritten = 0;
+        while (nWritten < s_batchSize && m_buffer.TryPop(message))
+        {
+            Write(message);
+            ++nWritten;
+        }
+
+        const size_t nDropped = m_droppedMessages.exchange(0);
+        if (nDropped > 0)
+        {
+            LogMessage dropped;
+            dropped.priority = Poco::Message::PRIO_WARNING;
+            dropped.text = std::to_string(nDropped) + " log messages were dropped since the log could not keep up";
+            Write(dropped);
+        }
+
+        if (nWritten == s_batchSize)
+        {
+            continue; // there are probably more messages waiting
+        }
+        if (m_stopRequested)
+        {
+            return;
+        }
+
+        // sleep until there are new messages
+        std::unique_lock<std::mutex> lock(m_wakeUpGuard);
+        m_writerSleeping = true;
+        m_wakeUp.wait_for(lock, s_maxSleepTime);
+        m_writerSleeping = false;
+    }
+}
+
+void CAsynchronousLogger::Write(const LogMessage& message)
+{
+    Poco::Message pocoMessage("NovacPPP", message.text, message.priority);
+    pocoMessage.setTime(message.time);
+
+    Poco::Logger::get("NovacPPP").log(pocoMessage);
+}
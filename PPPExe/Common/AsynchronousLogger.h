@@ -0,0 +1,74 @@
+#pragma once
+
+#include <PPPLib/ThreadUtils.h>
+#include <Poco/Message.h>
+#include <Poco/Timestamp.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/** <b>CAsynchronousLogger</b> hands the messages shown by ShowMessage and ShowError
+    over to a background thread, which writes them to the Poco logger. The calling
+    thread only puts the message into a lock-free ring buffer and never waits for the
+    logger's locks or for the log files to be written.
+
+    The time of each message is taken when the message is created, such that the
+    log shows when things happened and not when the message was written. The background
+    thread writes the messages in batches and sleeps while there is nothing to write.
+    When the buffer is full, the calling thread either waits for free space or the
+    message is dropped (and the number of dropped messages is logged later on). */
+class CAsynchronousLogger
+{
+public:
+    CAsynchronousLogger();
+    ~CAsynchronousLogger();
+
+    /** Starts the background thread.
+        @param dropMessagesWhenFull if true then messages are dropped when the buffer is full,
+            otherwise the calling thread waits until there is free space in the buffer. */
+    void Start(bool dropMessagesWhenFull);
+
+    /** Writes all remaining messages and stops the background thread. */
+    void Stop();
+
+    /** Logs the given message. The message is written by the background thread
+        if that is running, otherwise it is written directly. */
+    void Log(Poco::Message::Priority priority, const std::string& text);
+
+private:
+    struct LogMessage
+    {
+        Poco::Timestamp time;
+        Poco::Message::Priority priority = Poco::Message::PRIO_INFORMATION;
+        std::string text;
+    };
+
+    /** The messages waiting to be written */
+    novac::RingBuffer<LogMessage> m_buffer;
+
+    std::atomic<bool> m_running{ false };
+    std::atomic<bool> m_stopRequested{ false };
+    bool m_dropMessagesWhenFull = false;
+
+    /** The number of messages dropped since this was last logged */
+    std::atomic<size_t> m_droppedMessages{ 0 };
+
+    /** Used to wake up the background thread when there are new messages */
+    std::atomic<bool> m_writerSleeping{ false };
+    std::mutex m_wakeUpGuard;
+    std::condition_variable m_wakeUp;
+
+    std::thread m_writerThread;
+
+    /** The background thread */
+    void WriteMessages();
+
+    void WakeUpWriter();
+
+    /** Writes the messages left in the buffer, from the calling thread */
+    void WriteRemainingMessages();
+
+    static void Write(const LogMessage& message);
+};
@@ -0,0 +1,468 @@
+#include "BinaryEvaluationLog.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace FileHandler;
+
+namespace
+{
+    const char binaryLogMagic[8] = { 'N', 'O', 'V', 'A', 'C', 'E', 'V', 'B' };
+    const uint32_t binaryLogVersion = 1;
+    const uint32_t binaryLogByteOrder = 0x01020304; // used to detect files written on a machine with another byte order
+
+    bool WriteUInt32(FILE* f, uint32_t value)
+    {
+        return 1 == fwrite(&value, sizeof(uint32_t), 1, f);
+    }
+
+    bool WriteString(FILE* f, const std::string& str)
+    {
+        if (!WriteUInt32(f, (uint32_t)str.size()))
+            return false;
+        return str.size() == fwrite(str.data(), sizeof(char), str.size(), f);
+    }
+
+    /** Reads the values from a binary log which has been read into memory */
+    class CBinaryLogReader
+    {
+    public:
+        CBinaryLogReader(const std::vector<char>& data)
+            : m_data(data) { }
+
+        bool Read(void* dst, size_t length)
+        {
+            if (length > m_data.size() - m_position)
+                return false;
+            memcpy(dst, m_data.data() + m_position, length);
+            m_position += length;
+            return true;
+        }
+
+        bool ReadUInt32(uint32_t& value)
+        {
+            return Read(&value, sizeof(uint32_t));
+        }
+
+        bool ReadString(std::string& str)
+        {
+            uint32_t length = 0;
+            if (!ReadUInt32(length) || length > m_data.size() - m_position)
+                return false;
+            str.assign(m_data.data() + m_position, length);
+            m_position += length;
+            return true;
+        }
+
+    private:
+        const std::vector<char>& m_data;
+        size_t m_position = 0;
+    };
+
+    /** Splits a spectrum line into its tab-separated tokens.
+        @return false if the line cannot be stored in columns, i.e. if it contains empty
+            tokens, whitespace or anything which has a special meaning in the evaluation log. */
+    bool SplitSpectrumLine(const std::string& line, std::vector<std::string>& tokens)
+    {
+        tokens.clear();
+        if (line.empty() || line[0] == '#' || line.find_first_of(" \r\n<") != std::string::npos)
+            return false;
+
+        std::string lowerCaseLine = line;
+        std::transform(begin(lowerCaseLine), end(lowerCaseLine), begin(lowerCaseLine), [](char c) { return (char)tolower(c); });
+        if (lowerCaseLine.find("exposuretime") != std::string::npos)
+            return false;
+
+        size_t start = 0;
+        while (true)
+        {
+            const size_t end = line.find('\t', start);
+            const size_t length = (end == std::string::npos) ? line.size() - start : end - start;
+            if (length == 0)
+                return false;
+            tokens.push_back(line.substr(start, length));
+            if (end == std::string::npos)
+                return true;
+            start = end + 1;
+        }
+    }
+}
+
+void CBinaryEvaluationLog::AppendText(const char* text)
+{
+    if (m_lines.size() == 0)
+        m_header.append(text);
+    else
+        m_footer.append(text);
+}
+
+void CBinaryEvaluationLog::AppendSpectrumLine(const char* line)
+{
+    m_textLines.push_back(std::string(line));
+    m_lines.push_back(-(int)m_textLines.size());
+}
+
+novac::CString CBinaryEvaluationLog::GetFileName(const novac::CString& evaluationLog)
+{
+    // compressed and uncompressed evaluation logs share the same binary log
+    novac::CString fileName(evaluationLog);
+    if (novac::Equals(fileName.Right(3), ".gz"))
+    {
+        fileName = fileName.Left(fileName.GetLength() - 3);
+    }
+    fileName.Append(".bin");
+    return fileName;
+}
+
+void CBinaryEvaluationLog::GetTime(size_t column, size_t line, int& hour, int& minute, int& second) const
+{
+    const int time = (int)GetValue(column, line);
+    hour = time / 10000;
+    minute = (time / 100) % 100;
+    second = time % 100;
+}
+
+void CBinaryEvaluationLog::FormatValue(size_t column, size_t line, std::string& token) const
+{
+    if (m_columns[column].type == ColumnType::Text)
+        token = GetText(column, line);
+    else
+        FormatValue(m_columns[column].type, GetValue(column, line), token);
+}
+
+void CBinaryEvaluationLog::FormatValue(ColumnType type, double value, std::string& token)
+{
+    char buffer[512];
+    switch (type)
+    {
+    case ColumnType::Time:
+    {
+        const int time = (int)value;
+        snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", time / 10000, (time / 100) % 100, time % 100);
+        break;
+    }
+    case ColumnType::Exponent2:
+        snprintf(buffer, sizeof(buffer), "%.2e", value);
+        break;
+    case ColumnType::Decimal2:
+        snprintf(buffer, sizeof(buffer), "%.2lf", value);
+        break;
+    case ColumnType::Decimal0:
+        snprintf(buffer, sizeof(buffer), "%.0lf", value);
+        break;
+    default:
+        buffer[0] = '\0';
+        break;
+    }
+    token.assign(buffer);
+}
+
+bool CBinaryEvaluationLog::ConvertToken(const std::string& token, ColumnType type, double& value)
+{
+    value = 0.0;
+    if (type == ColumnType::Text)
+    {
+        return true;
+    }
+    else if (type == ColumnType::Time)
+    {
+        int hour, minute, second;
+        if (3 != sscanf(token.c_str(), "%d:%d:%d", &hour, &minute, &second))
+            return false;
+        if (hour < 0 || hour > 99999 || minute < 0 || minute > 99 || second < 0 || second > 99)
+            return false;
+        value = hour * 10000.0 + minute * 100.0 + second;
+    }
+    else
+    {
+        char* end = nullptr;
+        value = strtod(token.c_str(), &end);
+        if (end == token.c_str() || *end != '\0')
+            return false;
+    }
+
+    // only accept the value if it is formatted back into exactly the same token
+    std::string formattedValue;
+    FormatValue(type, value, formattedValue);
+    return formattedValue == token;
+}
+
+void CBinaryEvaluationLog::BuildColumns()
+{
+    if (m_columns.size() > 0)
+        return;
+
+    // 1. Split the lines into tokens. All the lines which can be stored in the columns
+    //  have the same number of tokens as the last spectrum line.
+    std::vector<std::vector<std::string>> tokens(m_lines.size());
+    std::vector<bool> isSplit(m_lines.size(), false);
+    size_t nColumns = 0;
+    for (size_t line = 0; line < m_lines.size(); ++line)
+    {
+        isSplit[line] = IsTextLine(line) && SplitSpectrumLine(GetTextLine(line), tokens[line]);
+        if (isSplit[line])
+            nColumns = tokens[line].size();
+    }
+    if (nColumns == 0)
+        return;
+    for (size_t line = 0; line < m_lines.size(); ++line)
+    {
+        isSplit[line] = isSplit[line] && tokens[line].size() == nColumns;
+    }
+
+    // 2. Select the type of each column, this is the type which can represent the most of the lines
+    const ColumnType valueTypes[] = { ColumnType::Time, ColumnType::Exponent2, ColumnType::Decimal2, ColumnType::Decimal0 };
+    std::vector<Column> columns(nColumns);
+    for (size_t column = 0; column < nColumns; ++column)
+    {
+        size_t bestCount = 0;
+        for (ColumnType type : valueTypes)
+        {
+            size_t count = 0;
+            double value;
+            for (size_t line = 0; line < m_lines.size(); ++line)
+            {
+                if (isSplit[line] && ConvertToken(tokens[line][column], type, value))
+                    ++count;
+            }
+            if (count > bestCount)
+            {
+                bestCount = count;
+                columns[column].type = type;
+            }
+        }
+    }
+
+    // 3. Move all lines which can be represented exactly into the columns
+    std::vector<int> lines(m_lines.size());
+    std::vector<std::string> textLines;
+    int nRows = 0;
+    for (size_t line = 0; line < m_lines.size(); ++line)
+    {
+        bool fitsInColumns = isSplit[line];
+        std::vector<double> values(nColumns);
+        for (size_t column = 0; column < nColumns && fitsInColumns; ++column)
+        {
+            fitsInColumns = ConvertToken(tokens[line][column], columns[column].type, values[column]);
+        }
+
+        if (fitsInColumns)
+        {
+            for (size_t column = 0; column < nColumns; ++column)
+            {
+                if (columns[column].type == ColumnType::Text)
+                    columns[column].text.push_back(tokens[line][column]);
+                else
+                    columns[column].values.push_back(values[column]);
+            }
+            lines[line] = nRows++;
+        }
+        else
+        {
+            textLines.push_back(GetTextLine(line));
+            lines[line] = -(int)textLines.size();
+        }
+    }
+
+    if (nRows == 0)
+        return;
+
+    m_lines = std::move(lines);
+    m_textLines = std::move(textLines);
+    m_columns = std::move(columns);
+}
+
+RETURN_CODE CBinaryEvaluationLog::WriteToFile(const novac::CString& fileName)
+{
+    BuildColumns();
+
+    FILE* f = fopen(fileName, "wb");
+    if (f == nullptr)
+        return FAIL;
+
+    const uint32_t nRows = (m_columns.size() > 0) ? (uint32_t)(m_columns.front().values.size() + m_columns.front().text.size()) : 0;
+
+    bool ok = (1 == fwrite(binaryLogMagic, sizeof(binaryLogMagic), 1, f));
+    ok = ok && WriteUInt32(f, binaryLogVersion);
+    ok = ok && WriteUInt32(f, binaryLogByteOrder);
+    ok = ok && WriteString(f, m_header);
+    ok = ok && WriteString(f, m_footer);
+
+    ok = ok && WriteUInt32(f, (uint32_t)m_lines.size());
+    ok = ok && (m_lines.size() == fwrite(m_lines.data(), sizeof(int), m_lines.size(), f));
+
+    ok = ok && WriteUInt32(f, (uint32_t)m_textLines.size());
+    for (size_t k = 0; ok && k < m_textLines.size(); ++k)
+    {
+        ok = WriteString(f, m_textLines[k]);
+    }
+
+    ok = ok && WriteUInt32(f, (uint32_t)m_columns.size());
+    ok = ok && WriteUInt32(f, nRows);
+    for (size_t k = 0; ok && k < m_columns.size(); ++k)
+    {
+        const Column& column = m_columns[k];
+        const unsigned char type = (unsigned char)column.type;
+        ok = (1 == fwrite(&type, sizeof(unsigned char), 1, f));
+        if (column.type == ColumnType::Text)
+        {
+            for (size_t row = 0; ok && row < column.text.size(); ++row)
+            {
+                ok = WriteString(f, column.text[row]);
+            }
+        }
+        else
+        {
+            ok = ok && (column.values.size() == fwrite(column.values.data(), sizeof(double), column.values.size(), f));
+        }
+    }
+
+    fclose(f);
+
+    if (!ok)
+    {
+        remove(fileName);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+RETURN_CODE CBinaryEvaluationLog::ReadFromFile(const novac::CString& fileName)
+{
+    m_header.clear();
+    m_footer.clear();
+    m_lines.clear();
+    m_textLines.clear();
+    m_columns.clear();
+
+    // Read in the whole file at once
+    FILE* f = fopen(fileName, "rb");
+    if (f == nullptr)
+        return FAIL;
+    std::vector<char> data;
+    const size_t blockSize = 65536;
+    size_t length = 0;
+    while (true)
+    {
+        data.resize(length + blockSize);
+        const size_t read = fread(data.data() + length, sizeof(char), blockSize, f);
+        length += read;
+        if (read < blockSize)
+            break;
+    }
+    data.resize(length);
+    fclose(f);
+
+    CBinaryLogReader reader(data);
+
+    char magic[sizeof(binaryLogMagic)];
+    uint32_t version = 0, byteOrder = 0;
+    if (!reader.Read(magic, sizeof(magic)) || 0 != memcmp(magic, binaryLogMagic, sizeof(magic)))
+        return FAIL;
+    if (!reader.ReadUInt32(version) || version != binaryLogVersion)
+        return FAIL;
+    if (!reader.ReadUInt32(byteOrder) || byteOrder != binaryLogByteOrder)
+        return FAIL;
+    if (!reader.ReadString(m_header) || !reader.ReadString(m_footer))
+        return FAIL;
+
+    uint32_t nLines = 0;
+    if (!reader.ReadUInt32(nLines) || nLines > data.size())
+        return FAIL;
+    m_lines.resize(nLines);
+    if (!reader.Read(m_lines.data(), nLines * sizeof(int)))
+        return FAIL;
+
+    uint32_t nTextLines = 0;
+    if (!reader.ReadUInt32(nTextLines) || nTextLines > data.size())
+        return FAIL;
+    m_textLines.resize(nTextLines);
+    for (uint32_t k = 0; k < nTextLines; ++k)
+    {
+        if (!reader.ReadString(m_textLines[k]))
+            return FAIL;
+    }
+
+    uint32_t nColumns = 0, nRows = 0;
+    if (!reader.ReadUInt32(nColumns) || !reader.ReadUInt32(nRows) || nColumns > data.size() || nRows > data.size())
+        return FAIL;
+    m_columns.resize(nColumns);
+    for (uint32_t k = 0; k < nColumns; ++k)
+    {
+        Column& column = m_columns[k];
+        unsigned char type = 0;
+        if (!reader.Read(&type, sizeof(unsigned char)) || type > (unsigned char)ColumnType::Text)
+            return FAIL;
+        column.type = (ColumnType)type;
+        if (column.type == ColumnType::Text)
+        {
+            column.text.resize(nRows);
+            for (uint32_t row = 0; row < nRows; ++row)
+            {
+                if (!reader.ReadString(column.text[row]))
+                    return FAIL;
+            }
+        }
+        else
+        {
+            column.values.resize(nRows);
+            if (!reader.Read(column.values.data(), nRows * sizeof(double)))
+                return FAIL;
+        }
+    }
+
+    // check that all the lines refer to existing data
+    for (int line : m_lines)
+    {
+        if ((line >= 0 && (nColumns == 0 || (uint32_t)line >= nRows)) || (line < 0 && (uint32_t)(-(long long)line - 1) >= nTextLines))
+        {
+            m_lines.clear();
+            return FAIL;
+        }
+    }
+
+    return SUCCESS;
+}
+
+RETURN_CODE CBinaryEvaluationLog::WriteTextLog(const novac::CString& fileName)
+{
+    BuildColumns();
+
+    FILE* f = fopen(fileName, "w");
+    if (f == nullptr)
+        return FAIL;
+
+    std::string line, token;
+    bool ok = (EOF != fputs(m_header.c_str(), f));
+    for (size_t k = 0; ok && k < m_lines.size(); ++k)
+    {
+        if (IsTextLine(k))
+        {
+            line = GetTextLine(k);
+        }
+        else
+        {
+            line.clear();
+            for (size_t column = 0; column < m_columns.size(); ++column)
+            {
+                FormatValue(column, k, token);
+                if (column > 0)
+                    line.push_back('\t');
+                line.append(token);
+            }
+        }
+        line.push_back('\n');
+        ok = (EOF != fputs(line.c_str(), f));
+    }
+    ok = ok && (EOF != fputs(m_footer.c_str(), f));
+    ok = (0 == fclose(f)) && ok;
+
+    if (!ok)
+    {
+        remove(fileName);
+        return FAIL;
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Common.h"
+#include <PPPLib/CString.h>
+#include <string>
+#include <vector>
+
+namespace FileHandler
+{
+    /** <b>CBinaryEvaluationLog</b> is a binary copy of an evaluation log, which is
+        written next to the text evaluation log and which can be read in by
+        CEvaluationLogFileHandler without having to parse the text.
+
+        The text outside of the spectrum lines (the scan- and flux-information and
+        the header line) is stored as it is. The spectrum lines are stored column by
+        column, with the values of each column in one contiguous array. Every value is
+        stored such that it is formatted back to exactly the same text as in the
+        evaluation log, which makes it possible to regenerate the text evaluation log
+        from the binary log. Spectrum lines which cannot be stored in the columns
+        in this way (e.g. the sky and dark spectra, which have no fit-result) are stored as text.
+    */
+    class CBinaryEvaluationLog
+    {
+    public:
+        /** The types of the columns, i.e. how the values in the column are formatted */
+        enum class ColumnType : unsigned char
+        {
+            Time = 0,       // hh:mm:ss
+            Exponent2 = 1,  // "%.2e"
+            Decimal2 = 2,   // "%.2lf"
+            Decimal0 = 3,   // "%.0lf"
+            Text = 4        // any text not containing whitespace
+        };
+
+        // ------------------- Writing the log -------------------------
+
+        /** Appends text, which is not a spectrum line, to the log. */
+        void AppendText(const char* text);
+
+        /** Appends one line with the evaluation result of one spectrum to the log.
+            @param line the line as written to the text log, without the newline character. */
+        void AppendSpectrumLine(const char* line);
+
+        /** Writes the binary log to the given file.
+            @return SUCCESS if the file could be written. */
+        RETURN_CODE WriteToFile(const novac::CString& fileName);
+
+        // ------------------- Reading the log -------------------------
+
+        /** Reads in the binary log from the given file.
+            @return SUCCESS if the file could be read and is a valid binary evaluation log. */
+        RETURN_CODE ReadFromFile(const novac::CString& fileName);
+
+        /** Regenerates the text evaluation log from the contents of this binary log,
+            the generated file is identical to the (uncompressed) evaluation log the binary log was created from.
+            This is used to restore evaluation logs which have been lost, see CPostProcessing::RestoreEvaluationLogs.
+            @return SUCCESS if the file could be written, if not then no file is left behind. */
+        RETURN_CODE WriteTextLog(const novac::CString& fileName);
+
+        /** @return the name of the binary log belonging to the given, possibly compressed, evaluation log. */
+        static novac::CString GetFileName(const novac::CString& evaluationLog);
+
+        /** The text before the first spectrum line */
+        const std::string& Header() const { return m_header; }
+
+        /** The text after the last spectrum line */
+        const std::string& Footer() const { return m_footer; }
+
+        /** @return the number of spectrum lines */
+        size_t LineNum() const { return m_lines.size(); }
+
+        /** @return true if the given spectrum line is stored as text and not in the columns */
+        bool IsTextLine(size_t line) const { return m_lines[line] < 0; }
+
+        /** @return the given spectrum line, which must be stored as text */
+        const std::string& GetTextLine(size_t line) const { return m_textLines[-m_lines[line] - 1]; }
+
+        /** @return the number of columns */
+        size_t ColumnNum() const { return m_columns.size(); }
+
+        /** @return the type of the given column */
+        ColumnType GetColumnType(size_t column) const { return m_columns[column].type; }
+
+        /** @return the value in the given column of the given spectrum line.
+            The line must be stored in the columns and the column must not be of type 'Text'. */
+        double GetValue(size_t column, size_t line) const { return m_columns[column].values[m_lines[line]]; }
+
+        /** @return the time in the given column of the given spectrum line, as hour, minute and second.
+            The line must be stored in the columns and the column must be of type 'Time'. */
+        void GetTime(size_t column, size_t line, int& hour, int& minute, int& second) const;
+
+        /** @return the text in the given column of the given spectrum line.
+            The line must be stored in the columns and the column must be of type 'Text'. */
+        const std::string& GetText(size_t column, size_t line) const { return m_columns[column].text[m_lines[line]]; }
+
+        /** Formats the given column of the given spectrum line in the same way as in the text log.
+            The line must be stored in the columns. */
+        void FormatValue(size_t column, size_t line, std::string& token) const;
+
+    private:
+        struct Column
+        {
+            ColumnType type = ColumnType::Text;
+            std::vector<double> values;     // all but text columns
+            std::vector<std::string> text;  // text columns
+        };
+
+        /** The text before the first and after the last spectrum line */
+        std::string m_header;
+        std::string m_footer;
+
+        /** For each spectrum line: the index of the line in the columns if zero or positive,
+            otherwise the index of the line in m_textLines is (-m_lines[i] - 1) */
+        std::vector<int> m_lines;
+
+        /** The spectrum lines which are stored as text */
+        std::vector<std::string> m_textLines;
+
+        /** The columns of the spectrum lines */
+        std::vector<Column> m_columns;
+
+        /** Moves the spectrum lines which were appended as text into the columns,
+            this is done once all the lines have been appended. */
+        void BuildColumns();
+
+        /** Converts one token to a value in a column of the given type.
+            @return true if the value is formatted back into exactly the same token. */
+        static bool ConvertToken(const std::string& token, ColumnType type, double& value);
+
+        /** Formats a value in a column of the given type */
+        static void FormatValue(ColumnType type, double value, std::string& token);
+    };
+}
@@ -8,7 +8,8 @@
 #include <Poco/DirectoryIterator.h>
 #include <Poco/DateTime.h>
 #include <Poco/Message.h>
-#include <Poco/Logger.h>
+
+#include "AsynchronousLogger.h"
 
 // include the global settings
 #include <PPPLib/VolcanoInfo.h>
@@ -20,6 +21,7 @@
 #include "../Meteorology/WindField.h"
 
 extern novac::CVolcanoInfo g_volcanoes; // <-- the list of volcanoes
+extern CAsynchronousLogger g_logger; // <-- writes the messages to the log in the background
 
 extern std::string s_exePath;
 extern std::string s_exeFileName;
@@ -73,44 +75,35 @@ int CreateDirectoryStructure(const novac::CString &path)
 
 
 void UpdateMessage(const novac::CString &message) {
-    Poco::Logger& log = Poco::Logger::get("NovacPPP");
-    log.information(message.std_str());
+    g_logger.Log(Poco::Message::PRIO_INFORMATION, message.std_str());
 }
 
 void ShowMessage(const novac::CString &message) {
-    Poco::Logger& log = Poco::Logger::get("NovacPPP");
-    log.information(message.std_str());
+    g_logger.Log(Poco::Message::PRIO_INFORMATION, message.std_str());
 }
 void ShowMessage(const std::string& message)
 {
-    Poco::Logger& log = Poco::Logger::get("NovacPPP");
-    log.information(message);
+    g_logger.Log(Poco::Message::PRIO_INFORMATION, message);
 }
 void ShowMessage(const novac::CString &message, novac::CString connectionID) {
     novac::CString msg;
 
     msg.Format("<%s> : %s", (const char*)connectionID, (const char*)message);
 
-    Poco::Logger& log = Poco::Logger::get("NovacPPP");
-    log.information(msg.std_str());
+    g_logger.Log(Poco::Message::PRIO_INFORMATION, msg.std_str());
 }
 
 void ShowMessage(const char message[]) {
-    novac::CString msg;
-    msg.Format("%s", message);
-    ShowMessage(msg);
+    g_logger.Log(Poco::Message::PRIO_INFORMATION, std::string(message));
 }
 
 void ShowError(const novac::CString &message)
 {
-    Poco::Logger& log = Poco::Logger::get("NovacPPP");
-    log.fatal(message.std_str());
+    g_logger.Log(Poco::Message::PRIO_FATAL, message.std_str());
 }
 void ShowError(const char message[])
 {
-    novac::CString msg;
-    msg.Format("%s", message);
-    ShowError(msg);
+    g_logger.Log(Poco::Message::PRIO_FATAL, std::string(message));
 }
 
 Common::Common()
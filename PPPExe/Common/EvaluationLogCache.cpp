@@ -0,0 +1,97 @@
+#include "EvaluationLogCache.h"
+
+#include <algorithm>
+
+// Global variables;
+FileHandler::CEvaluationLogCache g_evaluationLogCache; // <-- The most recently read evaluation logs
+
+using namespace FileHandler;
+
+std::shared_ptr<const CParsedEvaluationLog> CEvaluationLogCache::Find(const std::string& fileName, const Filesystem::FileVersion& version)
+{
+    std::lock_guard<std::mutex> lock(m_guard);
+
+    auto entry = m_entries.find(fileName);
+    if (entry == m_entries.end())
+    {
+        return nullptr;
+    }
+    if (!(entry->second.version == version))
+    {
+        // the log has been changed since it was read
+        Remove(entry);
+        return nullptr;
+    }
+
+    // this is now the most recently used log
+    m_recentlyUsed.splice(m_recentlyUsed.begin(), m_recentlyUsed, entry->second.positionInUse);
+
+    return entry->second.log;
+}
+
+void CEvaluationLogCache::Insert(const std::string& fileName, const Filesystem::FileVersion& version, std::shared_ptr<const CParsedEvaluationLog> log, size_t maximumSize)
+{
+    const size_t size = EstimateSize(*log);
+    if (size > maximumSize)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_guard);
+
+    auto oldEntry = m_entries.find(fileName);
+    if (oldEntry != m_entries.end())
+    {
+        Remove(oldEntry);
+    }
+
+    // remove the least recently used logs until the new log fits
+    while (m_recentlyUsed.size() > 0 && m_totalSize + size > maximumSize)
+    {
+        Remove(m_entries.find(m_recentlyUsed.back()));
+    }
+
+    m_recentlyUsed.push_front(fileName);
+
+    Entry& entry = m_entries[fileName];
+    entry.log = log;
+    entry.version = version;
+    entry.size = size;
+    entry.positionInUse = m_recentlyUsed.begin();
+    m_totalSize += size;
+}
+
+void CEvaluationLogCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_guard);
+    m_entries.clear();
+    m_recentlyUsed.clear();
+    m_totalSize = 0;
+}
+
+size_t CEvaluationLogCache::Size()
+{
+    std::lock_guard<std::mutex> lock(m_guard);
+    return m_totalSize;
+}
+
+void CEvaluationLogCache::Remove(std::unordered_map<std::string, Entry>::iterator entry)
+{
+    m_totalSize -= entry->second.size;
+    m_recentlyUsed.erase(entry->second.positionInUse);
+    m_entries.erase(entry);
+}
+
+size_t CEvaluationLogCache::EstimateSize(const CParsedEvaluationLog& log)
+{
+    typedef decltype(Evaluation::CEvaluationResult::m_referenceResult)::value_type ReferenceResult;
+
+    size_t size = sizeof(CParsedEvaluationLog) + log.m_windField.size() * sizeof(Meteorology::CWindField);
+    for (const Evaluation::CScanResult& scan : log.m_scan)
+    {
+        const size_t nSpectra = (size_t)std::max(scan.GetEvaluatedNum(), 0L);
+        const size_t nSpecies = (nSpectra > 0) ? (size_t)scan.GetSpecieNum(0) : 0;
+        size += sizeof(Evaluation::CScanResult) + nSpectra * (sizeof(CSpectrumInfo) + sizeof(Evaluation::CEvaluationResult) + nSpecies * sizeof(ReferenceResult));
+    }
+    return size;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Common.h"
+#include "../Evaluation/ScanResult.h"
+#include "../Filesystem/Filesystem.h"
+#include "../Meteorology/WindField.h"
+#include <PPPLib/CString.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FileHandler
+{
+    /** The contents of one evaluation log, as read in by CEvaluationLogFileHandler */
+    struct CParsedEvaluationLog
+    {
+        /** The scans read from the evaluation log */
+        std::vector<Evaluation::CScanResult> m_scan;
+
+        /** The wind fields read from the evaluation log */
+        std::vector<Meteorology::CWindField> m_windField;
+
+        /** The species that were found in this evaluation log */
+        novac::CString m_specie[20];
+
+        /** The number of species found in the evaluation log */
+        long m_specieNum = 0;
+
+        /** The instrument-type for the instrument that generated the results */
+        INSTRUMENT_TYPE m_instrumentType = INSTR_GOTHENBURG;
+
+        /** The spectrum information of the last spectrum in the log */
+        CSpectrumInfo m_specInfo;
+    };
+
+    /** <b>CEvaluationLogCache</b> keeps the contents of the most recently read
+        evaluation logs in memory, such that the same evaluation log doesn't need
+        to be parsed again each time it is needed in the processing.
+
+        The logs are identified by their file name together with the time they were
+        last modified and their size, such that a log which has been changed since
+        it was read is read in again. The total (estimated) size of the logs kept
+        in memory is limited, the least recently used log is removed first.
+        All the methods can be called from several threads at the same time. */
+    class CEvaluationLogCache
+    {
+    public:
+        /** Finds the given version of the given evaluation log.
+            @return the contents of the log or nullptr if the log is not in the cache */
+        std::shared_ptr<const CParsedEvaluationLog> Find(const std::string& fileName, const Filesystem::FileVersion& version);
+
+        /** Inserts the contents of the given version of the given evaluation log into the cache,
+            and then removes the least recently used logs until the estimated total size
+            of the logs in the cache is no more than 'maximumSize' bytes. */
+        void Insert(const std::string& fileName, const Filesystem::FileVersion& version, std::shared_ptr<const CParsedEvaluationLog> log, size_t maximumSize);
+
+        /** Removes all the logs from the cache */
+        void Clear();
+
+        /** @return the estimated number of bytes used by the logs in the cache */
+        size_t Size();
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<const CParsedEvaluationLog> log;
+            Filesystem::FileVersion version;
+            size_t size = 0;
+            std::list<std::string>::iterator positionInUse;
+        };
+
+        /** The logs in the cache, by file name */
+        std::unordered_map<std::string, Entry> m_entries;
+
+        /** The file names of the logs in the cache, the most recently used first */
+        std::list<std::string> m_recentlyUsed;
+
+        /** The estimated total size of the logs in the cache, in bytes */
+        size_t m_totalSize = 0;
+
+        std::mutex m_guard;
+
+        /** @return the estimated number of bytes of memory used by the given log */
+        static size_t EstimateSize(const CParsedEvaluationLog& log);
+
+        /** Removes the given entry from the cache. m_guard must be locked. */
+        void Remove(std::unordered_map<std::string, Entry>::iterator entry);
+    };
+}
@@ -1,23 +1,94 @@
 #include "EvaluationLogFileHandler.h"
+#include "BinaryEvaluationLog.h"
+#include "EvaluationLogCache.h"
+#include "TextFileWriter.h"
+#include "EvaluationLogWriter.h"
 #include <SpectralEvaluation/Spectra/SpectrometerModel.h>
 #include <SpectralEvaluation/StringUtils.h>
 #include "../Common/Version.h"
 #include <cstring>
+#include <cstdlib>
 #include <algorithm>
 
-#include <PPPLib/CSingleLock.h>
+#include <Poco/File.h>
+#include <Poco/Exception.h>
 
 // This is the settings for how to do the procesing
 #include "../Configuration/UserConfiguration.h"
 
 // Global variables;
-novac::CCriticalSection									g_evalLogCritSect; // synchronization access to evaluation-log files
 extern Configuration::CUserConfiguration			g_userSettings;// <-- The settings of the user
+extern FileHandler::CEvaluationLogCache         g_evaluationLogCache; // <-- The most recently read evaluation logs
 
 
 using namespace FileHandler;
 using namespace novac;
 
+/** Splits the given string into tokens in the same way as strtok, but keeps the
+    position in the string in 'context' instead of in a static variable, such that
+    several evaluation logs can be parsed at the same time in different threads.
+    @param str the string to split on the first call, NULL to continue with the same string.
+    @return the next token or NULL if there are no more tokens. */
+static char* NextToken(char* str, const char* separators, char*& context)
+{
+    char* pt = (str != nullptr) ? str : context;
+    if (pt == nullptr)
+    {
+        return nullptr;
+    }
+
+    pt += strspn(pt, separators);
+    if (*pt == '\0')
+    {
+        context = nullptr;
+        return nullptr;
+    }
+
+    char* tokenEnd = pt + strcspn(pt, separators);
+    if (*tokenEnd == '\0')
+    {
+        context = nullptr;
+    }
+    else
+    {
+        *tokenEnd = '\0';
+        context = tokenEnd + 1;
+    }
+    return pt;
+}
+
+void CEvaluationLogContents::SetContents(const std::string& contents)
+{
+    m_data.assign(contents.begin(), contents.end());
+    m_position = 0;
+}
+
+bool CEvaluationLogContents::ReadFile(const char* fileName)
+{
+    m_position = 0;
+
+    // the log may have been written compressed, this is handled by the reader
+    return CTextFileWriter::ReadTextFile(fileName, m_data);
+}
+
+size_t CEvaluationLogContents::ReadLine(char* line, size_t maxLength)
+{
+    if (maxLength < 2 || m_position >= m_data.size()) {
+        return 0;
+    }
+
+    // copy up to, and including, the next newline character
+    const char* start = m_data.data() + m_position;
+    const size_t available = std::min(m_data.size() - m_position, maxLength - 1);
+    const char* newline = (const char*)memchr(start, '\n', available);
+    const size_t length = (newline != nullptr) ? (size_t)(newline - start) + 1 : available;
+
+    memcpy(line, start, length);
+    line[length] = '\0';
+    m_position += length;
+    return length;
+}
+
 CEvaluationLogFileHandler::CEvaluationLogFileHandler(void)
 {
     // Defining which column contains which information
@@ -59,6 +130,7 @@ void CEvaluationLogFileHandler::ParseScanHeader(const char szLine[8192]) {
         strncpy(str, szLine, 8192 * sizeof(char));
 
     char* szToken = str;
+    char* tokenContext = nullptr;
     int curCol = -1;
     char elevation[] = "elevation";
     char scanAngle[] = "scanangle";
@@ -84,7 +156,7 @@ void CEvaluationLogFileHandler::ParseScanHeader(const char szLine[8192]) {
     char stoptime[] = "stoptime";
     char nameStr[] = "name";
 
-    while (nullptr != (szToken = strtok(szToken, "\t"))) {
+    while (nullptr != (szToken = NextToken(szToken, "\t", tokenContext))) {
         ++curCol;
 
         // The scan-angle (previously known as elevation)
@@ -259,384 +331,476 @@ void CEvaluationLogFileHandler::ParseScanHeader(const char szLine[8192]) {
 }
 
 RETURN_CODE CEvaluationLogFileHandler::ReadEvaluationLog() {
+    // If no evaluation log selected, quit
+    if (strlen(m_evaluationLog) <= 1)
+        return FAIL;
+
+    // If this version of the log has been read before, then use the contents
+    //  of the log kept in memory instead of reading the file again
+    const std::string fileName = m_evaluationLog.std_str();
+    Filesystem::FileVersion version;
+    const bool useCache = g_userSettings.m_evaluationLogCacheSize > 0 && Filesystem::GetFileVersion(fileName, version);
+    if (useCache) {
+        std::shared_ptr<const CParsedEvaluationLog> cachedLog = g_evaluationLogCache.Find(fileName, version);
+        if (cachedLog != nullptr) {
+            m_scan.insert(m_scan.end(), cachedLog->m_scan.begin(), cachedLog->m_scan.end());
+            m_windField.insert(m_windField.end(), cachedLog->m_windField.begin(), cachedLog->m_windField.end());
+            for (int k = 0; k < 20; ++k) {
+                m_specie[k] = cachedLog->m_specie[k];
+            }
+            m_specieNum = cachedLog->m_specieNum;
+            m_curSpecie = 0;
+            m_instrumentType = cachedLog->m_instrumentType;
+            m_specInfo = cachedLog->m_specInfo;
+
+            SortScans();
+            return SUCCESS;
+        }
+    }
+    const size_t firstNewScan = m_scan.size();
+    const size_t firstNewWindField = m_windField.size();
+
+    LogParseState state;
+
+    // Read in the evaluation log, use the binary copy of the log if there is one
+    //  which has been created from the current version of the log
+    CBinaryEvaluationLog binaryLog;
+    CEvaluationLogContents file;
+    const bool useBinaryLog = HasBinaryLog() && (SUCCESS == binaryLog.ReadFromFile(CBinaryEvaluationLog::GetFileName(m_evaluationLog)));
+    if (!useBinaryLog && !file.ReadFile(m_evaluationLog)) {
+        return FAIL;
+    }
+
+    // Reset the column- and spectrum info
+    ResetColumns();
+    ResetScanInformation();
+
+    if (useBinaryLog) {
+        ParseBinaryLog(binaryLog, state);
+    }
+    else {
+        ParseLines(file, state);
+    }
+
+    AddParsedScan(state);
+
+    // Keep the contents of the log in memory, for the next time it is read
+    if (useCache) {
+        std::shared_ptr<CParsedEvaluationLog> parsedLog = std::make_shared<CParsedEvaluationLog>();
+        parsedLog->m_scan.assign(m_scan.begin() + firstNewScan, m_scan.end());
+        parsedLog->m_windField.assign(m_windField.begin() + firstNewWindField, m_windField.end());
+        for (int k = 0; k < 20; ++k) {
+            parsedLog->m_specie[k] = m_specie[k];
+        }
+        parsedLog->m_specieNum = m_specieNum;
+        parsedLog->m_instrumentType = m_instrumentType;
+        parsedLog->m_specInfo = m_specInfo;
+
+        g_evaluationLogCache.Insert(fileName, version, parsedLog, (size_t)g_userSettings.m_evaluationLogCacheSize * 1024 * 1024);
+    }
+
+    // Sort the scans in order of collection
+    SortScans();
+
+    return SUCCESS;
+}
+
+RETURN_CODE CEvaluationLogFileHandler::ParseEvaluationLog(const std::string& contents) {
+    LogParseState state;
+
+    CEvaluationLogContents file;
+    file.SetContents(contents);
+
+    // Reset the column- and spectrum info
+    ResetColumns();
+    ResetScanInformation();
+
+    ParseLines(file, state);
+
+    AddParsedScan(state);
+
+    // Sort the scans in order of collection
+    SortScans();
+
+    return SUCCESS;
+}
+
+void CEvaluationLogFileHandler::AddParsedScan(LogParseState &state) {
+    Evaluation::CScanResult& newResult = state.scan;
+
+    // If the sky and dark were specified, remove them from the measurement
+    if (fabs(newResult.GetScanAngle(1) - 180.0) < 1) {
+        newResult.RemoveResult(0); // remove sky
+        newResult.RemoveResult(0); // remove dark
+    }
+
+    // Calculate the offset
+    newResult.CalculateOffset(CMolecule(g_userSettings.m_molecule));
+
+    // Insert the new scan
+    m_scan.push_back(newResult);
+
+    newResult = Evaluation::CScanResult();
+}
+
+bool CEvaluationLogFileHandler::HasBinaryLog() const {
+    try
+    {
+        Poco::File binaryLog((const char*)CBinaryEvaluationLog::GetFileName(m_evaluationLog));
+        Poco::File textLog((const char*)m_evaluationLog);
+        return binaryLog.exists() && textLog.exists() && !(binaryLog.getLastModified() < textLog.getLastModified());
+    }
+    catch (Poco::Exception&)
+    {
+        return false;
+    }
+}
+
+void CEvaluationLogFileHandler::ParseLines(CEvaluationLogContents &file, LogParseState &state) {
+    char szLine[8192];
+
+    // Read the file, one line at a time
+    size_t lineLength = 0;
+    while (0 != (lineLength = file.ReadLine(szLine, sizeof(szLine)))) {
+        ParseLine(szLine, lineLength, file, state);
+    }
+}
+
+void CEvaluationLogFileHandler::ParseLine(char *szLine, size_t lineLength, CEvaluationLogContents &file, LogParseState &state) {
     char  expTimeStr[] = "exposuretime";         // this string only exists in the header line.
     char  scanInformation[] = "<scaninformation>";    // this string only exists in the scan-information section before the scan-data
     char  fluxInformation[] = "<fluxinfo>";           // this string only exists in the flux-information section before the scan-data
     char  spectralData[] = "<spectraldata>";
     char  endofSpectralData[] = "</spectraldata>";
-    novac::CString str;
-    char szLine[8192];
-    int measNr = 0;
-    double fValue;
-    bool fReadingScan = false;
-    double flux = 0.0;
 
-    // If no evaluation log selected, quit
-    if (strlen(m_evaluationLog) <= 1)
-        return FAIL;
+    // ignore empty lines
+    if (lineLength < 2) {
+        if (state.readingScan) {
+            state.readingScan = false;
+            // Reset the column- and spectrum-information
+            ResetColumns();
+            ResetScanInformation();
+        }
+        return;
+    }
 
-    // First count the number of scans in the file.
-    //	This to speed up the initialization of the arrays
-    const long nScans = CountScansInFile();
-    if (nScans > 0) {
-        m_scan.reserve(nScans);
-        m_windField.reserve(nScans + 1);
+    // convert the string to all lower-case letters
+    for (size_t it = 0; it < lineLength; ++it) {
+        szLine[it] = (char)tolower(szLine[it]);
     }
 
-    Evaluation::CScanResult newResult; // this is the scan we're reading in right now
+    // find the next scan-information section
+    if (NULL != strstr(szLine, scanInformation)) {
+        ResetScanInformation();
+        ParseScanInformation(m_specInfo, state.flux, file);
+        return;
+    }
 
-    // Open the evaluation log
-    novac::CSingleLock singleLock(&g_evalLogCritSect);
-    singleLock.Lock();
-    if (singleLock.IsLocked()) {
-        FILE *f = fopen(m_evaluationLog, "r");
-        if (NULL == f) {
-            singleLock.Unlock();
-            return FAIL;
-        }
+    // find the next flux-information section
+    if (NULL != strstr(szLine, fluxInformation))
+    {
+        Meteorology::CWindField windField;
+        ParseFluxInformation(windField, state.flux, file);
+        m_windField.push_back(windField);
+        return;
+    }
 
-        // Reset the column- and spectrum info
-        ResetColumns();
-        ResetScanInformation();
+    if (NULL != strstr(szLine, spectralData)) {
+        state.readingScan = true;
+        return;
+    }
+    else if (NULL != strstr(szLine, endofSpectralData)) {
+        state.readingScan = false;
+        return;
+    }
 
-        // Read the file, one line at a time
-        while (fgets(szLine, 8192, f)) {
-
-            // ignore empty lines
-            if (strlen(szLine) < 2) {
-                if (fReadingScan) {
-                    fReadingScan = false;
-                    // Reset the column- and spectrum-information
-                    ResetColumns();
-                    ResetScanInformation();
-                }
-                continue;
-            }
+    // find the next start of a scan 
+    if (NULL != strstr(szLine, expTimeStr)) {
 
-            // convert the string to all lower-case letters
-            for (unsigned int it = 0; it < strlen(szLine); ++it) {
-                szLine[it] = (char)tolower(szLine[it]);
-            }
+        // check so that there was some information in the last scan read
+        //	if not the re-use the memory space
+        if (state.measNr > 0)
+        {
+            // The current measurement position inside the scan
+            state.measNr = 0;
 
-            // find the next scan-information section
-            if (NULL != strstr(szLine, scanInformation)) {
-                ResetScanInformation();
-                ParseScanInformation(m_specInfo, flux, f);
-                continue;
-            }
+            // before we start the next scan, calculate some information about
+            // the old one
 
-            // find the next flux-information section
-            if (NULL != strstr(szLine, fluxInformation))
-            {
-                Meteorology::CWindField windField;
-                ParseFluxInformation(windField, flux, f);
-                m_windField.push_back(windField);
-                continue;
+            // 1. If the sky and dark were specified, remove them from the measurement
+            if (m_scan.size() >= 0 && fabs(m_scan.back().GetScanAngle(1) - 180.0) < 1) {
+                m_scan.back().RemoveResult(0); // remove sky
+                m_scan.back().RemoveResult(0); // remove dark
             }
 
-            if (NULL != strstr(szLine, spectralData)) {
-                fReadingScan = true;
-                continue;
-            }
-            else if (NULL != strstr(szLine, endofSpectralData)) {
-                fReadingScan = false;
-                continue;
+            // 2. Calculate the offset
+            if (m_scan.size() >= 0) {
+                m_scan.back().CalculateOffset(CMolecule(g_userSettings.m_molecule));
             }
 
-            // find the next start of a scan 
-            if (NULL != strstr(szLine, expTimeStr)) {
+            // start the next scan.
+        }
 
-                // check so that there was some information in the last scan read
-                //	if not the re-use the memory space
-                if (measNr > 0)
-                {
-                    // The current measurement position inside the scan
-                    measNr = 0;
+        // This line is the header line which says what each column represents.
+        //  Read it and parse it to find out how to interpret the rest of the 
+        //  file. 
+        ParseScanHeader(szLine);
 
-                    // before we start the next scan, calculate some information about
-                    // the old one
+        // start parsing the lines
+        state.readingScan = true;
 
-                    // 1. If the sky and dark were specified, remove them from the measurement
-                    if (m_scan.size() >= 0 && fabs(m_scan.back().GetScanAngle(1) - 180.0) < 1) {
-                        m_scan.back().RemoveResult(0); // remove sky
-                        m_scan.back().RemoveResult(0); // remove dark
-                    }
+        // read the next line, which is the first line in the scan
+        return;
+    }
 
-                    // 2. Calculate the offset
-                    if (m_scan.size() >= 0) {
-                        m_scan.back().CalculateOffset(CMolecule(g_userSettings.m_molecule));
-                    }
+    // ignore comment lines
+    if (szLine[0] == '#')
+        return;
 
-                    // start the next scan.
-                }
+    // if we're not reading a scan, let's read the next line
+    if (!state.readingScan)
+        return;
 
-                // This line is the header line which says what each column represents.
-                //  Read it and parse it to find out how to interpret the rest of the 
-                //  file. 
-                ParseScanHeader(szLine);
+    // Split the scan information up into tokens and parse them. 
+    char* szToken = (char*)szLine;
+    char* tokenContext = nullptr;
+    int curCol = -1;
+    while (nullptr != (szToken = NextToken(szToken, " \t", tokenContext))) {
+        ++curCol;
+        ParseSpectrumColumn(curCol, szToken);
+        szToken = NULL;
+    }
 
-                // start parsing the lines
-                fReadingScan = true;
+    // start reading the next line in the evaluation log (i.e. the next
+    //  spectrum in the scan). Insert the data from this spectrum into the 
+    //  CScanResult structure
+    InsertSpectrum(state);
+}
 
-                // read the next line, which is the first line in the scan
-                continue;
-            }
+void CEvaluationLogFileHandler::ParseSpectrumColumn(int curCol, const char* szToken) {
+    // First check the starttime
+    if (curCol == m_col.starttime) {
+        int fValue1, fValue2, fValue3;
+        if (strstr(szToken, ":")) {
+            sscanf(szToken, "%d:%d:%d", &fValue1, &fValue2, &fValue3);
+        }
+        else {
+            sscanf(szToken, "%d.%d.%d", &fValue1, &fValue2, &fValue3);
+        }
+        m_specInfo.m_startTime.hour = (unsigned char)fValue1;
+        m_specInfo.m_startTime.minute = (unsigned char)fValue2;
+        m_specInfo.m_startTime.second = (unsigned char)fValue3;
+        return;
+    }
 
-            // ignore comment lines
-            if (szLine[0] == '#')
-                continue;
+    // Then check the stoptime
+    if (curCol == m_col.stoptime) {
+        int fValue1, fValue2, fValue3;
+        if (strstr(szToken, ":")) {
+            sscanf(szToken, "%d:%d:%d", &fValue1, &fValue2, &fValue3);
+        }
+        else {
+            sscanf(szToken, "%d.%d.%d", &fValue1, &fValue2, &fValue3);
+        }
+        m_specInfo.m_stopTime.hour = (unsigned char)fValue1;
+        m_specInfo.m_stopTime.minute = (unsigned char)fValue2;
+        m_specInfo.m_stopTime.second = (unsigned char)fValue3;
+        return;
+    }
 
-            // if we're not reading a scan, let's read the next line
-            if (!fReadingScan)
-                continue;
+    // Also check the name...
+    if (curCol == m_col.name) {
+        m_specInfo.m_name = std::string(szToken);
+        return;
+    }
 
-            // Split the scan information up into tokens and parse them. 
-            char* szToken = (char*)szLine;
-            int curCol = -1;
-            while (nullptr != (szToken = strtok(szToken, " \t"))) {
-                ++curCol;
-
-                // First check the starttime
-                if (curCol == m_col.starttime) {
-                    int fValue1, fValue2, fValue3;
-                    if (strstr(szToken, ":")) {
-                        sscanf(szToken, "%d:%d:%d", &fValue1, &fValue2, &fValue3);
-                    }
-                    else {
-                        sscanf(szToken, "%d.%d.%d", &fValue1, &fValue2, &fValue3);
-                    }
-                    m_specInfo.m_startTime.hour = (unsigned char)fValue1;
-                    m_specInfo.m_startTime.minute = (unsigned char)fValue2;
-                    m_specInfo.m_startTime.second = (unsigned char)fValue3;
-                    szToken = NULL;
-                    continue;
-                }
-
-                // Then check the stoptime
-                if (curCol == m_col.stoptime) {
-                    int fValue1, fValue2, fValue3;
-                    if (strstr(szToken, ":")) {
-                        sscanf(szToken, "%d:%d:%d", &fValue1, &fValue2, &fValue3);
-                    }
-                    else {
-                        sscanf(szToken, "%d.%d.%d", &fValue1, &fValue2, &fValue3);
-                    }
-                    m_specInfo.m_stopTime.hour = (unsigned char)fValue1;
-                    m_specInfo.m_stopTime.minute = (unsigned char)fValue2;
-                    m_specInfo.m_stopTime.second = (unsigned char)fValue3;
-                    szToken = NULL;
-                    continue;
-                }
-
-                // Also check the name...
-                if (curCol == m_col.name) {
-                    m_specInfo.m_name = std::string(szToken);
-                    szToken = NULL;
-                    continue;
-                }
-
-                // ignore columns whose value cannot be parsed into a float
-                if (1 != sscanf(szToken, "%lf", &fValue)) {
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.position) {
-                    m_specInfo.m_scanAngle = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.position2) {
-                    m_specInfo.m_scanAngle2 = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.intensity) {
-                    m_specInfo.m_peakIntensity = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.fitIntensity) {
-                    m_specInfo.m_fitIntensity = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.fitSaturation) {
-                    m_specInfo.m_fitIntensity = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.peakSaturation) {
-                    m_specInfo.m_peakIntensity = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.offset) {
-                    m_specInfo.m_offset = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.delta) {
-                    m_evResult.m_delta = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.chiSquare) {
-                    m_evResult.m_chiSquare = (float)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.nSpec) {
-                    m_specInfo.m_numSpec = (long)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                if (curCol == m_col.expTime) {
-                    m_specInfo.m_exposureTime = (long)fValue;
-                    szToken = NULL;
-                    continue;
-                }
-
-                for (int k = 0; k < m_col.nSpecies; ++k) {
-                    if (curCol == m_col.column[k]) {
-                        m_evResult.m_referenceResult[k].m_column = (float)fValue;
-                        break;
-                    }
-                    if (curCol == m_col.columnError[k]) {
-                        m_evResult.m_referenceResult[k].m_columnError = (float)fValue;
-                        break;
-                    }
-                    if (curCol == m_col.shift[k]) {
-                        m_evResult.m_referenceResult[k].m_shift = (float)fValue;
-                        break;
-                    }
-                    if (curCol == m_col.shiftError[k]) {
-                        m_evResult.m_referenceResult[k].m_shiftError = (float)fValue;
-                        break;
-                    }
-                    if (curCol == m_col.squeeze[k]) {
-                        m_evResult.m_referenceResult[k].m_squeeze = (float)fValue;
-                        break;
-                    }
-                    if (curCol == m_col.squeezeError[k]) {
-                        m_evResult.m_referenceResult[k].m_squeezeError = (float)fValue;
-                        break;
-                    }
-                }
-                szToken = NULL;
-            }
+    // ignore columns whose value cannot be parsed into a float
+    char* valueEnd = nullptr;
+    const double fValue = strtod(szToken, &valueEnd);
+    if (valueEnd == szToken) {
+        return;
+    }
 
-            // start reading the next line in the evaluation log (i.e. the next
-            //  spectrum in the scan). Insert the data from this spectrum into the 
-            //  CScanResult structure
+    SetColumnValue(curCol, fValue);
+}
 
-             m_specInfo.m_scanIndex = (short)measNr;
-            if (Equals(m_specInfo.m_name, "sky")) {
-                newResult.SetSkySpecInfo(m_specInfo);
-            }
-            else if (Equals(m_specInfo.m_name, "dark")) {
-                newResult.SetDarkSpecInfo(m_specInfo);
-            }
-            else if (Equals(m_specInfo.m_name, "offset")) {
-                newResult.SetOffsetSpecInfo(m_specInfo);
-            }
-            else if (Equals(m_specInfo.m_name, "dark_cur")) {
-                newResult.SetDarkCurrentSpecInfo(m_specInfo);
-            }
-            else {
-                newResult.AppendResult(m_evResult, m_specInfo);
-                newResult.SetFlux(flux);
-                newResult.SetInstrumentType(m_instrumentType);
-            }
+void CEvaluationLogFileHandler::SetColumnValue(int curCol, double fValue) {
+    if (curCol == m_col.position) {
+        m_specInfo.m_scanAngle = (float)fValue;
+        return;
+    }
 
-            if (m_col.peakSaturation != -1) { // If the intensity is specified as a saturation ratio...
-                // double dynamicRange = CSpectrometerModel::GetMaxIntensity(m_specInfo.m_specModel);
-            }
-            newResult.CheckGoodnessOfFit(m_specInfo);
-            ++measNr;
-        }
+    if (curCol == m_col.position2) {
+        m_specInfo.m_scanAngle2 = (float)fValue;
+        return;
+    }
 
-        // close the evaluation log
-        fclose(f);
+    if (curCol == m_col.intensity) {
+        m_specInfo.m_peakIntensity = (float)fValue;
+        return;
     }
-    singleLock.Unlock();
 
-    // If the sky and dark were specified, remove them from the measurement
-    if (fabs(newResult.GetScanAngle(1) - 180.0) < 1) {
-        newResult.RemoveResult(0); // remove sky
-        newResult.RemoveResult(0); // remove dark
+    if (curCol == m_col.fitIntensity) {
+        m_specInfo.m_fitIntensity = (float)fValue;
+        return;
     }
 
-    // Calculate the offset
-    newResult.CalculateOffset(CMolecule(g_userSettings.m_molecule));
+    if (curCol == m_col.fitSaturation) {
+        m_specInfo.m_fitIntensity = (float)fValue;
+        return;
+    }
 
-    // Insert the new scan
-    m_scan.push_back(newResult);
+    if (curCol == m_col.peakSaturation) {
+        m_specInfo.m_peakIntensity = (float)fValue;
+        return;
+    }
 
-    newResult = Evaluation::CScanResult();
+    if (curCol == m_col.offset) {
+        m_specInfo.m_offset = (float)fValue;
+        return;
+    }
 
-    // Sort the scans in order of collection
-    SortScans();
+    if (curCol == m_col.delta) {
+        m_evResult.m_delta = (float)fValue;
+        return;
+    }
 
-    return SUCCESS;
+    if (curCol == m_col.chiSquare) {
+        m_evResult.m_chiSquare = (float)fValue;
+        return;
+    }
+
+    if (curCol == m_col.nSpec) {
+        m_specInfo.m_numSpec = (long)fValue;
+        return;
+    }
+
+    if (curCol == m_col.expTime) {
+        m_specInfo.m_exposureTime = (long)fValue;
+        return;
+    }
+
+    for (int k = 0; k < m_col.nSpecies; ++k) {
+        if (curCol == m_col.column[k]) {
+            m_evResult.m_referenceResult[k].m_column = (float)fValue;
+            break;
+        }
+        if (curCol == m_col.columnError[k]) {
+            m_evResult.m_referenceResult[k].m_columnError = (float)fValue;
+            break;
+        }
+        if (curCol == m_col.shift[k]) {
+            m_evResult.m_referenceResult[k].m_shift = (float)fValue;
+            break;
+        }
+        if (curCol == m_col.shiftError[k]) {
+            m_evResult.m_referenceResult[k].m_shiftError = (float)fValue;
+            break;
+        }
+        if (curCol == m_col.squeeze[k]) {
+            m_evResult.m_referenceResult[k].m_squeeze = (float)fValue;
+            break;
+        }
+        if (curCol == m_col.squeezeError[k]) {
+            m_evResult.m_referenceResult[k].m_squeezeError = (float)fValue;
+            break;
+        }
+    }
 }
 
-/** Makes a quick scan through the evaluation-log
-    to count the number of scans in it */
-long CEvaluationLogFileHandler::CountScansInFile() {
-    char  expTimeStr[] = "exposuretime"; // this string only exists in the header line.
-    char szLine[8192];
-    long  nScans = 0;
+void CEvaluationLogFileHandler::InsertSpectrum(LogParseState &state) {
+    Evaluation::CScanResult& newResult = state.scan;
 
-    // If no evaluation log selected, quit
-    if (strlen(m_evaluationLog) <= 1)
-        return 0;
+    m_specInfo.m_scanIndex = (short)state.measNr;
+    if (Equals(m_specInfo.m_name, "sky")) {
+        newResult.SetSkySpecInfo(m_specInfo);
+    }
+    else if (Equals(m_specInfo.m_name, "dark")) {
+        newResult.SetDarkSpecInfo(m_specInfo);
+    }
+    else if (Equals(m_specInfo.m_name, "offset")) {
+        newResult.SetOffsetSpecInfo(m_specInfo);
+    }
+    else if (Equals(m_specInfo.m_name, "dark_cur")) {
+        newResult.SetDarkCurrentSpecInfo(m_specInfo);
+    }
+    else {
+        newResult.AppendResult(m_evResult, m_specInfo);
+        newResult.SetFlux(state.flux);
+        newResult.SetInstrumentType(m_instrumentType);
+    }
 
-    novac::CSingleLock singleLock(&g_evalLogCritSect);
-    singleLock.Lock();
-    if (singleLock.IsLocked()) {
+    if (m_col.peakSaturation != -1) { // If the intensity is specified as a saturation ratio...
+        // double dynamicRange = CSpectrometerModel::GetMaxIntensity(m_specInfo.m_specModel);
+    }
+    newResult.CheckGoodnessOfFit(m_specInfo);
+    ++state.measNr;
+}
 
-        // Open the evaluation log
-        FILE *f = fopen(m_evaluationLog, "r");
-        if (NULL == f) {
-            singleLock.Unlock();
-            return 0;
+void CEvaluationLogFileHandler::ParseBinaryLog(const CBinaryEvaluationLog &log, LogParseState &state) {
+    // The text before the spectrum lines is parsed just as in the text evaluation log
+    CEvaluationLogContents header;
+    header.SetContents(log.Header());
+    ParseLines(header, state);
+
+    std::string token;
+    for (size_t line = 0; line < log.LineNum(); ++line) {
+        if (log.IsTextLine(line)) {
+            CEvaluationLogContents textLine;
+            textLine.SetContents(log.GetTextLine(line) + "\n");
+            ParseLines(textLine, state);
+            continue;
         }
 
-        // Read the file, one line at a time
-        while (fgets(szLine, 8192, f)) {
-            // convert the string to all lower-case letters
-            for (unsigned int it = 0; it < strlen(szLine); ++it) {
-                szLine[it] = (char)tolower(szLine[it]);
-            }
+        // the lines stored in the columns are ordinary spectrum lines,
+        //  which are only parsed when reading a scan
+        if (!state.readingScan)
+            continue;
 
-            // find the next start of a scan 
-            if (NULL != strstr(szLine, expTimeStr)) {
-                ++nScans;
+        for (size_t column = 0; column < log.ColumnNum(); ++column) {
+            const int curCol = (int)column;
+            const bool isTimeOrName = (curCol == m_col.starttime || curCol == m_col.stoptime || curCol == m_col.name);
+            const CBinaryEvaluationLog::ColumnType type = log.GetColumnType(column);
+
+            if (type == CBinaryEvaluationLog::ColumnType::Time && curCol == m_col.starttime) {
+                int hour, minute, second;
+                log.GetTime(column, line, hour, minute, second);
+                m_specInfo.m_startTime.hour = (unsigned char)hour;
+                m_specInfo.m_startTime.minute = (unsigned char)minute;
+                m_specInfo.m_startTime.second = (unsigned char)second;
+            }
+            else if (type == CBinaryEvaluationLog::ColumnType::Time && curCol == m_col.stoptime) {
+                int hour, minute, second;
+                log.GetTime(column, line, hour, minute, second);
+                m_specInfo.m_stopTime.hour = (unsigned char)hour;
+                m_specInfo.m_stopTime.minute = (unsigned char)minute;
+                m_specInfo.m_stopTime.second = (unsigned char)second;
+            }
+            else if (type == CBinaryEvaluationLog::ColumnType::Text && curCol == m_col.name && curCol != m_col.starttime && curCol != m_col.stoptime) {
+                m_specInfo.m_name = log.GetText(column, line);
+                std::transform(begin(m_specInfo.m_name), end(m_specInfo.m_name), begin(m_specInfo.m_name), [](char c) { return (char)tolower(c); });
+            }
+            else if (type != CBinaryEvaluationLog::ColumnType::Text && type != CBinaryEvaluationLog::ColumnType::Time && !isTimeOrName) {
+                SetColumnValue(curCol, log.GetValue(column, line));
+            }
+            else {
+                // the column doesn't contain what we expected, parse the value as in the text log
+                log.FormatValue(column, line, token);
+                std::transform(begin(token), end(token), begin(token), [](char c) { return (char)tolower(c); });
+                ParseSpectrumColumn(curCol, token.c_str());
             }
         }
 
-        fclose(f);
-
+        InsertSpectrum(state);
     }
-    singleLock.Unlock();
 
-    // Return the number of scans found in the file
-    return nScans;
+    CEvaluationLogContents footer;
+    footer.SetContents(log.Footer());
+    ParseLines(footer, state);
 }
 
 /** Reads and parses the 'scanInfo' header before the scan */
-void CEvaluationLogFileHandler::ParseScanInformation(CSpectrumInfo &scanInfo, double &flux, FILE *f) {
+void CEvaluationLogFileHandler::ParseScanInformation(CSpectrumInfo &scanInfo, double &flux, CEvaluationLogContents &file) {
     char szLine[8192];
     char *pt = NULL;
     int tmpInt[3];
@@ -647,10 +811,11 @@ void CEvaluationLogFileHandler::ParseScanInformation(CSpectrumInfo &scanInfo, do
     ResetColumns();
 
     // read the additional scan-information, line by line
-    while (fgets(szLine, 8192, f)) {
+    size_t lineLength = 0;
+    while (0 != (lineLength = file.ReadLine(szLine, sizeof(szLine)))) {
 
         // convert to lower-case
-        for (unsigned int it = 0; it < strlen(szLine); ++it) {
+        for (size_t it = 0; it < lineLength; ++it) {
             szLine[it] = (char)tolower(szLine[it]);
         }
 
@@ -811,7 +976,7 @@ void CEvaluationLogFileHandler::ParseScanInformation(CSpectrumInfo &scanInfo, do
     }
 }
 
-void CEvaluationLogFileHandler::ParseFluxInformation(Meteorology::CWindField &windField, double &flux, FILE *f) {
+void CEvaluationLogFileHandler::ParseFluxInformation(Meteorology::CWindField &windField, double &flux, CEvaluationLogContents &file) {
     char szLine[8192];
     char *pt = NULL;
     double windSpeed = 10, windDirection = 0, plumeHeight = 1000;
@@ -821,7 +986,7 @@ void CEvaluationLogFileHandler::ParseFluxInformation(Meteorology::CWindField &wi
     char source[512];
 
     // read the additional scan-information, line by line
-    while (fgets(szLine, 8192, f)) {
+    while (0 != file.ReadLine(szLine, sizeof(szLine))) {
         pt = strstr(szLine, "</fluxinfo>");
         if (nullptr != pt) {
             // save all the values
@@ -1107,81 +1272,11 @@ RETURN_CODE CEvaluationLogFileHandler::WriteEvaluationLog(const novac::CString f
 }
 
 RETURN_CODE CEvaluationLogFileHandler::FormatEvaluationResult(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies, novac::CString &string) {
-    int itSpecie;
-    Common common;
-
-    if (result != NULL && result->m_referenceResult.size() < nSpecies)
+    std::string line;
+    if (SUCCESS != CEvaluationLogWriter::FormatEvaluationResult(info, result, iType, maxIntensity, nSpecies, line))
         return FAIL; // something's wrong here!
 
-    // 1. The Scan angle
-    string.Format("%.0lf\t", info->m_scanAngle);
-
-    // 2. The azimuth angle
-    if (iType == INSTR_HEIDELBERG)
-        string.AppendFormat("%.0lf\t", info->m_scanAngle2);
-
-    // 3. The start time
-    string.AppendFormat("%02d:%02d:%02d\t", info->m_startTime.hour, info->m_startTime.minute, info->m_startTime.second);
-
-    // 4. The stop time
-    string.AppendFormat("%02d:%02d:%02d\t", info->m_stopTime.hour, info->m_stopTime.minute, info->m_stopTime.second);
-
-    // 5 The name of the spectrum
-    novac::CString simpleName;
-    SimplifyString(info->m_name, simpleName);
-    string.AppendFormat("%s\t", (const char*)simpleName);
-
-    // 6. The (maximum) saturation ratio of the whole spectrum,
-    //			the (maximum) saturation ratio in the fit-region
-    //			and the normalized maximum intensity of the whole spectrum
-    if (maxIntensity > 0.0) {
-        string.AppendFormat("%.2lf\t", info->m_peakIntensity / maxIntensity);
-        string.AppendFormat("%.2lf\t", info->m_fitIntensity / maxIntensity);
-    }
-    else {
-        string.AppendFormat("%.2lf\t", info->m_peakIntensity);
-        string.AppendFormat("%.2lf\t", info->m_fitIntensity);
-    }
-    string.AppendFormat("%.2lf\t", (info->m_peakIntensity - info->m_offset) / info->m_exposureTime);
-
-    // 7. The delta of the fit
-    if (result != NULL)
-        string.AppendFormat("%.2e\t", result->m_delta);
-    else
-        string.AppendFormat("%.2e\t", 0.0);
-
-    // 8. The chi-square of the fit
-    if (result != NULL)
-        string.AppendFormat("%.2e\t", result->m_chiSquare);
-    else
-        string.AppendFormat("%.2e\t", 0.0);
-
-    // 9. The exposure time and the number of spectra averaged
-    string.AppendFormat("%ld\t%ld\t", info->m_exposureTime, info->m_numSpec);
-
-    // 10. The column/column error for each specie
-    for (itSpecie = 0; itSpecie < nSpecies; ++itSpecie) {
-        if (result != NULL) {
-            string.AppendFormat("%.2e\t%.2e\t", result->m_referenceResult[itSpecie].m_column, result->m_referenceResult[itSpecie].m_columnError);
-            string.AppendFormat("%.2lf\t%.2lf\t", result->m_referenceResult[itSpecie].m_shift, result->m_referenceResult[itSpecie].m_shiftError);
-            string.AppendFormat("%.2lf\t%.2lf\t", result->m_referenceResult[itSpecie].m_squeeze, result->m_referenceResult[itSpecie].m_squeezeError);
-        }
-        else {
-            string.Append("0.0\t0.0\t0.0\t0.0\t0.0\t0.0\t");
-        }
-    }
-
-    // 11. The quality of the fit
-    if (result != NULL)
-        string.AppendFormat("%d\t", result->IsOK());
-    else
-        string.Append("1\t");
-
-    // 12. The offset
-    string.AppendFormat("%.0lf\t", info->m_offset);
-
-    // 13. The 'flag' in the spectra
-    string.AppendFormat("%d", info->m_flag);
+    string.SetData(line);
 
     return SUCCESS;
 }
@@ -4,9 +4,34 @@
 #include "../Evaluation/ScanResult.h"
 #include <PPPLib/CString.h>
 #include <PPPLib/CArray.h>
+#include <string>
+#include <vector>
 
 namespace FileHandler
 {
+    class CBinaryEvaluationLog;
+
+    /** The contents of an evaluation log, read into memory in one go such that the
+        log can be parsed in one pass without going back to the disk for each line. */
+    class CEvaluationLogContents
+    {
+    public:
+        /** Reads in the whole file. @return true if the file could be read */
+        bool ReadFile(const char* fileName);
+
+        /** Sets the contents to the given text, instead of reading it from file. */
+        void SetContents(const std::string& contents);
+
+        /** Retrieves the next line in the same way as fgets, i.e. the line is terminated
+            after the newline character or after at most maxLength-1 characters.
+            @return the length of the retrieved line, zero if the end of the file has been reached. */
+        size_t ReadLine(char* line, size_t maxLength);
+
+    private:
+        std::vector<char> m_data;
+        size_t m_position = 0;
+    };
+
     class CEvaluationLogFileHandler
     {
     public:
@@ -17,9 +42,20 @@ namespace FileHandler
 
         // ------------------- PUBLIC METHODS -------------------------
 
-        /** Reads the conents of the provided evaluation log and fills in all the members of this class. */
+        /** Reads the conents of the provided evaluation log and fills in all the members of this class.
+            This keeps all the parsing state in this object, different evaluation logs can hence be read
+            at the same time by different instances of this class running in different threads.
+            If there is a binary copy of the evaluation log (see CBinaryEvaluationLog) which is not older
+            than the evaluation log itself, then the binary copy is read instead.
+            The contents of the most recently read logs are kept in memory (see CEvaluationLogCache),
+            a log which has not changed since it was last read is hence not parsed again. */
         RETURN_CODE ReadEvaluationLog();
 
+        /** Parses the given contents of an evaluation log in the same way as ReadEvaluationLog
+            parses the contents of the file, without reading anything from disk.
+            This is used to get the scan of an evaluation log which has just been written. */
+        RETURN_CODE ParseEvaluationLog(const std::string& contents);
+
         /** Writes the contents of the array 'm_scan' to a new evaluation-log file */
         RETURN_CODE WriteEvaluationLog(const novac::CString fileName);
 
@@ -35,6 +71,7 @@ namespace FileHandler
                 @param info - the information about the spectrum
                 @param result - the evaluation result, can be NULL
                 @param string - will on return be filled with the output line to be written to the evaluation-log.
+                The formatting is done by CEvaluationLogWriter, which should be used directly when writing whole logs.
                 @return SUCCESS - always */
         static RETURN_CODE FormatEvaluationResult(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies, novac::CString &string);
 
@@ -93,15 +130,56 @@ namespace FileHandler
         /** The result from the evaluation of one spectrum. */
         Evaluation::CEvaluationResult m_evResult;
 
+        /** The state of the reading of the evaluation log, kept from one line to the next. */
+        struct LogParseState
+        {
+            /** The scan we're reading in right now */
+            Evaluation::CScanResult scan;
+
+            /** The current measurement position inside the scan */
+            int measNr = 0;
+
+            /** True while reading the spectrum lines of a scan */
+            bool readingScan = false;
+
+            /** The flux of the scan, as given in the scan- or flux-information */
+            double flux = 0.0;
+        };
+
+        /** @return true if there is a binary copy of m_evaluationLog which is not older than the log itself */
+        bool HasBinaryLog() const;
+
+        /** Finishes the scan which has just been parsed and adds it to m_scan */
+        void AddParsedScan(LogParseState &state);
+
+        /** Parses all the remaining lines in the given file */
+        void ParseLines(CEvaluationLogContents &file, LogParseState &state);
+
+        /** Parses one line of the evaluation log. The scan- and flux-information
+            sections following the line are read from the given file. */
+        void ParseLine(char *szLine, size_t lineLength, CEvaluationLogContents &file, LogParseState &state);
+
+        /** Parses the contents of column 'curCol' of one spectrum line */
+        void ParseSpectrumColumn(int curCol, const char* szToken);
+
+        /** Sets the numerical value of column 'curCol' of one spectrum line */
+        void SetColumnValue(int curCol, double fValue);
+
+        /** Inserts the spectrum whose line was just parsed into the scan */
+        void InsertSpectrum(LogParseState &state);
+
+        /** Parses the contents of a binary evaluation log, in the same way as the text evaluation log */
+        void ParseBinaryLog(const CBinaryEvaluationLog &log, LogParseState &state);
+
         /** Reads the header line for the scan information and retrieves which
             column represents which value. */
         void ParseScanHeader(const char szLine[8192]);
 
         /** Reads and parses the XML-shaped 'scanInfo' header before the scan */
-        void ParseScanInformation(CSpectrumInfo &scanInfo, double &flux, FILE *f);
+        void ParseScanInformation(CSpectrumInfo &scanInfo, double &flux, CEvaluationLogContents &file);
 
         /** Reads and parses the XML-shaped 'fluxInfo' header before the scan */
-        void ParseFluxInformation(Meteorology::CWindField &windField, double &flux, FILE *f);
+        void ParseFluxInformation(Meteorology::CWindField &windField, double &flux, CEvaluationLogContents &file);
 
         /** Resets the information about which column data is stored in */
         void ResetColumns();
@@ -109,10 +187,6 @@ namespace FileHandler
         /** Resets the old scan information */
         void ResetScanInformation();
 
-        /** Makes a quick scan through the evaluation-log
-            to count the number of scans in it */
-        long CountScansInFile();
-
         /** Sorts the scans in order of collection */
         void SortScans();
 
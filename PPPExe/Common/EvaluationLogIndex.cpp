@@ -0,0 +1,226 @@
+#include "EvaluationLogIndex.h"
+#include "SummaryFileWriter.h"
+#include "../Molecule.h"
+#include "../Configuration/UserConfiguration.h"
+#include "../Filesystem/Filesystem.h"
+#include <PPPLib/CFileUtils.h>
+#include <cstdio>
+#include <cstring>
+
+extern Configuration::CUserConfiguration        g_userSettings; // <-- The settings of the user
+extern FileHandler::CSummaryFileWriter          g_summaryFiles; // <-- The summary files shared by the evaluation threads
+
+using namespace FileHandler;
+
+static const char* s_indexHeader = "#file\tstarttime\tserial\tchannel\tfitwindow\tnspectra\tlastmodified\tsize\toffset\tcompleteness\tplumecentre\tplumecentre2\tplumeedgelow\tplumeedgehigh\n";
+
+void CEvaluationLogIndex::AddEvaluationLog(const std::string& evaluationLog, const std::string& fitWindow, const Evaluation::CScanResult& result)
+{
+    Filesystem::FileVersion version;
+    if (!Filesystem::GetFileVersion(evaluationLog, version))
+    {
+        return;
+    }
+
+    Entry entry;
+    const size_t directoryLength = GetDirectory(evaluationLog).size();
+    entry.fileName = evaluationLog.substr(directoryLength);
+
+    novac::CString serial;
+    MEASUREMENT_MODE mode;
+    novac::CFileUtils::GetInfoFromFileName(novac::CString(evaluationLog), entry.startTime, serial, entry.channel, mode);
+    entry.serial = serial.std_str();
+    entry.fitWindow = fitWindow;
+    entry.spectrumNum = result.GetEvaluatedNum();
+    entry.lastModified = version.lastModified;
+    entry.size = version.size;
+    entry.properties = CalculatePlumeProperties(result);
+
+    g_summaryFiles.Append(GetIndexFileName(GetDirectory(evaluationLog)), s_indexHeader, FormatEntry(entry));
+}
+
+bool CEvaluationLogIndex::Read(const std::string& directory)
+{
+    m_entries.clear();
+    m_entryLineNum = 0;
+
+    FILE* f = fopen(GetIndexFileName(directory).c_str(), "r");
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    char line[4096];
+    Entry entry;
+    while (fgets(line, sizeof(line), f))
+    {
+        // a line which isn't complete has not yet been fully written, ignore it
+        const size_t length = strlen(line);
+        if (length == 0 || line[length - 1] != '\n')
+        {
+            continue;
+        }
+        if (ParseEntry(line, entry))
+        {
+            m_entries[entry.fileName] = entry;
+            ++m_entryLineNum;
+        }
+    }
+    fclose(f);
+
+    return true;
+}
+
+const CEvaluationLogIndex::Entry* CEvaluationLogIndex::Find(const std::string& evaluationLog) const
+{
+    const size_t directoryLength = GetDirectory(evaluationLog).size();
+    auto pos = m_entries.find(evaluationLog.substr(directoryLength));
+    if (pos == m_entries.end())
+    {
+        return nullptr;
+    }
+
+    // check that the log hasn't been changed since it was added to the index
+    Filesystem::FileVersion version;
+    if (!Filesystem::GetFileVersion(evaluationLog, version) ||
+        version.lastModified != pos->second.lastModified ||
+        version.size != pos->second.size)
+    {
+        return nullptr;
+    }
+
+    return &pos->second;
+}
+
+bool CEvaluationLogIndex::Compact(const std::string& directory)
+{
+    // remove the entries of the logs which have been removed or changed
+    for (auto pos = m_entries.begin(); pos != m_entries.end(); )
+    {
+        Filesystem::FileVersion version;
+        if (!Filesystem::GetFileVersion(directory + pos->first, version) ||
+            version.lastModified != pos->second.lastModified ||
+            version.size != pos->second.size)
+        {
+            pos = m_entries.erase(pos);
+        }
+        else
+        {
+            ++pos;
+        }
+    }
+
+    if (m_entryLineNum == m_entries.size())
+    {
+        return false; // nothing to remove from the file
+    }
+
+    // write the remaining entries to a new file, which then replaces the index
+    const std::string indexFile = GetIndexFileName(directory);
+    const std::string newIndexFile = indexFile + ".new";
+    FILE* f = fopen(newIndexFile.c_str(), "w");
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = (EOF != fputs(s_indexHeader, f));
+    for (auto pos = m_entries.begin(); ok && pos != m_entries.end(); ++pos)
+    {
+        ok = (EOF != fputs(FormatEntry(pos->second).c_str(), f));
+    }
+    ok = (0 == fclose(f)) && ok;
+
+    if (!ok || 0 != remove(indexFile.c_str()) || 0 != rename(newIndexFile.c_str(), indexFile.c_str()))
+    {
+        remove(newIndexFile.c_str());
+        return false;
+    }
+
+    m_entryLineNum = m_entries.size();
+    return true;
+}
+
+CPlumeInScanProperty CEvaluationLogIndex::CalculatePlumeProperties(const Evaluation::CScanResult& result)
+{
+    const CMolecule molecule(g_userSettings.m_molecule);
+
+    Evaluation::CScanResult scan = result;
+    scan.CalculateOffset(molecule);
+    scan.CalculatePlumeCentre(molecule);
+
+    CPlumeInScanProperty properties;
+    scan.GetCalculatedPlumeProperties(properties);
+    return properties;
+}
+
+std::string CEvaluationLogIndex::GetDirectory(const std::string& path)
+{
+    const size_t separator = path.find_last_of("/\\");
+    return (separator == std::string::npos) ? std::string() : path.substr(0, separator + 1);
+}
+
+std::string CEvaluationLogIndex::GetIndexFileName(const std::string& directory)
+{
+    return directory + "EvaluationLogIndex.txt";
+}
+
+std::string CEvaluationLogIndex::FormatEntry(const Entry& entry)
+{
+    novac::CString line;
+    line.Format("%s\t%04d.%02d.%02dT%02d:%02d:%02d\t%s\t%d\t%s\t%ld\t%lld\t%lld\t",
+        entry.fileName.c_str(),
+        entry.startTime.year, entry.startTime.month, entry.startTime.day,
+        entry.startTime.hour, entry.startTime.minute, entry.startTime.second,
+        entry.serial.c_str(),
+        entry.channel,
+        entry.fitWindow.c_str(),
+        entry.spectrumNum,
+        entry.lastModified,
+        entry.size);
+
+    // the plume properties are written with full precision, such that they are read back unchanged
+    line.AppendFormat("%.17g\t%.17g\t%.17g\t%.17g\t%.17g\t%.17g\n",
+        entry.properties.offset,
+        entry.properties.completeness,
+        entry.properties.plumeCenter,
+        entry.properties.plumeCenter2,
+        entry.properties.plumeEdgeLow,
+        entry.properties.plumeEdgeHigh);
+
+    return line.std_str();
+}
+
+bool CEvaluationLogIndex::ParseEntry(const char* line, Entry& entry)
+{
+    if (line[0] == '#')
+    {
+        return false; // the header
+    }
+
+    char fileName[1024], serial[256], fitWindow[256];
+    int year, month, day, hour, minute, second;
+    double offset, completeness, plumeCentre, plumeCentre2, plumeEdgeLow, plumeEdgeHigh;
+    const int nParsed = sscanf(line, "%1023[^\t]\t%d.%d.%dT%d:%d:%d\t%255[^\t]\t%d\t%255[^\t]\t%ld\t%lld\t%lld\t%lf\t%lf\t%lf\t%lf\t%lf\t%lf",
+        fileName, &year, &month, &day, &hour, &minute, &second, serial, &entry.channel, fitWindow,
+        &entry.spectrumNum, &entry.lastModified, &entry.size,
+        &offset, &completeness, &plumeCentre, &plumeCentre2, &plumeEdgeLow, &plumeEdgeHigh);
+    if (nParsed != 19)
+    {
+        return false;
+    }
+
+    entry.fileName = fileName;
+    entry.startTime = CDateTime(year, month, day, hour, minute, second);
+    entry.serial = serial;
+    entry.fitWindow = fitWindow;
+    entry.properties = CPlumeInScanProperty();
+    entry.properties.offset = offset;
+    entry.properties.completeness = completeness;
+    entry.properties.plumeCenter = plumeCentre;
+    entry.properties.plumeCenter2 = plumeCentre2;
+    entry.properties.plumeEdgeLow = plumeEdgeLow;
+    entry.properties.plumeEdgeHigh = plumeEdgeHigh;
+
+    return true;
+}
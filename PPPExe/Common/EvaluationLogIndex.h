@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../Evaluation/ScanResult.h"
+#include <SpectralEvaluation/DateTime.h>
+#include <SpectralEvaluation/Flux/PlumeInScanProperty.h>
+#include <map>
+#include <string>
+
+namespace FileHandler
+{
+    /** <b>CEvaluationLogIndex</b> is the index of the evaluation logs in one directory.
+        The index is a text file in the same directory as the logs ('EvaluationLogIndex.txt')
+        with one line for each log, containing the information about the scan which is needed
+        to locate the log (start time, serial, channel, fit-window, number of spectra and the
+        properties of the plume in the scan). This makes it possible to find the evaluated scans
+        from an earlier processing without having to read all the evaluation logs.
+
+        Each line also contains the time the log was last modified and its size, an entry
+        is only used as long as the log has not been changed since it was added to the index.
+        The lines are only ever appended to the index, through the summary file writer, such
+        that the index is well formed also while several threads are adding logs to it.
+        If a log appears more than once, then the last line is used. */
+    class CEvaluationLogIndex
+    {
+    public:
+        struct Entry
+        {
+            /** The name of the evaluation log, without the directory */
+            std::string fileName;
+
+            /** The start time of the scan, as given by the name of the log */
+            CDateTime startTime;
+
+            std::string serial;
+            int channel = 0;
+            std::string fitWindow;
+
+            /** The number of evaluated spectra in the scan */
+            long spectrumNum = 0;
+
+            /** The version of the log when it was added to the index */
+            long long lastModified = 0;
+            long long size = 0;
+
+            /** The properties of the plume in the scan */
+            CPlumeInScanProperty properties;
+        };
+
+        /** Adds the given (just written) evaluation log to the index of its directory.
+            @param evaluationLog the full path of the evaluation log.
+            @param result the scan as read from the evaluation log by CEvaluationLogFileHandler. */
+        static void AddEvaluationLog(const std::string& evaluationLog, const std::string& fitWindow, const Evaluation::CScanResult& result);
+
+        /** Reads in the index of the given directory.
+            @return false if there is no index in the directory. */
+        bool Read(const std::string& directory);
+
+        /** Finds the entry of the given evaluation log, if the log has not been
+            changed since it was added to the index.
+            @param evaluationLog the full path of the evaluation log.
+            @return the entry or nullptr if the log is not in the index or has been changed. */
+        const Entry* Find(const std::string& evaluationLog) const;
+
+        /** Removes the entries of the logs which no longer exist or which have been changed since they
+            were added to the index. If the index file of the given directory contained any such entries,
+            or more than one entry for the same log, then the file is rewritten with only the remaining
+            entries, such that the index doesn't grow without limit.
+            This must not be called while logs are being added to the index of the directory.
+            @return true if the index file was rewritten. */
+        bool Compact(const std::string& directory);
+
+        /** Calculates the properties of the plume in the given scan, in the same way
+            for the logs added to the index as for the logs which are not in the index. */
+        static CPlumeInScanProperty CalculatePlumeProperties(const Evaluation::CScanResult& result);
+
+        /** @return the directory part of the given path, including the trailing separator. */
+        static std::string GetDirectory(const std::string& path);
+
+        /** @return the full path of the index file of the given directory. */
+        static std::string GetIndexFileName(const std::string& directory);
+
+        /** Formats one line of the index, including the trailing newline. */
+        static std::string FormatEntry(const Entry& entry);
+
+        /** Parses one line of the index.
+            @return false if the line is not a valid entry (e.g. the header). */
+        static bool ParseEntry(const char* line, Entry& entry);
+
+    private:
+        /** The entries in the index, by file name */
+        std::map<std::string, Entry> m_entries;
+
+        /** The number of entries in the index file, including the ones which were replaced by a later entry */
+        size_t m_entryLineNum = 0;
+    };
+}
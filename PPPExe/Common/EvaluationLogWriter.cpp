@@ -0,0 +1,314 @@
+#include "EvaluationLogWriter.h"
+#include "TextFileWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace FileHandler;
+
+// The powers of ten which can be exactly represented as a double
+static const double s_powerOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/** @return true if 'value' is too close to halfway between two integers to be sure
+    in which direction it is rounded, given the rounding error of the calculation of 'value'. */
+static bool IsCloseToTie(double value)
+{
+    const double distanceToHalf = std::fabs(value - std::floor(value) - 0.5);
+    return distanceToHalf < 1e-9 * (value + 1.0);
+}
+
+/** Appends 'value' formatted using sprintf, this is used for the values which are
+    not handled by the formatting below (e.g. infinity, NaN and exact ties in the rounding). */
+static void AppendPrintf(std::string& str, const char* format, double value)
+{
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer), format, value);
+    str.append(buffer);
+}
+
+/** Appends the digits of the non-negative integer 'value' */
+static void AppendDigits(std::string& str, unsigned long long value)
+{
+    char digits[24];
+    int nDigits = 0;
+    do {
+        digits[nDigits++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+
+    while (nDigits > 0) {
+        str.push_back(digits[--nDigits]);
+    }
+}
+
+CEvaluationLogWriter& CEvaluationLogWriter::ForCurrentThread()
+{
+    static thread_local CEvaluationLogWriter writer;
+    return writer;
+}
+
+void CEvaluationLogWriter::Clear()
+{
+    m_buffer.clear();
+    m_line.clear();
+}
+
+void CEvaluationLogWriter::Append(const char* text)
+{
+    m_buffer.append(text);
+}
+
+RETURN_CODE CEvaluationLogWriter::AppendEvaluationResult(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies)
+{
+    if (result != NULL && result->m_referenceResult.size() < (size_t)nSpecies)
+        return FAIL; // something's wrong here!
+
+    if (info->m_name != m_lastName || m_lastSimpleName.empty()) {
+        novac::CString simpleName;
+        novac::SimplifyString(novac::CString(info->m_name), simpleName);
+        m_lastName = info->m_name;
+        m_lastSimpleName = simpleName.std_str();
+    }
+
+    FormatLine(info, result, iType, maxIntensity, nSpecies, m_lastSimpleName, m_line);
+
+    m_buffer.append(m_line);
+    m_buffer.push_back('\n');
+
+    return SUCCESS;
+}
+
+RETURN_CODE CEvaluationLogWriter::WriteToFile(const novac::CString& fileName, bool compress) const
+{
+    CTextFileWriter file;
+    if (!file.Open(fileName.std_str(), compress))
+        return FAIL;
+
+    file.Write(m_buffer.data(), m_buffer.size());
+
+    return file.Close() ? SUCCESS : FAIL;
+}
+
+RETURN_CODE CEvaluationLogWriter::FormatEvaluationResult(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies, std::string& line)
+{
+    if (result != NULL && result->m_referenceResult.size() < (size_t)nSpecies)
+        return FAIL; // something's wrong here!
+
+    novac::CString simpleName;
+    novac::SimplifyString(novac::CString(info->m_name), simpleName);
+
+    FormatLine(info, result, iType, maxIntensity, nSpecies, simpleName.std_str(), line);
+
+    return SUCCESS;
+}
+
+void CEvaluationLogWriter::FormatLine(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies, const std::string& simpleName, std::string& line)
+{
+    line.clear();
+
+    // 1. The Scan angle
+    AppendDecimal0(line, info->m_scanAngle);
+    line.push_back('\t');
+
+    // 2. The azimuth angle
+    if (iType == INSTR_HEIDELBERG) {
+        AppendDecimal0(line, info->m_scanAngle2);
+        line.push_back('\t');
+    }
+
+    // 3. The start time
+    AppendTwoDigits(line, info->m_startTime.hour);
+    line.push_back(':');
+    AppendTwoDigits(line, info->m_startTime.minute);
+    line.push_back(':');
+    AppendTwoDigits(line, info->m_startTime.second);
+    line.push_back('\t');
+
+    // 4. The stop time
+    AppendTwoDigits(line, info->m_stopTime.hour);
+    line.push_back(':');
+    AppendTwoDigits(line, info->m_stopTime.minute);
+    line.push_back(':');
+    AppendTwoDigits(line, info->m_stopTime.second);
+    line.push_back('\t');
+
+    // 5 The name of the spectrum
+    line.append(simpleName);
+    line.push_back('\t');
+
+    // 6. The (maximum) saturation ratio of the whole spectrum,
+    //			the (maximum) saturation ratio in the fit-region
+    //			and the normalized maximum intensity of the whole spectrum
+    if (maxIntensity > 0.0) {
+        AppendDecimal2(line, info->m_peakIntensity / maxIntensity);
+        line.push_back('\t');
+        AppendDecimal2(line, info->m_fitIntensity / maxIntensity);
+        line.push_back('\t');
+    }
+    else {
+        AppendDecimal2(line, info->m_peakIntensity);
+        line.push_back('\t');
+        AppendDecimal2(line, info->m_fitIntensity);
+        line.push_back('\t');
+    }
+    AppendDecimal2(line, (info->m_peakIntensity - info->m_offset) / info->m_exposureTime);
+    line.push_back('\t');
+
+    // 7. The delta of the fit
+    AppendExponent2(line, (result != NULL) ? result->m_delta : 0.0);
+    line.push_back('\t');
+
+    // 8. The chi-square of the fit
+    AppendExponent2(line, (result != NULL) ? result->m_chiSquare : 0.0);
+    line.push_back('\t');
+
+    // 9. The exposure time and the number of spectra averaged
+    AppendInteger(line, info->m_exposureTime);
+    line.push_back('\t');
+    AppendInteger(line, info->m_numSpec);
+    line.push_back('\t');
+
+    // 10. The column/column error for each specie
+    for (int itSpecie = 0; itSpecie < nSpecies; ++itSpecie) {
+        if (result != NULL) {
+            const auto& reference = result->m_referenceResult[itSpecie];
+            AppendExponent2(line, reference.m_column);
+            line.push_back('\t');
+            AppendExponent2(line, reference.m_columnError);
+            line.push_back('\t');
+            AppendDecimal2(line, reference.m_shift);
+            line.push_back('\t');
+            AppendDecimal2(line, reference.m_shiftError);
+            line.push_back('\t');
+            AppendDecimal2(line, reference.m_squeeze);
+            line.push_back('\t');
+            AppendDecimal2(line, reference.m_squeezeError);
+            line.push_back('\t');
+        }
+        else {
+            line.append("0.0\t0.0\t0.0\t0.0\t0.0\t0.0\t");
+        }
+    }
+
+    // 11. The quality of the fit
+    if (result != NULL) {
+        AppendInteger(line, (int)result->IsOK());
+        line.push_back('\t');
+    }
+    else {
+        line.append("1\t");
+    }
+
+    // 12. The offset
+    AppendDecimal0(line, info->m_offset);
+    line.push_back('\t');
+
+    // 13. The 'flag' in the spectra
+    AppendInteger(line, info->m_flag);
+}
+
+void CEvaluationLogWriter::AppendFixed(std::string& str, double value, int decimals)
+{
+    const char* format = (decimals == 0) ? "%.0lf" : "%.2lf";
+    const double absValue = std::fabs(value);
+
+    // Larger values and values exactly halfway between two possible results are left to printf
+    if (!std::isfinite(value) || absValue >= 1e13) {
+        AppendPrintf(str, format, value);
+        return;
+    }
+    const double scaled = absValue * s_powerOfTen[decimals];
+    if (IsCloseToTie(scaled)) {
+        AppendPrintf(str, format, value);
+        return;
+    }
+    const unsigned long long rounded = (unsigned long long)std::floor(scaled + 0.5);
+
+    // printf keeps the sign of negative values which are rounded to zero
+    if (std::signbit(value)) {
+        str.push_back('-');
+    }
+
+    if (decimals == 0) {
+        AppendDigits(str, rounded);
+    }
+    else {
+        AppendDigits(str, rounded / 100);
+        str.push_back('.');
+        str.push_back((char)('0' + (rounded / 10) % 10));
+        str.push_back((char)('0' + rounded % 10));
+    }
+}
+
+void CEvaluationLogWriter::AppendExponent2(std::string& str, double value)
+{
+    const double absValue = std::fabs(value);
+
+    if (absValue == 0.0) {
+        str.append(std::signbit(value) ? "-0.00e+00" : "0.00e+00");
+        return;
+    }
+    if (!std::isfinite(value) || absValue < 1e-19 || absValue >= 1e23) {
+        AppendPrintf(str, "%.2e", value);
+        return;
+    }
+
+    // Scale the value such that the three significant digits are before the decimal point.
+    //  This is done with one single multiplication or division by an exactly representable
+    //  power of ten, which means that the scaled value only has the rounding error of one operation.
+    int exponent = (int)std::floor(std::log10(absValue));
+    auto scale = [absValue](int e) { return (e <= 2) ? absValue * s_powerOfTen[2 - e] : absValue / s_powerOfTen[e - 2]; };
+    double mantissa = scale(exponent);
+    if (mantissa < 100.0) {
+        mantissa = scale(--exponent);
+    }
+    else if (mantissa >= 1000.0) {
+        mantissa = scale(++exponent);
+    }
+    if (IsCloseToTie(mantissa)) {
+        AppendPrintf(str, "%.2e", value);
+        return;
+    }
+
+    unsigned long long rounded = (unsigned long long)std::floor(mantissa + 0.5);
+    if (rounded >= 1000) {
+        rounded /= 10;
+        ++exponent;
+    }
+
+    if (std::signbit(value)) {
+        str.push_back('-');
+    }
+    str.push_back((char)('0' + rounded / 100));
+    str.push_back('.');
+    str.push_back((char)('0' + (rounded / 10) % 10));
+    str.push_back((char)('0' + rounded % 10));
+    str.push_back('e');
+    str.push_back((exponent < 0) ? '-' : '+');
+    const int absExponent = (exponent < 0) ? -exponent : exponent;
+    if (absExponent < 10) {
+        str.push_back('0');
+    }
+    AppendDigits(str, (unsigned long long)absExponent);
+}
+
+void CEvaluationLogWriter::AppendInteger(std::string& str, long long value)
+{
+    if (value < 0) {
+        str.push_back('-');
+        AppendDigits(str, 0ULL - (unsigned long long)value);
+    }
+    else {
+        AppendDigits(str, (unsigned long long)value);
+    }
+}
+
+void CEvaluationLogWriter::AppendTwoDigits(std::string& str, int value)
+{
+    if (value >= 0 && value < 10) {
+        str.push_back('0');
+    }
+    AppendInteger(str, value);
+}
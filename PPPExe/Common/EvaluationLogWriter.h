@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Common.h"
+#include <SpectralEvaluation/Spectra/Spectrum.h>
+#include <SpectralEvaluation/Evaluation/EvaluationResult.h>
+#include <PPPLib/CString.h>
+#include <string>
+
+namespace FileHandler
+{
+    /** <b>CEvaluationLogWriter</b> builds the contents of one evaluation log in memory,
+        such that the whole log can be written to disk with one single write.
+
+        The evaluation results of the spectra are formatted directly into the buffer
+        of the writer, without going through printf or any temporary strings,
+        giving exactly the same text as CEvaluationLogFileHandler::FormatEvaluationResult.
+        The buffer is kept between the logs, use ForCurrentThread() to get a writer
+        which is reused by all the logs written by the calling thread. */
+    class CEvaluationLogWriter
+    {
+    public:
+        /** @return the writer belonging to the calling thread */
+        static CEvaluationLogWriter& ForCurrentThread();
+
+        /** Empties the log, the allocated memory is kept. */
+        void Clear();
+
+        /** Appends the given text to the log */
+        void Append(const char* text);
+
+        /** Formats the evaluation result of one spectrum and appends it to the log as one line.
+            The parameters are the same as for CEvaluationLogFileHandler::FormatEvaluationResult.
+            @return SUCCESS if the line was appended. */
+        RETURN_CODE AppendEvaluationResult(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies);
+
+        /** @return the contents of the log */
+        const std::string& Contents() const { return m_buffer; }
+
+        /** @return the most recently appended evaluation result, without the newline character */
+        const std::string& LastLine() const { return m_line; }
+
+        /** Writes the log to the given file, replacing any existing file.
+            @param compress if true then the file is gzip-compressed.
+            @return SUCCESS if the file could be written. */
+        RETURN_CODE WriteToFile(const novac::CString& fileName, bool compress = false) const;
+
+        /** Formats the evaluation result of one spectrum into the given line,
+            see CEvaluationLogFileHandler::FormatEvaluationResult. */
+        static RETURN_CODE FormatEvaluationResult(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies, std::string& line);
+
+        // ------------- Formatting of single values -------------
+        // These give the same result as sprintf with the format given in the name.
+
+        /** Appends 'value' formatted as "%.0lf" */
+        static void AppendDecimal0(std::string& str, double value) { AppendFixed(str, value, 0); }
+
+        /** Appends 'value' formatted as "%.2lf" */
+        static void AppendDecimal2(std::string& str, double value) { AppendFixed(str, value, 2); }
+
+        /** Appends 'value' formatted as "%.2e" */
+        static void AppendExponent2(std::string& str, double value);
+
+        /** Appends 'value' formatted as "%ld" */
+        static void AppendInteger(std::string& str, long long value);
+
+        /** Appends 'value' formatted as "%02d" */
+        static void AppendTwoDigits(std::string& str, int value);
+
+    private:
+        /** The contents of the log */
+        std::string m_buffer;
+
+        /** The most recently formatted evaluation result */
+        std::string m_line;
+
+        /** The most recently simplified spectrum name, the spectra in one
+            scan mostly have the same name which then only needs to be simplified once. */
+        std::string m_lastName;
+        std::string m_lastSimpleName;
+
+        static void AppendFixed(std::string& str, double value, int decimals);
+
+        static void FormatLine(const CSpectrumInfo *info, const Evaluation::CEvaluationResult *result, INSTRUMENT_TYPE iType, double maxIntensity, int nSpecies, const std::string& simpleName, std::string& line);
+    };
+}
@@ -0,0 +1,242 @@
+#include "PakFileCatalog.h"
+#include "../Filesystem/Filesystem.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace FileHandler;
+
+// Global variables;
+FileHandler::CPakFileCatalog g_pakFileCatalog; // <-- The information about the .pak-files to evaluate
+
+// The fields of the MKZY header of a spectrum in a .pak-file which are needed by the catalog.
+//  See the struct MKZYhdr in mk_pack.c for the full header. The fields are stored in little-endian order.
+struct MKZYHeader
+{
+    unsigned int headerSize = 0;    // the size of the header, in bytes
+    unsigned int dataSize = 0;      // the size of the compressed spectrum following the header, in bytes
+    std::string instrumentName;
+    int channel = 0;
+    unsigned int date = 0;          // ddmmyy
+    unsigned int startTime = 0;     // hhmmsscc
+};
+
+static const size_t s_mkzyHeaderMinSize = 64; // up to and including the stop time
+
+static unsigned int ReadLittleEndian(const unsigned char* data, size_t nBytes)
+{
+    unsigned int value = 0;
+    for (size_t k = nBytes; k > 0; --k)
+    {
+        value = (value << 8) | data[k - 1];
+    }
+    return value;
+}
+
+// Reads the header of the next spectrum in the file and skips past its (compressed) data,
+//  without decompressing the spectrum.
+static bool ReadNextSpectrumHeader(FILE* f, MKZYHeader& header)
+{
+    unsigned char data[s_mkzyHeaderMinSize];
+    if (fread(data, 1, sizeof(data), f) != sizeof(data) || 0 != memcmp(data, "MKZY", 4))
+    {
+        return false;
+    }
+
+    header.headerSize = ReadLittleEndian(data + 4, 2);
+    header.dataSize = ReadLittleEndian(data + 8, 2);
+    if (header.headerSize < s_mkzyHeaderMinSize)
+    {
+        return false;
+    }
+
+    const char* instrumentName = (const char*)(data + 24);
+    header.instrumentName = std::string(instrumentName, std::find(instrumentName, instrumentName + 16, '\0'));
+    header.channel = data[50];
+    header.date = ReadLittleEndian(data + 52, 4);
+    header.startTime = ReadLittleEndian(data + 56, 4);
+
+    return (0 == fseek(f, (long)(header.headerSize - s_mkzyHeaderMinSize + header.dataSize), SEEK_CUR));
+}
+
+static CDateTime GetStartTime(const MKZYHeader& header)
+{
+    return CDateTime(2000 + header.date % 100, (header.date / 100) % 100, header.date / 10000,
+        header.startTime / 1000000, (header.startTime / 10000) % 100, (header.startTime / 100) % 100);
+}
+
+bool CPakFileCatalog::ReadEntry(const std::string& pakFile, Entry& entry)
+{
+    Filesystem::FileVersion version;
+    if (!Filesystem::GetFileVersion(pakFile, version))
+    {
+        return false;
+    }
+    entry.lastModified = version.lastModified;
+    entry.size = version.size;
+
+    // Read the header of the first spectrum in the scan, the spectra themselves are never decompressed
+    FILE* f = fopen(pakFile.c_str(), "rb");
+    if (f == nullptr)
+    {
+        return false;
+    }
+    MKZYHeader header;
+    if (!ReadNextSpectrumHeader(f, header))
+    {
+        fclose(f);
+        return false;
+    }
+    entry.channel = header.channel;
+
+    // If the GPS had no connection with the satelites when collecting the sky-spectrum,
+    //   then try to find a spectrum in the file for which it had connection...
+    CDateTime startTime = GetStartTime(header);
+    while (startTime.year == 2004 && startTime.month == 3 && startTime.second == 22)
+    {
+        MKZYHeader nextHeader;
+        if (!ReadNextSpectrumHeader(f, nextHeader))
+        {
+            break;
+        }
+        header = nextHeader;
+        startTime = GetStartTime(header);
+    }
+    fclose(f);
+
+    entry.serial = header.instrumentName;
+    entry.startTime = startTime;
+
+    return true;
+}
+
+size_t CPakFileCatalog::Build(const std::vector<std::string>& pakFiles, unsigned int nThreads)
+{
+    // find the files which need to be read
+    std::vector<std::string> filesToRead;
+    for (const std::string& file : pakFiles)
+    {
+        Entry entry;
+        if (!Find(file, entry))
+        {
+            filesToRead.push_back(file);
+        }
+    }
+
+    // read the files in parallel, each thread takes the next file which no other thread has taken
+    std::vector<Entry> entries(filesToRead.size());
+    std::vector<char> succeeded(filesToRead.size(), 0);
+    std::atomic<size_t> nextFile{ 0 };
+    auto readFiles = [&]() {
+        size_t index;
+        while ((index = nextFile++) < filesToRead.size())
+        {
+            succeeded[index] = ReadEntry(filesToRead[index], entries[index]) ? 1 : 0;
+        }
+    };
+
+    nThreads = std::max(1U, std::min(nThreads, (unsigned int)filesToRead.size()));
+    std::vector<std::thread> threads;
+    for (unsigned int threadIdx = 1; threadIdx < nThreads; ++threadIdx)
+    {
+        threads.push_back(std::thread(readFiles));
+    }
+    readFiles();
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    for (size_t k = 0; k < filesToRead.size(); ++k)
+    {
+        if (succeeded[k])
+        {
+            m_entries[filesToRead[k]] = entries[k];
+        }
+    }
+
+    return filesToRead.size();
+}
+
+bool CPakFileCatalog::Find(const std::string& pakFile, Entry& entry) const
+{
+    auto pos = m_entries.find(pakFile);
+    if (pos == m_entries.end())
+    {
+        return false;
+    }
+
+    // check that the file hasn't been changed since it was added to the catalog
+    Filesystem::FileVersion version;
+    if (!Filesystem::GetFileVersion(pakFile, version) ||
+        version.lastModified != pos->second.lastModified ||
+        version.size != pos->second.size)
+    {
+        return false;
+    }
+
+    entry = pos->second;
+    return true;
+}
+
+bool CPakFileCatalog::ReadFromFile(const std::string& fileName)
+{
+    m_entries.clear();
+
+    FILE* f = fopen(fileName.c_str(), "r");
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    char line[4096];
+    char pakFile[4096];
+    char serial[256];
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#')
+        {
+            continue; // the header
+        }
+
+        Entry entry;
+        int year, month, day, hour, minute, second;
+        const int nParsed = sscanf(line, "%4095[^\t]\t%lld\t%lld\t%255[^\t]\t%d\t%d.%d.%dT%d:%d:%d",
+            pakFile, &entry.lastModified, &entry.size, serial, &entry.channel,
+            &year, &month, &day, &hour, &minute, &second);
+        if (nParsed != 11)
+        {
+            continue;
+        }
+        entry.serial = serial;
+        entry.startTime = CDateTime(year, month, day, hour, minute, second);
+
+        m_entries[pakFile] = entry;
+    }
+    fclose(f);
+
+    return true;
+}
+
+bool CPakFileCatalog::WriteToFile(const std::string& fileName) const
+{
+    FILE* f = fopen(fileName.c_str(), "w");
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    fprintf(f, "#file\tlastmodified\tsize\tserial\tchannel\tstarttime\n");
+    for (const auto& item : m_entries)
+    {
+        const Entry& entry = item.second;
+        fprintf(f, "%s\t%lld\t%lld\t%s\t%d\t%04d.%02d.%02dT%02d:%02d:%02d\n",
+            item.first.c_str(), entry.lastModified, entry.size, entry.serial.c_str(), entry.channel,
+            entry.startTime.year, entry.startTime.month, entry.startTime.day,
+            entry.startTime.hour, entry.startTime.minute, entry.startTime.second);
+    }
+
+    return (0 == fclose(f));
+}
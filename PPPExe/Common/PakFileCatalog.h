@@ -0,0 +1,68 @@
+#pragma once
+
+#include <SpectralEvaluation/DateTime.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace FileHandler
+{
+    /** <b>CPakFileCatalog</b> keeps the information about each .pak-file which is needed
+        before the file is evaluated (the serial-number of the spectrometer, the channel
+        and the start time of the scan), such that this doesn't need to be read from
+        the spectra each time it is needed.
+
+        The information is read from the header of the first spectrum(s) in each file.
+        The catalog can be saved to file and read back in, each entry then remembers the
+        time the .pak-file was last modified and its size such that changed files are read again.
+        The catalog is built before the evaluation starts and is not modified while the
+        evaluation threads are running, it can hence be read from several threads at the same time. */
+    class CPakFileCatalog
+    {
+    public:
+        struct Entry
+        {
+            std::string serial;
+            int channel = 0;
+
+            /** The start time of the scan */
+            CDateTime startTime;
+
+            /** The version of the .pak-file when it was added to the catalog */
+            long long lastModified = 0;
+            long long size = 0;
+        };
+
+        /** Adds all the given files which are not already in the catalog, or which
+            have been changed since they were added, to the catalog.
+            The files are read using the given number of threads.
+            @return the number of files which were read. */
+        size_t Build(const std::vector<std::string>& pakFiles, unsigned int nThreads);
+
+        /** Finds the given .pak-file in the catalog.
+            @return false if the file is not in the catalog or has been changed since it was added. */
+        bool Find(const std::string& pakFile, Entry& entry) const;
+
+        /** Reads the catalog from the given file, replacing the current contents.
+            @return false if the file could not be read. */
+        bool ReadFromFile(const std::string& fileName);
+
+        /** Writes the catalog to the given file.
+            @return false if the file could not be written. */
+        bool WriteToFile(const std::string& fileName) const;
+
+        /** Removes all entries */
+        void Clear() { m_entries.clear(); }
+
+        size_t Size() const { return m_entries.size(); }
+
+        /** Reads the information about the given .pak-file from the headers of the spectra
+            in the file, without decompressing the spectra.
+            @return false if the file could not be read. */
+        static bool ReadEntry(const std::string& pakFile, Entry& entry);
+
+    private:
+        /** The entries in the catalog, by the full path of the .pak-file */
+        std::map<std::string, Entry> m_entries;
+    };
+}
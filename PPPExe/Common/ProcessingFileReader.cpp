@@ -50,6 +50,62 @@ RETURN_CODE CProcessingFileReader::ReadProcessingFile(const novac::CString &file
             continue;
         }
 
+        // If we've found the option for running the processing as a pipeline
+        if (Equals(szToken, str_pipelinedProcessing, strlen(str_pipelinedProcessing))) {
+            int tmpInt = 0;
+            Parse_IntItem(ENDTAG(str_pipelinedProcessing), tmpInt);
+            settings.m_pipelinedProcessing = (tmpInt != 0);
+            continue;
+        }
+
+        // If we've found the number of threads to use for each scan
+        if (Equals(szToken, str_threadsPerScan, strlen(str_threadsPerScan))) {
+            int number = 1;
+            Parse_IntItem(ENDTAG(str_threadsPerScan), number);
+            settings.m_threadsPerScan = (unsigned long)std::max(1, number);
+            continue;
+        }
+
+        // If we've found the option for keeping the evaluated scans in memory
+        if (Equals(szToken, str_keepScanResultsInMemory, strlen(str_keepScanResultsInMemory))) {
+            int tmpInt = 0;
+            Parse_IntItem(ENDTAG(str_keepScanResultsInMemory), tmpInt);
+            settings.m_keepScanResultsInMemory = (tmpInt != 0);
+            continue;
+        }
+
+        // If we've found the option for writing binary copies of the evaluation logs
+        if (Equals(szToken, str_writeBinaryEvaluationLogs, strlen(str_writeBinaryEvaluationLogs))) {
+            int tmpInt = 0;
+            Parse_IntItem(ENDTAG(str_writeBinaryEvaluationLogs), tmpInt);
+            settings.m_writeBinaryEvaluationLogs = (tmpInt != 0);
+            continue;
+        }
+
+        // If we've found the size of the memory for the most recently read evaluation logs
+        if (Equals(szToken, str_evaluationLogCacheSize, strlen(str_evaluationLogCacheSize))) {
+            int tmpInt = 0;
+            Parse_IntItem(ENDTAG(str_evaluationLogCacheSize), tmpInt);
+            settings.m_evaluationLogCacheSize = (unsigned long)std::max(tmpInt, 0);
+            continue;
+        }
+
+        // If we've found the option for dropping log messages when the log can't keep up
+        if (Equals(szToken, str_dropLogMessagesWhenBusy, strlen(str_dropLogMessagesWhenBusy))) {
+            int tmpInt = 0;
+            Parse_IntItem(ENDTAG(str_dropLogMessagesWhenBusy), tmpInt);
+            settings.m_dropLogMessagesWhenBusy = (tmpInt != 0);
+            continue;
+        }
+
+        // If we've found the option for compressing the logs
+        if (Equals(szToken, str_compressLogs, strlen(str_compressLogs))) {
+            int tmpInt = 0;
+            Parse_IntItem(ENDTAG(str_compressLogs), tmpInt);
+            settings.m_compressLogs = (tmpInt != 0);
+            continue;
+        }
+
         // If we've found the beginning date
         if (Equals(szToken, str_fromDate, strlen(str_fromDate))) {
             Parse_Date(ENDTAG(str_fromDate), settings.m_fromDate);
@@ -435,6 +491,13 @@ RETURN_CODE CProcessingFileReader::WriteProcessingFile(const novac::CString &fil
     fprintf(f, "<NovacPostProcessing>\n");
 
     PrintParameter(f, 1, str_maxThreadNum, settings.m_maxThreadNum);
+    PrintParameter(f, 1, str_pipelinedProcessing, settings.m_pipelinedProcessing ? 1 : 0);
+    PrintParameter(f, 1, str_threadsPerScan, settings.m_threadsPerScan);
+    PrintParameter(f, 1, str_keepScanResultsInMemory, settings.m_keepScanResultsInMemory ? 1 : 0);
+    PrintParameter(f, 1, str_writeBinaryEvaluationLogs, settings.m_writeBinaryEvaluationLogs ? 1 : 0);
+    PrintParameter(f, 1, str_evaluationLogCacheSize, settings.m_evaluationLogCacheSize);
+    PrintParameter(f, 1, str_dropLogMessagesWhenBusy, settings.m_dropLogMessagesWhenBusy ? 1 : 0);
+    PrintParameter(f, 1, str_compressLogs, settings.m_compressLogs ? 1 : 0);
 
     // the output and temp directories
     PrintParameter(f, 1, str_outputDirectory, settings.m_outputDirectory);
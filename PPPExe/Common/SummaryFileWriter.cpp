@@ -0,0 +1,196 @@
+#include "SummaryFileWriter.h"
+#include "Common.h"
+#include <chrono>
+#include <vector>
+
+// Global variables;
+FileHandler::CSummaryFileWriter g_summaryFiles; // <-- The summary files shared by the evaluation threads
+
+using namespace FileHandler;
+
+// The maximum number of records waiting to be written
+static const size_t s_queueCapacity = 4096;
+
+// The maximum number of records taken from the queue at a time
+static const size_t s_batchSize = 256;
+
+// The files are flushed when this much has been written to them...
+static const size_t s_flushSize = 64 * 1024;
+
+// ... or when this much time has passed since the last flush
+static const std::chrono::seconds s_flushInterval(2);
+
+// The maximum number of files kept open at the same time
+static const size_t s_maxOpenFiles = 64;
+
+CSummaryFileWriter::CSummaryFileWriter()
+{
+}
+
+CSummaryFileWriter::~CSummaryFileWriter()
+{
+    Stop();
+}
+
+void CSummaryFileWriter::Start()
+{
+    std::lock_guard<std::mutex> lock(m_queueGuard);
+    if (m_queue != nullptr)
+    {
+        return; // already running
+    }
+
+    m_queue = std::make_shared<novac::BoundedQueue<Record>>(s_queueCapacity);
+    m_writerThread = std::thread(WriteRecords, std::ref(*m_queue));
+}
+
+void CSummaryFileWriter::Stop()
+{
+    std::shared_ptr<novac::BoundedQueue<Record>> queue;
+    {
+        std::lock_guard<std::mutex> lock(m_queueGuard);
+        queue = m_queue;
+        m_queue.reset();
+    }
+    if (queue == nullptr)
+    {
+        return; // not running
+    }
+
+    // the writing thread finishes once all remaining records have been written
+    queue->Close();
+    m_writerThread.join();
+}
+
+bool CSummaryFileWriter::Append(const std::string& fileName, const std::string& header, const std::string& text)
+{
+    Record record;
+    record.fileName = fileName;
+    record.header = header;
+    record.text = text;
+
+    std::shared_ptr<novac::BoundedQueue<Record>> queue;
+    {
+        std::lock_guard<std::mutex> lock(m_queueGuard);
+        queue = m_queue;
+    }
+
+    if (queue != nullptr && queue->Push(record))
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_directWriteGuard);
+    return WriteRecordDirectly(record);
+}
+
+void CSummaryFileWriter::WriteRecords(novac::BoundedQueue<Record>& queue)
+{
+    std::map<std::string, OpenFile> openFiles;
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    std::vector<Record> records;
+    while (true)
+    {
+        // write everything out before waiting for more records
+        if (0 == queue.TryPopBatch(records, s_batchSize))
+        {
+            FlushAll(openFiles);
+            lastFlush = std::chrono::steady_clock::now();
+
+            if (0 == queue.PopBatch(records, s_batchSize))
+            {
+                break; // the queue has been closed and is empty
+            }
+        }
+
+        for (const Record& record : records)
+        {
+            if (!WriteRecord(record, openFiles))
+            {
+                novac::CString message;
+                message.Format("Failed to write to summary file %s", record.fileName.c_str());
+                ShowError(message);
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastFlush > s_flushInterval)
+        {
+            FlushAll(openFiles);
+            lastFlush = now;
+        }
+    }
+
+    CloseAll(openFiles);
+}
+
+bool CSummaryFileWriter::WriteRecord(const Record& record, std::map<std::string, OpenFile>& openFiles)
+{
+    auto pos = openFiles.find(record.fileName);
+    if (pos == openFiles.end())
+    {
+        if (openFiles.size() >= s_maxOpenFiles)
+        {
+            CloseAll(openFiles);
+        }
+
+        FILE* f = fopen(record.fileName.c_str(), "a");
+        if (f == nullptr)
+        {
+            return false;
+        }
+
+        // write the header if this is a new file
+        fseek(f, 0, SEEK_END);
+        if (ftell(f) == 0)
+        {
+            fwrite(record.header.data(), 1, record.header.size(), f);
+        }
+
+        OpenFile openFile;
+        openFile.file = f;
+        openFile.unflushedBytes = record.header.size();
+        pos = openFiles.insert(std::make_pair(record.fileName, openFile)).first;
+    }
+
+    OpenFile& openFile = pos->second;
+    const bool written = (record.text.size() == fwrite(record.text.data(), 1, record.text.size(), openFile.file));
+    openFile.unflushedBytes += record.text.size();
+
+    if (openFile.unflushedBytes >= s_flushSize)
+    {
+        fflush(openFile.file);
+        openFile.unflushedBytes = 0;
+    }
+    return written;
+}
+
+bool CSummaryFileWriter::WriteRecordDirectly(const Record& record)
+{
+    std::map<std::string, OpenFile> openFiles;
+    const bool written = WriteRecord(record, openFiles);
+    CloseAll(openFiles);
+    return written;
+}
+
+void CSummaryFileWriter::FlushAll(std::map<std::string, OpenFile>& openFiles)
+{
+    for (auto& pos : openFiles)
+    {
+        if (pos.second.unflushedBytes > 0)
+        {
+            fflush(pos.second.file);
+            pos.second.unflushedBytes = 0;
+        }
+    }
+}
+
+void CSummaryFileWriter::CloseAll(std::map<std::string, OpenFile>& openFiles)
+{
+    for (auto& pos : openFiles)
+    {
+        fclose(pos.second.file);
+    }
+    openFiles.clear();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <PPPLib/ThreadUtils.h>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace FileHandler
+{
+    /** <b>CSummaryFileWriter</b> appends lines to the summary files which are shared
+        by all the evaluation threads (e.g. the evaluation-summary and the pak-file summary).
+
+        While the writer is running, the lines are handed over through a bounded queue
+        to one single thread which does all the writing. This thread keeps the files open
+        and flushes them once enough data has been written, once some time has passed
+        or once there is nothing more to write. The lines from the different threads can
+        hence never be interleaved and the evaluation threads don't need to open and close
+        the files for each scan. While the writer is not running, the lines are written
+        directly to the files by the calling thread.
+        All the files which are shared by the evaluation threads should be appended to
+        through the global instance of this class (g_summaryFiles), and never opened directly. */
+    class CSummaryFileWriter
+    {
+    public:
+        CSummaryFileWriter();
+        ~CSummaryFileWriter();
+
+        /** Starts the writing thread. Start() and Stop() must not be called
+            while any other thread is appending lines. */
+        void Start();
+
+        /** Writes out all remaining lines, closes all files and stops the writing thread. */
+        void Stop();
+
+        /** Appends text to the given file.
+            @param fileName the full path of the file.
+            @param header the header line(s) which are written first if the file does not exist or is empty.
+            @param text the text to append, normally one or more complete lines.
+            @return false if the file could not be written to. While the writer is running the
+                text is only handed over to the writing thread here, files which that thread
+                cannot open are then reported through ShowError. */
+        bool Append(const std::string& fileName, const std::string& header, const std::string& text);
+
+    private:
+        struct Record
+        {
+            std::string fileName;
+            std::string header;
+            std::string text;
+        };
+
+        struct OpenFile
+        {
+            FILE* file = nullptr;
+            size_t unflushedBytes = 0;
+        };
+
+        /** The lines waiting to be written, null while the writer is not running. */
+        std::shared_ptr<novac::BoundedQueue<Record>> m_queue;
+        std::mutex m_queueGuard;
+
+        std::thread m_writerThread;
+
+        /** Serializes the direct writes done while the writer is not running */
+        std::mutex m_directWriteGuard;
+
+        /** The writing thread */
+        static void WriteRecords(novac::BoundedQueue<Record>& queue);
+
+        /** Writes the given record, opening the file if it isn't already open.
+            @return false if the file could not be opened or written to. */
+        static bool WriteRecord(const Record& record, std::map<std::string, OpenFile>& openFiles);
+
+        /** Writes the given record, opening and closing the file.
+            @return false if the file could not be opened or written to. */
+        static bool WriteRecordDirectly(const Record& record);
+
+        static void FlushAll(std::map<std::string, OpenFile>& openFiles);
+        static void CloseAll(std::map<std::string, OpenFile>& openFiles);
+    };
+}
@@ -0,0 +1,218 @@
+#include "TextFileWriter.h"
+#include "Common.h"
+#include <Poco/DeflatingStream.h>
+#include <Poco/InflatingStream.h>
+#include <Poco/Exception.h>
+#include <cstdarg>
+
+using namespace FileHandler;
+
+// The level of compression used, this is a compromise between speed and file size
+static const int s_compressionLevel = 6;
+
+// The suffix of the compressed files
+static const char* s_compressedFileSuffix = ".gz";
+
+CTextFileWriter::CTextFileWriter()
+    : m_formatBuffer(1024)
+{
+}
+
+CTextFileWriter::~CTextFileWriter()
+{
+    Close();
+}
+
+std::string CTextFileWriter::GetFileName(const std::string& fileName, bool compress)
+{
+    return compress ? (fileName + s_compressedFileSuffix) : fileName;
+}
+
+std::string CTextFileWriter::FindFile(const std::string& fileName)
+{
+    if (IsExistingFile(fileName))
+    {
+        return fileName;
+    }
+    const std::string compressedFileName = fileName + s_compressedFileSuffix;
+    if (IsExistingFile(compressedFileName))
+    {
+        return compressedFileName;
+    }
+    return std::string();
+}
+
+bool CTextFileWriter::Open(const std::string& fileName, bool compress)
+{
+    Close();
+    m_failed = false;
+
+    if (!compress)
+    {
+        m_file = fopen(fileName.c_str(), "w");
+        return (m_file != nullptr);
+    }
+
+    m_stream.reset(new std::ofstream(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc));
+    if (!m_stream->is_open())
+    {
+        m_stream.reset();
+        return false;
+    }
+    m_deflater.reset(new Poco::DeflatingOutputStream(*m_stream, Poco::DeflatingStreamBuf::STREAM_GZIP, s_compressionLevel));
+    return true;
+}
+
+void CTextFileWriter::Write(const char* text, size_t length)
+{
+    if (m_file != nullptr)
+    {
+        if (fwrite(text, 1, length, m_file) != length)
+        {
+            m_failed = true;
+        }
+    }
+    else if (m_deflater != nullptr)
+    {
+        try
+        {
+            m_deflater->write(text, (std::streamsize)length);
+            m_failed = m_failed || !m_deflater->good();
+        }
+        catch (Poco::Exception&)
+        {
+            m_failed = true;
+        }
+    }
+}
+
+void CTextFileWriter::Printf(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(m_formatBuffer.data(), m_formatBuffer.size(), format, args);
+    va_end(args);
+
+    if (length < 0)
+    {
+        m_failed = true;
+        return;
+    }
+    if ((size_t)length >= m_formatBuffer.size())
+    {
+        // the buffer was too small, make it large enough and format the text again
+        m_formatBuffer.resize((size_t)length + 1);
+        va_start(args, format);
+        length = vsnprintf(m_formatBuffer.data(), m_formatBuffer.size(), format, args);
+        va_end(args);
+    }
+
+    Write(m_formatBuffer.data(), (size_t)length);
+}
+
+bool CTextFileWriter::Close()
+{
+    if (m_file != nullptr)
+    {
+        m_failed = (0 != fclose(m_file)) || m_failed;
+        m_file = nullptr;
+    }
+    else if (m_deflater != nullptr)
+    {
+        try
+        {
+            m_deflater->close();
+        }
+        catch (Poco::Exception&)
+        {
+            m_failed = true;
+        }
+        m_deflater.reset();
+
+        m_stream->close();
+        m_failed = m_stream->fail() || m_failed;
+        m_stream.reset();
+    }
+    else
+    {
+        return false;
+    }
+
+    return !m_failed;
+}
+
+bool CTextFileWriter::IsCompressedFile(const char* fileName)
+{
+    FILE* f = fopen(fileName, "rb");
+    if (f == nullptr)
+    {
+        return false;
+    }
+    unsigned char magic[2] = { 0, 0 };
+    const size_t nRead = fread(magic, 1, 2, f);
+    fclose(f);
+
+    return (nRead == 2 && magic[0] == 0x1f && magic[1] == 0x8b);
+}
+
+bool CTextFileWriter::ReadTextFile(const char* fileName, std::vector<char>& contents)
+{
+    contents.clear();
+
+    if (IsCompressedFile(fileName))
+    {
+        std::ifstream file(fileName, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        try
+        {
+            Poco::InflatingInputStream inflater(file, Poco::InflatingStreamBuf::STREAM_GZIP);
+            const size_t blockSize = 65536;
+            size_t length = 0;
+            while (true)
+            {
+                contents.resize(length + blockSize);
+                inflater.read(contents.data() + length, (std::streamsize)blockSize);
+                const size_t read = (size_t)inflater.gcount();
+                length += read;
+                if (read < blockSize)
+                {
+                    break;
+                }
+            }
+            contents.resize(length);
+            return !inflater.bad();
+        }
+        catch (Poco::Exception&)
+        {
+            contents.clear();
+            return false;
+        }
+    }
+
+    FILE* f = fopen(fileName, "r");
+    if (f == nullptr)
+    {
+        return false;
+    }
+
+    // read the file in large blocks (in text mode, such that line endings are treated as by fgets)
+    const size_t blockSize = 65536;
+    size_t length = 0;
+    while (true)
+    {
+        contents.resize(length + blockSize);
+        const size_t read = fread(contents.data() + length, sizeof(char), blockSize, f);
+        length += read;
+        if (read < blockSize)
+        {
+            break;
+        }
+    }
+    contents.resize(length);
+
+    fclose(f);
+    return true;
+}
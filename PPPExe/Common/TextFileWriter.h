@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Poco
+{
+    class DeflatingOutputStream;
+}
+
+namespace FileHandler
+{
+    /** <b>CTextFileWriter</b> writes a text file, either as plain text or gzip-compressed.
+        The compressed files are written as one single gzip stream and can be read
+        back in using ReadTextFile() below (or any other gzip tool). */
+    class CTextFileWriter
+    {
+    public:
+        CTextFileWriter();
+        ~CTextFileWriter();
+
+        /** Creates the given file, overwriting any previous file with the same name.
+            @param compress if true then the contents are gzip-compressed.
+            @return false if the file could not be created. */
+        bool Open(const std::string& fileName, bool compress);
+
+        /** Writes the given text to the file */
+        void Write(const char* text, size_t length);
+
+        /** Writes formatted text to the file, using the same format as printf. */
+        void Printf(const char* format, ...);
+
+        /** Closes the file.
+            @return false if anything failed to be written. */
+        bool Close();
+
+        /** @return the name of the file to write, i.e. 'fileName' with the suffix
+            '.gz' appended if the file is compressed. */
+        static std::string GetFileName(const std::string& fileName, bool compress);
+
+        /** @return the name of the existing file with the given name, either
+            uncompressed or compressed (with '.gz' appended), or an empty string if neither exists. */
+        static std::string FindFile(const std::string& fileName);
+
+        /** @return true if the given file starts with the gzip magic number. */
+        static bool IsCompressedFile(const char* fileName);
+
+        /** Reads in the full contents of the given text file, decompressing it if
+            the file is gzip-compressed. The line endings of uncompressed files are
+            handled as by fgets.
+            @return false if the file could not be read. */
+        static bool ReadTextFile(const char* fileName, std::vector<char>& contents);
+
+    private:
+        /** The file, if this is not compressed */
+        FILE* m_file = nullptr;
+
+        /** The file and the compression stream, if this is compressed */
+        std::unique_ptr<std::ofstream> m_stream;
+        std::unique_ptr<Poco::DeflatingOutputStream> m_deflater;
+
+        /** Set if anything fails to be written */
+        bool m_failed = false;
+
+        /** The buffer used by Printf, kept to avoid allocating it for each call */
+        std::vector<char> m_formatBuffer;
+    };
+}
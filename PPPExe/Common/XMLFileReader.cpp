@@ -40,6 +40,7 @@ void CXMLFileReader::Close()
     if (nullptr != m_File)
     {
         m_File->Close();
+        delete m_File;
         m_File = nullptr;
     }
 
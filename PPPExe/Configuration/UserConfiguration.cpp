@@ -14,6 +14,14 @@ namespace Configuration
     void CUserConfiguration::Clear()
     {
         m_maxThreadNum = 2;
+        m_pipelinedProcessing = false;
+        m_threadsPerScan = 1;
+        m_keepScanResultsInMemory = false;
+        m_writeBinaryEvaluationLogs = false;
+        m_restoreEvaluationLogs = false;
+        m_evaluationLogCacheSize = 128;
+        m_dropLogMessagesWhenBusy = false;
+        m_compressLogs = false;
 
         m_fIsContinuation = false;
 
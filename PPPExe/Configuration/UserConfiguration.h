@@ -38,6 +38,60 @@ namespace Configuration {
         unsigned long    m_maxThreadNum;
 #define str_maxThreadNum "MaxThreadNum"
 
+        /** Set to true to run the flux processing as a pipeline, where the geometry,
+            dual-beam and flux calculations for a scan are started as soon as every scan
+            it can be combined with has been evaluated, instead of waiting for all
+            evaluations to finish. */
+        bool m_pipelinedProcessing = false;
+#define str_pipelinedProcessing "PipelinedProcessing"
+
+        /** The largest number of threads used to evaluate the spectra of one scan.
+            The additional threads are only used once some of the m_maxThreadNum scan evaluation
+            threads have no more scans to evaluate, the total number of threads is never more than m_maxThreadNum. */
+        unsigned long m_threadsPerScan = 1;
+#define str_threadsPerScan "ThreadsPerScan"
+
+        /** Set to true to keep the result of the evaluation of each scan in memory,
+            such that the geometry and flux calculations don't need to read the evaluation
+            logs again. This requires memory for the full result of every scan. */
+        bool m_keepScanResultsInMemory = false;
+#define str_keepScanResultsInMemory "KeepScanResultsInMemory"
+
+        /** Set to true to write a binary copy of each evaluation log next to the log
+            (with the extension '.bin' appended), which is read in instead of the text
+            evaluation log by the later stages of the processing. */
+        bool m_writeBinaryEvaluationLogs = false;
+#define str_writeBinaryEvaluationLogs "WriteBinaryEvaluationLogs"
+
+        /** Set to true to, instead of processing any data, regenerate the evaluation logs
+            in the output directory from their binary copies, for every binary copy whose
+            evaluation log is missing. This is only given on the command line. */
+        bool m_restoreEvaluationLogs = false;
+#define str_restoreEvaluationLogs "RestoreEvaluationLogs"
+
+        /** The maximum amount of memory, in MB, used to keep the contents of the most recently
+            read evaluation logs in memory, such that a log which is needed by several stages
+            of the processing only needs to be parsed once. Set to zero to disable. */
+        unsigned long m_evaluationLogCacheSize = 128;
+#define str_evaluationLogCacheSize "EvaluationLogCacheSize"
+
+        /** The messages to the log are written by a background thread. Set this to true
+            to drop messages when the background thread cannot keep up with the processing,
+            otherwise the processing waits for the messages to be written. */
+        bool m_dropLogMessagesWhenBusy = false;
+#define str_dropLogMessagesWhenBusy "DropLogMessagesWhenBusy"
+
+        /** Set to true to gzip-compress the evaluation logs of the scans while they are written.
+            Only these are compressed, and they do not keep their names: the suffix '.gz' is appended
+            (e.g. '..._flux.txt.gz'). Writing the log of a scan removes its log written with the other
+            setting. The logs are decompressed automatically when read back in, so compressed and
+            uncompressed logs can be mixed in one output directory.
+            All other files are always written uncompressed. These include FluxLog.txt (which is
+            uploaded to the FTP-server), the binary copies of the evaluation logs, the evaluation
+            log index and the geometry and dual-beam logs. */
+        bool m_compressLogs = false;
+#define str_compressLogs "CompressLogs"
+
 
         /** The working-directory, used to override the location of the software.
                 This can only be overriden in command line arguments, not the config file. */
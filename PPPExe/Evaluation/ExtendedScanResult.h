@@ -1,8 +1,10 @@
 #pragma once
 
 #include "../Common/Common.h"
+#include "ScanResult.h"
 #include <PPPLib/CString.h>
 #include <SpectralEvaluation/Flux/PlumeInScanProperty.h>
+#include <memory>
 
 #ifndef EXTENDEDSCANRESULT_H
 #define EXTENDEDSCANRESULT_H
@@ -18,8 +20,9 @@ namespace Evaluation
             in these different wavelength regions can then be compared for other purposes
             such as studying the radiative transfer...
 
-        To save memory does	this not contain the column datas, only the names of the .txt files
-            where they can be found.
+        To save memory does	this normally not contain the column datas, only the names of the .txt files
+            where they can be found. If the user has chosen to keep the scan results in memory,
+            then the result in the main fit-window is kept in m_scanResult.
 
         To reduce the number of times we need to read data from the evaluation-log files
             this also contains the calculated properties of the plume in the scan, such as the
@@ -47,6 +50,12 @@ namespace Evaluation
         /** The properties of this scan. This is only evaluated in the main-fit window */
         CPlumeInScanProperty m_scanProperties;
 
+        /** The result of the evaluation in the main fit-window, as written to
+            m_evalLogFile[g_userSettings.m_mainFitWindow]. This is nullptr unless
+            g_userSettings.m_keepScanResultsInMemory is set, then the result has to be
+            read from the evaluation log file. The result is shared between all copies. */
+        std::shared_ptr<const CScanResult> m_scanResult;
+
     };
 }
 
@@ -0,0 +1,123 @@
+#include "PlumeSpectrumArchiver.h"
+#include <SpectralEvaluation/Evaluation/PlumeSpectrumSelector.h>
+#include "../Common/Common.h"
+#include <algorithm>
+
+// Global variables;
+Evaluation::CPlumeSpectrumArchiver g_plumeSpectrumArchiver; // <-- Writes the plume spectra in the background
+
+using namespace Evaluation;
+
+// The maximum number of scans waiting to be archived for each archiving thread.
+//  This limits the number of scans kept in memory when the archiving can't keep up.
+static const size_t s_queueLengthPerThread = 4;
+
+CPlumeSpectrumArchiver::~CPlumeSpectrumArchiver()
+{
+    Stop();
+}
+
+void CPlumeSpectrumArchiver::Start(size_t nThreads)
+{
+    std::lock_guard<std::mutex> lock(m_queueGuard);
+    if (m_queue != nullptr)
+    {
+        return; // already running
+    }
+
+    nThreads = std::max(nThreads, (size_t)1);
+    m_queue = std::make_shared<novac::BoundedQueue<Job>>(nThreads * s_queueLengthPerThread);
+    for (size_t k = 0; k < nThreads; ++k)
+    {
+        m_threads.push_back(std::thread(&CPlumeSpectrumArchiver::RunArchiving, this, std::ref(*m_queue)));
+    }
+}
+
+void CPlumeSpectrumArchiver::Stop()
+{
+    std::shared_ptr<novac::BoundedQueue<Job>> queue;
+    {
+        std::lock_guard<std::mutex> lock(m_queueGuard);
+        queue = m_queue;
+        m_queue.reset();
+    }
+    if (queue == nullptr)
+    {
+        return; // not running
+    }
+
+    // the threads finish once all remaining scans have been archived
+    queue->Close();
+    for (std::thread& t : m_threads)
+    {
+        t.join();
+    }
+    m_threads.clear();
+}
+
+void CPlumeSpectrumArchiver::Archive(std::shared_ptr<FileHandler::CScanFileHandler> scan, std::vector<Request> requests)
+{
+    if (requests.size() == 0)
+    {
+        return;
+    }
+
+    Job job;
+    job.scan = scan;
+    job.requests = std::move(requests);
+
+    std::shared_ptr<novac::BoundedQueue<Job>> queue;
+    {
+        std::lock_guard<std::mutex> lock(m_queueGuard);
+        queue = m_queue;
+    }
+
+    if (queue == nullptr || !queue->Push(job))
+    {
+        ArchiveScan(job);
+    }
+}
+
+void CPlumeSpectrumArchiver::RunArchiving(novac::BoundedQueue<Job>& queue)
+{
+    Job job;
+    while (queue.Pop(job))
+    {
+        ArchiveScan(job);
+
+        // release the scan as soon as possible
+        job = Job();
+    }
+}
+
+void CPlumeSpectrumArchiver::ArchiveScan(Job& job)
+{
+    for (Request& request : job.requests)
+    {
+        if (CreateOutputDirectory(request.outputDirectory))
+        {
+            PlumeSpectrumSelector spectrumSelector;
+            spectrumSelector.CreatePlumeSpectrumFile(*job.scan, request.result, request.properties, request.specieIndex, request.outputDirectory);
+        }
+    }
+}
+
+bool CPlumeSpectrumArchiver::CreateOutputDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(m_directoryGuard);
+    if (m_createdDirectories.find(directory) != m_createdDirectories.end())
+    {
+        return true;
+    }
+
+    if (CreateDirectoryStructure(directory))
+    {
+        novac::CString userMessage;
+        userMessage.Format("Could not create directory for archiving plume spectra: %s", directory.c_str());
+        ShowMessage(userMessage);
+        return false;
+    }
+
+    m_createdDirectories.insert(directory);
+    return true;
+}
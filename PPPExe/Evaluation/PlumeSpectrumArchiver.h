@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ScanResult.h"
+#include <SpectralEvaluation/File/ScanFileHandler.h>
+#include <PPPLib/ThreadUtils.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Evaluation
+{
+    /** <b>CPlumeSpectrumArchiver</b> writes the plume spectra of the evaluated scans
+        (see PlumeSpectrumSelector) to the output directory in the background, such that
+        the evaluation threads don't have to wait for the directories and files to be created.
+
+        The evaluation threads hand over the scan together with the results of its
+        evaluation through a bounded queue to a small, fixed, number of archiving threads.
+        Each output directory is only created once. While the archiver is not running,
+        the spectra are written directly by the calling thread. */
+    class CPlumeSpectrumArchiver
+    {
+    public:
+        /** The plume spectra to create from the evaluation of one scan in one fit-window */
+        struct Request
+        {
+            CScanResult result;
+            CPlumeInScanProperty properties;
+            int specieIndex = 0;
+            std::string outputDirectory;
+        };
+
+        ~CPlumeSpectrumArchiver();
+
+        /** Starts the archiving threads. Start() and Stop() must not be called
+            while any other thread is handing over scans.
+            @param nThreads the number of files which may be written at the same time. */
+        void Start(size_t nThreads);
+
+        /** Writes all remaining plume spectra and stops the archiving threads. */
+        void Stop();
+
+        /** Creates the plume spectra of the given scan. The requests are handled
+            one at a time, in order, since they all read from the same scan. */
+        void Archive(std::shared_ptr<FileHandler::CScanFileHandler> scan, std::vector<Request> requests);
+
+    private:
+        struct Job
+        {
+            std::shared_ptr<FileHandler::CScanFileHandler> scan;
+            std::vector<Request> requests;
+        };
+
+        /** The scans waiting to be archived, null while the archiver is not running. */
+        std::shared_ptr<novac::BoundedQueue<Job>> m_queue;
+        std::mutex m_queueGuard;
+
+        std::vector<std::thread> m_threads;
+
+        /** The output directories which have already been created */
+        std::set<std::string> m_createdDirectories;
+        std::mutex m_directoryGuard;
+
+        /** The archiving thread */
+        void RunArchiving(novac::BoundedQueue<Job>& queue);
+
+        void ArchiveScan(Job& job);
+
+        /** Creates the given directory, unless it has already been created.
+            @return true if the directory exists. */
+        bool CreateOutputDirectory(const std::string& directory);
+    };
+}
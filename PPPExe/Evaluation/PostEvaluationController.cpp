@@ -1,9 +1,9 @@
+#include <cstdio>
 #include <cstring>
 #include "PostEvaluationController.h"
 #include "ScanEvaluation.h"
 #include <SpectralEvaluation/Configuration/DarkSettings.h>
 #include <SpectralEvaluation/Evaluation/RatioEvaluation.h>
-#include <SpectralEvaluation/Evaluation/PlumeSpectrumSelector.h>
 
 // This is the information we need to continue an old processing
 #include "../ContinuationOfProcessing.h"
@@ -13,6 +13,11 @@
 
 // ... support for handling the evaluation-log files...
 #include "../Common/EvaluationLogFileHandler.h"
+#include "../Common/BinaryEvaluationLog.h"
+#include "../Common/EvaluationLogIndex.h"
+#include "../Common/EvaluationLogWriter.h"
+#include "../Common/SummaryFileWriter.h"
+#include "../Common/TextFileWriter.h"
 
 // we want to make some statistics on the processing
 #include "../PostProcessingStatistics.h"
@@ -31,21 +36,25 @@ extern Configuration::CNovacPPPConfiguration    g_setup;    // <-- The settings
 extern Configuration::CUserConfiguration        g_userSettings;// <-- The settings of the user
 extern CPostProcessingStatistics                g_processingStats; // <-- The statistics of the processing itself
 extern CContinuationOfProcessing                g_continuation;  // <-- Information on what has already been done when continuing an old processing round
+extern FileHandler::CSummaryFileWriter          g_summaryFiles;  // <-- The summary files shared by the evaluation threads
+extern FileHandler::CPakFileCatalog             g_pakFileCatalog; // <-- The information about the .pak-files to evaluate
+extern Evaluation::CPlumeSpectrumArchiver       g_plumeSpectrumArchiver; // <-- Writes the plume spectra in the background
 
 int CPostEvaluationController::EvaluateScan(const novac::CString& pakFileName, const novac::CString &fitWindowName, novac::CString *txtFileName, CPlumeInScanProperty *plumeProperties)
 {
-    novac::CString errorMessage, message, serialNumber;
-    Meteorology::CWindField windField;
-    CDateTime startTime;
-    SpectrumIO::CSpectrumIO reader;
-    CSpectrum skySpectrum;
-    Configuration::CInstrumentLocation instrLocation;
-    CFitWindow fitWindow;
+    return EvaluateScan(pakFileName, &fitWindowName, 1, txtFileName, plumeProperties);
+}
+
+int CPostEvaluationController::EvaluateScan(const novac::CString& pakFileName, const novac::CString *fitWindowNames, int nFitWindows, novac::CString *txtFileNames, CPlumeInScanProperty *plumeProperties, std::shared_ptr<const CScanResult> *scanResults)
+{
+    novac::CString errorMessage;
     Configuration::CDarkSettings darkSettings;
 
     // The CScanFileHandler is a structure for reading the 
-    //  spectral information from the scan-file
-    CScanFileHandler scan;
+    //  spectral information from the scan-file. This is shared with the
+    //  plume spectrum archiver, which may still use it after the evaluation is done.
+    std::shared_ptr<CScanFileHandler> scanFile = std::make_shared<CScanFileHandler>();
+    CScanFileHandler& scan = *scanFile;
 
     /** ------------- The process to evaluate a scan --------------- */
 
@@ -61,21 +70,61 @@ int CPostEvaluationController::EvaluateScan(const novac::CString& pakFileName, c
 
     // ---------- Get the information we need about the instrument ----------
 
-    //  Find the serial number of the spectrometer
-    // reader.ReadSpectrum(pakFileName, 0, spec); // TODO: check for errors!!
-
-    //  Find the information in the configuration about this instrument
-    if (GetLocationAndFitWindow(&scan, fitWindowName, instrLocation, fitWindow))
+    // the settings for how to correct for dark
+    if (GetDarkCurrentSettings(&scan, darkSettings))
     {
-        errorMessage.Format("Could not read location and fit-window for pak-file %s. Will not evaulate.", (const char*)pakFileName);
+        errorMessage.Format("Could not read dark-settings for pak-file %s. Will not evaulate.", (const char*)pakFileName);
         ShowMessage(errorMessage);
         return 3;
     }
 
-    // the settings for how to correct for dark
-    if (GetDarkCurrentSettings(&scan, darkSettings))
+    // Check if we have already evaluated this scan and ignored it. Only if this is a re-run of
+    // an old processing...
+    if (g_userSettings.m_fIsContinuation && g_continuation.IsPreviouslyIgnored(pakFileName))
     {
-        errorMessage.Format("Could not read dark-settings for pak-file %s. Will not evaulate.", (const char*)pakFileName);
+        errorMessage.Format(" Scan %s has already been evaluated and was ignored. Will proceed to the next scan", (const char*)pakFileName);
+        ShowMessage(errorMessage);
+
+        return 0;
+    }
+
+    // Evaluate the scan in each of the fit-windows. The spectra are only read once
+    //  and are then shared between the evaluations in the different fit-windows.
+    CScanEvaluation ev;
+    int ret = 0;
+    m_plumeSpectraToArchive.clear();
+    for (int fitWindowIndex = 0; fitWindowIndex < nFitWindows; ++fitWindowIndex)
+    {
+        novac::CString* txtFileName = (txtFileNames == nullptr) ? nullptr : &txtFileNames[fitWindowIndex];
+        CPlumeInScanProperty* properties = (plumeProperties == nullptr) ? nullptr : &plumeProperties[fitWindowIndex];
+        std::shared_ptr<const CScanResult>* scanResult = (scanResults == nullptr) ? nullptr : &scanResults[fitWindowIndex];
+
+        ret = EvaluateScanInFitWindow(scan, ev, darkSettings, pakFileName, fitWindowNames[fitWindowIndex], txtFileName, properties, scanResult);
+        if (ret != 0)
+        {
+            break;
+        }
+    }
+
+    // Write the plume spectra of the scan, this is done in the background
+    g_plumeSpectrumArchiver.Archive(scanFile, std::move(m_plumeSpectraToArchive));
+    m_plumeSpectraToArchive.clear();
+
+    return ret;
+}
+
+int CPostEvaluationController::EvaluateScanInFitWindow(CScanFileHandler& scan, CScanEvaluation& ev, Configuration::CDarkSettings& darkSettings, const novac::CString& pakFileName, const novac::CString &fitWindowName, novac::CString *txtFileName, CPlumeInScanProperty *plumeProperties, std::shared_ptr<const CScanResult> *scanResult)
+{
+    novac::CString errorMessage, message, serialNumber;
+    Meteorology::CWindField windField;
+    CDateTime startTime;
+    Configuration::CInstrumentLocation instrLocation;
+    CFitWindow fitWindow;
+
+    //  Find the information in the configuration about this instrument
+    if (GetLocationAndFitWindow(&scan, fitWindowName, instrLocation, fitWindow))
+    {
+        errorMessage.Format("Could not read location and fit-window for pak-file %s. Will not evaulate.", (const char*)pakFileName);
         ShowMessage(errorMessage);
         return 3;
     }
@@ -84,32 +133,25 @@ int CPostEvaluationController::EvaluateScan(const novac::CString& pakFileName, c
     // an old processing...
     if (g_userSettings.m_fIsContinuation)
     {
-        if (g_continuation.IsPreviouslyIgnored(pakFileName))
-        {
-            errorMessage.Format(" Scan %s has already been evaluated and was ignored. Will proceed to the next scan", (const char*)pakFileName);
-            ShowMessage(errorMessage);
+        novac::CString archivePakFileName, archiveTxtFileName;
+        FileHandler::CPakFileCatalog::Entry pakFileInfo;
+        const bool pakFileInfoFound = GetPakFileInfo(pakFileName, pakFileInfo);
 
-            return 0;
-        }
-        else
+        // loop through all possible measurement modes and see if the evaluation log file already exists
+        MEASUREMENT_MODE modes[] = { MODE_FLUX, MODE_WINDSPEED, MODE_STRATOSPHERE, MODE_DIRECT_SUN,
+                                    MODE_COMPOSITION, MODE_LUNAR, MODE_TROPOSPHERE, MODE_MAXDOAS };
+        for (int k = 0; k < 8 && pakFileInfoFound; ++k)
         {
-            novac::CString archivePakFileName, archiveTxtFileName;
-
-            // loop through all possible measurement modes and see if the evaluation log file already exists
-            MEASUREMENT_MODE modes[] = { MODE_FLUX, MODE_WINDSPEED, MODE_STRATOSPHERE, MODE_DIRECT_SUN,
-                                        MODE_COMPOSITION, MODE_LUNAR, MODE_TROPOSPHERE, MODE_MAXDOAS };
-            for (int k = 0; k < 8; ++k)
+            GetArchivingfileName(archivePakFileName, archiveTxtFileName, fitWindowName, pakFileInfo, modes[k]);
+            const std::string existingTxtFileName = FileHandler::CTextFileWriter::FindFile(archiveTxtFileName.std_str());
+            if (existingTxtFileName.size() > 0)
             {
-                GetArchivingfileName(archivePakFileName, archiveTxtFileName, fitWindowName, pakFileName, modes[k]);
-                if (IsExistingFile(archiveTxtFileName))
-                {
-                    errorMessage.Format(" Scan %s has already been evaluated. Will proceed to the next scan", (const char*)pakFileName);
-                    ShowMessage(errorMessage);
+                errorMessage.Format(" Scan %s has already been evaluated. Will proceed to the next scan", (const char*)pakFileName);
+                ShowMessage(errorMessage);
 
-                    txtFileName->Format(archiveTxtFileName);
+                txtFileName->SetData(existingTxtFileName);
 
-                    return 0;
-                }
+                return 0;
             }
         }
     }
@@ -123,7 +165,6 @@ int CPostEvaluationController::EvaluateScan(const novac::CString& pakFileName, c
     }
 
     // 6. Evaluate the scan
-    CScanEvaluation ev;
     const long spectrumNum = ev.EvaluateScan(&scan, fitWindow, &darkSettings);
 
     // 7. Check the reasonability of the evaluation
@@ -177,28 +218,29 @@ int CPostEvaluationController::EvaluateScan(const novac::CString& pakFileName, c
         m_lastResult->GetCalculatedPlumeProperties(*plumeProperties);
     }
 
+    // 12b. The plume spectra are written once the scan has been evaluated in all fit-windows
     {
-        const std::string outputDirectoryStr = 
+        CPlumeSpectrumArchiver::Request plumeSpectra;
+        plumeSpectra.result = *m_lastResult;
+        m_lastResult->GetCalculatedPlumeProperties(plumeSpectra.properties);
+        plumeSpectra.specieIndex = specieIndex;
+        plumeSpectra.outputDirectory =
             std::string(g_userSettings.m_outputDirectory) +
-            "/" + std::string(fitWindowName) +  
-            "/PlumeSpectra/" + 
+            "/" + std::string(fitWindowName) +
+            "/PlumeSpectra/" +
             m_lastResult->GetSerial().std_str();
+        m_plumeSpectraToArchive.push_back(plumeSpectra);
+    }
 
-        int ret = CreateDirectoryStructure(outputDirectoryStr);
-        if (ret)
-        {
-            novac::CString userMessage;
-            userMessage.Format("Could not create directory for archiving plume spectra: %s", outputDirectoryStr.c_str());
-            ShowMessage(userMessage);
-        }
-        else
-        {
-            PlumeSpectrumSelector spectrumSelector;
-            spectrumSelector.CreatePlumeSpectrumFile(scan, *m_lastResult, *plumeProperties, specieIndex, outputDirectoryStr);
-        }
+    // 13. Hand over the result, with the same properties as it gets when read from the evaluation log.
+    if (scanResult != nullptr)
+    {
+        m_lastResult->SetInstrumentType(instrLocation.m_instrumentType);
+        scanResult->reset(m_lastResult);
+        m_lastResult = nullptr;
     }
 
-    // 13. Clean up
+    // 14. Clean up
     delete m_lastResult;
     m_lastResult = nullptr;
 
@@ -218,46 +260,36 @@ RETURN_CODE CPostEvaluationController::WriteRatioResult(const std::vector<Ratio>
         Poco::Path::separator(),
         skySpec.m_info.m_device.c_str());
 
-    const bool writeHeaderLine = !IsExistingFile(fileName);
-
-    FILE *f = fopen(fileName, "a");
-    if (f == nullptr)
-    {
-        return FAIL;
-    }
-
-    if (writeHeaderLine)
+    // The header line, written if this is a new file
+    novac::CString header;
+    header.Format("StartTime\t");
+    for (const Ratio& r : result)
     {
-        fprintf(f, "StartTime\t");
-        for (const Ratio& r : result)
-        {
-            fprintf(f, "Ratio\tError\t");
-            fprintf(f, "Column(%s)\tError(%s)\t", r.minorSpecieName.c_str(), r.minorSpecieName.c_str());
-            fprintf(f, "Column(%s)\tError(%s)\t", r.majorSpecieName.c_str(), r.majorSpecieName.c_str());
-        }
-        fprintf(f, "\n");
+        header.Append("Ratio\tError\t");
+        header.AppendFormat("Column(%s)\tError(%s)\t", r.minorSpecieName.c_str(), r.minorSpecieName.c_str());
+        header.AppendFormat("Column(%s)\tError(%s)\t", r.majorSpecieName.c_str(), r.majorSpecieName.c_str());
     }
+    header.Append("\n");
 
     // The start-time
-    fprintf(f, "%04d.%02d.%02dT%02d:%02d:%02d\t", scan.m_startTime.year, scan.m_startTime.month, scan.m_startTime.day, scan.m_startTime.hour, scan.m_startTime.minute, scan.m_startTime.second);
+    novac::CString line;
+    line.Format("%04d.%02d.%02dT%02d:%02d:%02d\t", scan.m_startTime.year, scan.m_startTime.month, scan.m_startTime.day, scan.m_startTime.hour, scan.m_startTime.minute, scan.m_startTime.second);
 
     // The major specie
     for (const Ratio& r : result)
     {
-        fprintf(f, "%.5e\t%.5e\t", r.ratio, r.error);
-        fprintf(f, "%.5e\t%.5e\t", r.minorResult, r.minorError);
-        fprintf(f, "%.5e\t%.5e\t", r.majorResult, r.majorError);
+        line.AppendFormat("%.5e\t%.5e\t", r.ratio, r.error);
+        line.AppendFormat("%.5e\t%.5e\t", r.minorResult, r.minorError);
+        line.AppendFormat("%.5e\t%.5e\t", r.majorResult, r.majorError);
     }
-    fprintf(f, "\n");
-
-    fclose(f);
+    line.Append("\n");
 
-    return SUCCESS;
+    return g_summaryFiles.Append(fileName.std_str(), header.std_str(), line.std_str()) ? SUCCESS : FAIL;
 }
 
 RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *result, const FileHandler::CScanFileHandler *scan, const Configuration::CInstrumentLocation *instrLocation, const Evaluation::CFitWindow *window, Meteorology::CWindField &windField, novac::CString *txtFileName)
 {
-    novac::CString string, string1, string2, string3, string4;
+    novac::CString string;
     long itSpectrum, itSpecie; // iterators
     novac::CString pakFile, txtFile, evalSummaryLog;
     novac::CString wsSrc, wdSrc, phSrc;
@@ -265,6 +297,8 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
 
     // get the file-name that we want to have 
     GetArchivingfileName(pakFile, txtFile, window->name, scan->GetFileName(), result->GetMeasurementMode());
+    const std::string otherTxtFile = FileHandler::CTextFileWriter::GetFileName(txtFile.std_str(), !g_userSettings.m_compressLogs);
+    txtFile.SetData(FileHandler::CTextFileWriter::GetFileName(txtFile.std_str(), g_userSettings.m_compressLogs));
     if (txtFileName != nullptr)
     {
         txtFileName->Format(txtFile);
@@ -334,11 +368,18 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
 
     string.Append("</scaninformation>\n");
     // 0a. Write the additional scan-information to the evaluation log
-    FILE *f = fopen(txtFile, "w");
-    if (f != nullptr)
+    //  (and, if the user wants it, also to the binary copy of the evaluation log).
+    //  The whole log is built up in memory and written to disk in one go at the end.
+    const bool writeBinaryLog = g_userSettings.m_writeBinaryEvaluationLogs;
+    FileHandler::CBinaryEvaluationLog binaryLog;
+    FileHandler::CEvaluationLogWriter& evaluationLog = FileHandler::CEvaluationLogWriter::ForCurrentThread();
+    evaluationLog.Clear();
+    evaluationLog.Append(string.c_str());
+    evaluationLog.Append("\n");
+    if (writeBinaryLog)
     {
-        fprintf(f, "%s", string.c_str());
-        fprintf(f, "\n");
+        binaryLog.AppendText(string.c_str());
+        binaryLog.AppendText("\n");
     }
 
     // 0.1 Create an flux-information part and write it to the same file
@@ -376,10 +417,12 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
     string.Append("</fluxinfo>");
 
     // 0.1b Write the flux-information to the evaluation-log
-    if (f != nullptr)
+    evaluationLog.Append(string.c_str());
+    evaluationLog.Append("\n");
+    if (writeBinaryLog)
     {
-        fprintf(f, "%s", string.c_str());
-        fprintf(f, "\n");
+        binaryLog.AppendText(string.c_str());
+        binaryLog.AppendText("\n");
     }
 
 
@@ -403,17 +446,18 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
     string.Append("isgoodpoint\toffset\tflag");
 
     // 1a. Write the header to the log file
-    if (f != nullptr)
+    evaluationLog.Append(string.c_str());
+    evaluationLog.Append("\n<spectraldata>\n");
+    if (writeBinaryLog)
     {
-        fprintf(f, "%s", string.c_str());
-        fprintf(f, "\n<spectraldata>\n");
+        binaryLog.AppendText(string.c_str());
+        binaryLog.AppendText("\n<spectraldata>\n");
     }
 
     // ----------------------------------------------------------------------------------------------
     // 2. ----------------- Write the parameters for the sky and the dark-spectra -------------------
     // ----------------------------------------------------------------------------------------------
     CSpectrum sky, dark, darkCurrent, offset;
-    string1.Format(""); string2.Format(""); string3.Format(""); string4.Format("");
     scan->GetSky(sky);
     if (sky.m_info.m_interlaceStep > 1)
         sky.InterpolateSpectrum();
@@ -422,7 +466,8 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
         sky.m_info.m_fitIntensity = (float)(sky.MaxValue(window->fitLow, window->fitHigh));
         if (sky.NumSpectra() > 0)
             sky.Div(sky.NumSpectra());
-        CEvaluationLogFileHandler::FormatEvaluationResult(&sky.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity*sky.NumSpectra(), window->nRef, string1);
+        if (SUCCESS == evaluationLog.AppendEvaluationResult(&sky.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity*sky.NumSpectra(), window->nRef) && writeBinaryLog)
+            binaryLog.AppendSpectrumLine(evaluationLog.LastLine().c_str());
     }
     scan->GetDark(dark);
     if (dark.m_info.m_interlaceStep > 1)
@@ -432,7 +477,8 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
         dark.m_info.m_fitIntensity = (float)(dark.MaxValue(window->fitLow, window->fitHigh));
         if (dark.NumSpectra() > 0)
             dark.Div(dark.NumSpectra());
-        CEvaluationLogFileHandler::FormatEvaluationResult(&dark.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity*dark.NumSpectra(), window->nRef, string2);
+        if (SUCCESS == evaluationLog.AppendEvaluationResult(&dark.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity*dark.NumSpectra(), window->nRef) && writeBinaryLog)
+            binaryLog.AppendSpectrumLine(evaluationLog.LastLine().c_str());
     }
     scan->GetOffset(offset);
     if (offset.m_info.m_interlaceStep > 1)
@@ -441,7 +487,8 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
     {
         offset.m_info.m_fitIntensity = (float)(offset.MaxValue(window->fitLow, window->fitHigh));
         offset.Div(offset.NumSpectra());
-        CEvaluationLogFileHandler::FormatEvaluationResult(&offset.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity * offset.NumSpectra(), window->nRef, string3);
+        if (SUCCESS == evaluationLog.AppendEvaluationResult(&offset.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity * offset.NumSpectra(), window->nRef) && writeBinaryLog)
+            binaryLog.AppendSpectrumLine(evaluationLog.LastLine().c_str());
     }
     scan->GetDarkCurrent(darkCurrent);
     if (darkCurrent.m_info.m_interlaceStep > 1)
@@ -450,31 +497,10 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
     {
         darkCurrent.m_info.m_fitIntensity = (float)(darkCurrent.MaxValue(window->fitLow, window->fitHigh));
         darkCurrent.Div(darkCurrent.NumSpectra());
-        CEvaluationLogFileHandler::FormatEvaluationResult(&darkCurrent.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity*darkCurrent.NumSpectra(), window->nRef, string4);
-    }
-
-    // 2b. Write it all to the evaluation log file
-    if (f != nullptr)
-    {
-        if (strlen(string1) > 0)
-        {
-            fprintf(f, "%s", string1.c_str()); fprintf(f, "\n");
-        }
-        if (strlen(string2) > 0)
-        {
-            fprintf(f, "%s", string2.c_str()); fprintf(f, "\n");
-        }
-        if (strlen(string3) > 0)
-        {
-            fprintf(f, "%s", string3.c_str()); fprintf(f, "\n");
-        }
-        if (strlen(string4) > 0)
-        {
-            fprintf(f, "%s", string4.c_str()); fprintf(f, "\n");
-        }
+        if (SUCCESS == evaluationLog.AppendEvaluationResult(&darkCurrent.m_info, nullptr, instrLocation->m_instrumentType, spectrometerModel.maximumIntensity*darkCurrent.NumSpectra(), window->nRef) && writeBinaryLog)
+            binaryLog.AppendSpectrumLine(evaluationLog.LastLine().c_str());
     }
 
-
     // ----------------------------------------------------------------------------------------------
     // 3. ------------------- Then write the parameters for each spectrum ---------------------------
     // ----------------------------------------------------------------------------------------------
@@ -482,21 +508,36 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
     {
         int nSpectra = result->GetSpectrumInfo(itSpectrum).m_numSpec;
 
-        // 3a. Pretty print the result and the spectral info into a string
-        CEvaluationLogFileHandler::FormatEvaluationResult(&result->GetSpectrumInfo(itSpectrum), result->GetResult(itSpectrum), instrLocation->m_instrumentType, spectrometerModel.maximumIntensity * nSpectra, window->nRef, string);
-
-        // 3b. Write it all to the evaluation log file
-        if (f != nullptr)
+        // 3a. Pretty print the result and the spectral info into the evaluation log
+        if (SUCCESS == evaluationLog.AppendEvaluationResult(&result->GetSpectrumInfo(itSpectrum), result->GetResult(itSpectrum), instrLocation->m_instrumentType, spectrometerModel.maximumIntensity * nSpectra, window->nRef) && writeBinaryLog)
         {
-            fprintf(f, "%s", string.c_str());
-            fprintf(f, "\n");
+            binaryLog.AppendSpectrumLine(evaluationLog.LastLine().c_str());
         }
     }
 
-    if (f != nullptr)
+    evaluationLog.Append("</spectraldata>\n");
+    if (SUCCESS == evaluationLog.WriteToFile(txtFile, g_userSettings.m_compressLogs))
     {
-        fprintf(f, "</spectraldata>\n");
-        fclose(f);
+        // remove any log of this scan written with the other compression setting, such that the scan is only found once
+        remove(otherTxtFile.c_str());
+
+        // 4. Write the binary copy of the evaluation log. This is done after the text log
+        //  has been closed, such that the binary log is never older than the text log.
+        if (writeBinaryLog)
+        {
+            binaryLog.AppendText("</spectraldata>\n");
+            binaryLog.WriteToFile(FileHandler::CBinaryEvaluationLog::GetFileName(txtFile));
+        }
+
+        // 5. Add the log to the index of its directory, such that it can be found without being read again.
+        //  The log is indexed from its contents, still in memory, (and not from 'result', which has more decimals
+        //  than the log) such that the entry is the same as if the log had been indexed in a later processing.
+        FileHandler::CEvaluationLogFileHandler logReader;
+        logReader.m_evaluationLog = txtFile;
+        if (SUCCESS == logReader.ParseEvaluationLog(evaluationLog.Contents()) && logReader.m_scan.size() > 0)
+        {
+            FileHandler::CEvaluationLogIndex::AddEvaluationLog(txtFile.std_str(), window->name, logReader.m_scan[0]);
+        }
     }
 
     return SUCCESS;
@@ -505,7 +546,7 @@ RETURN_CODE CPostEvaluationController::WriteEvaluationResult(const CScanResult *
 RETURN_CODE CPostEvaluationController::AppendToEvaluationSummaryFile(const CScanResult *result, const FileHandler::CScanFileHandler *scan, const Configuration::CInstrumentLocation* /*instrLocation*/, const Evaluation::CFitWindow *window, Meteorology::CWindField& /*windField*/)
 {
     novac::CString evalSummaryLog;
-    bool fWriteHeaderLine = false;
+    novac::CString line;
 
     // we can also write an evaluation-summary log file
     evalSummaryLog.Format("%s%c%s%cEvaluationSummary_%s.txt",
@@ -515,108 +556,80 @@ RETURN_CODE CPostEvaluationController::AppendToEvaluationSummaryFile(const CScan
         Poco::Path::separator(),
         (const char*)result->GetSerial());
 
-    if (!IsExistingFile(evalSummaryLog))
-    {
-        fWriteHeaderLine = true;
-    }
-
-    FILE *f = fopen(evalSummaryLog, "a");
-    if (f == nullptr)
-        return FAIL;
-
-    if (fWriteHeaderLine)
-    {
-        fprintf(f, "StartTime\tExpTime\tAppliedShift\tTemperature\tCalculatedOffset\tCalculatedPlumeCentre\tCalculatedPlumeCompleteness\t#Spectra\n");
-    }
-
     // the start-time
-    fprintf(f, "%04d.%02d.%02dT%02d:%02d:%02d\t", scan->m_startTime.year, scan->m_startTime.month, scan->m_startTime.day, scan->m_startTime.hour, scan->m_startTime.minute, scan->m_startTime.second);
+    line.Format("%04d.%02d.%02dT%02d:%02d:%02d\t", scan->m_startTime.year, scan->m_startTime.month, scan->m_startTime.day, scan->m_startTime.hour, scan->m_startTime.minute, scan->m_startTime.second);
 
     // The exposure time
-    fprintf(f, "%ld\t", result->GetSkySpectrumInfo().m_exposureTime);
+    line.AppendFormat("%ld\t", result->GetSkySpectrumInfo().m_exposureTime);
 
     // the shift applied
-    fprintf(f, "%.2lf\t", result->GetResult(0)->m_referenceResult[0].m_shift);
+    line.AppendFormat("%.2lf\t", result->GetResult(0)->m_referenceResult[0].m_shift);
 
     // the temperature of the spectrometer
-    fprintf(f, "%.2lf\t", result->GetTemperature());
+    line.AppendFormat("%.2lf\t", result->GetTemperature());
 
     // the calculated plume parameters
-    fprintf(f, "%.2lf\t", result->GetOffset());
-    fprintf(f, "%.2lf\t", result->GetCalculatedPlumeCentre());
-    fprintf(f, "%.2lf\t", result->GetCalculatedPlumeCompleteness());
+    line.AppendFormat("%.2lf\t", result->GetOffset());
+    line.AppendFormat("%.2lf\t", result->GetCalculatedPlumeCentre());
+    line.AppendFormat("%.2lf\t", result->GetCalculatedPlumeCompleteness());
 
     // the number of evaluated spectra
-    fprintf(f, "%ld\t", result->GetEvaluatedNum());
+    line.AppendFormat("%ld\t", result->GetEvaluatedNum());
 
     // make a new line
-    fprintf(f, "\n");
+    line.Append("\n");
 
-    // close the file
-    fclose(f);
+    const bool written = g_summaryFiles.Append(
+        evalSummaryLog.std_str(),
+        "StartTime\tExpTime\tAppliedShift\tTemperature\tCalculatedOffset\tCalculatedPlumeCentre\tCalculatedPlumeCompleteness\t#Spectra\n",
+        line.std_str());
 
-    return SUCCESS;
+    return written ? SUCCESS : FAIL;
 }
 
 RETURN_CODE CPostEvaluationController::AppendToPakFileSummaryFile(const CScanResult *result, const FileHandler::CScanFileHandler *scan, const Configuration::CInstrumentLocation* /*instrLocation*/, const Evaluation::CFitWindow* /*window*/, Meteorology::CWindField& /*windField*/)
 {
     novac::CString pakSummaryLog;
-    bool fWriteHeaderLine = false;
+    novac::CString line;
 
     // we can also write an evaluation-summary log file
     pakSummaryLog.Format("%s%cPakfileSummary.txt", (const char*)g_userSettings.m_outputDirectory, Poco::Path::separator());
 
-    if (!IsExistingFile(pakSummaryLog))
-    {
-        fWriteHeaderLine = true;
-    }
-
-    FILE *f = fopen(pakSummaryLog, "a");
-    if (f == nullptr)
-        return FAIL;
-
-    if (fWriteHeaderLine)
-    {
-        fprintf(f, "Serial\tStartTime\tLat\tLong\tAlt\tExpTime\tBatteryVoltage\tTemperature\tElectronicOffset\n");
-    }
-
     // the serial of the instrument
-    fprintf(f, "%s\t", (const char*)result->GetSerial());
+    line.Format("%s\t", (const char*)result->GetSerial());
 
     // the start-time
-    fprintf(f, "%04d.%02d.%02dT%02d:%02d:%02d\t", scan->m_startTime.year, scan->m_startTime.month, scan->m_startTime.day, scan->m_startTime.hour, scan->m_startTime.minute, scan->m_startTime.second);
+    line.AppendFormat("%04d.%02d.%02dT%02d:%02d:%02d\t", scan->m_startTime.year, scan->m_startTime.month, scan->m_startTime.day, scan->m_startTime.hour, scan->m_startTime.minute, scan->m_startTime.second);
 
     // the location
     const CGPSData &gps = scan->GetGPS();
-    fprintf(f, "%.5lf\t%.5lf\t%.5lf\t", gps.m_latitude, gps.m_longitude, gps.m_altitude);
+    line.AppendFormat("%.5lf\t%.5lf\t%.5lf\t", gps.m_latitude, gps.m_longitude, gps.m_altitude);
 
     // The exposure time
-    fprintf(f, "%ld\t", result->GetSkySpectrumInfo().m_exposureTime);
+    line.AppendFormat("%ld\t", result->GetSkySpectrumInfo().m_exposureTime);
 
     // the input-voltage at the time of measurement
-    fprintf(f, "%.2lf\t", result->GetBatteryVoltage());
+    line.AppendFormat("%.2lf\t", result->GetBatteryVoltage());
 
     // the temperature of the spectrometer
-    fprintf(f, "%.2lf\t", result->GetTemperature());
+    line.AppendFormat("%.2lf\t", result->GetTemperature());
 
     // the offset of the AD converter
-    fprintf(f, "%.2lf", result->GetElectronicOffset(0));
+    line.AppendFormat("%.2lf", result->GetElectronicOffset(0));
 
     // make a new line
-    fprintf(f, "\n");
+    line.Append("\n");
 
-    // close the file
-    fclose(f);
+    const bool written = g_summaryFiles.Append(
+        pakSummaryLog.std_str(),
+        "Serial\tStartTime\tLat\tLong\tAlt\tExpTime\tBatteryVoltage\tTemperature\tElectronicOffset\n",
+        line.std_str());
 
-    return SUCCESS;
+    return written ? SUCCESS : FAIL;
 }
 
 RETURN_CODE CPostEvaluationController::GetArchivingfileName(novac::CString &pakFile, novac::CString &txtFile, const novac::CString &fitWindowName, const novac::CString &temporaryScanFile, MEASUREMENT_MODE mode)
 {
-    CSpectrumIO reader;
-    CSpectrum tmpSpec;
-    novac::CString serialNumber, dateStr, timeStr, dateStr2, modeStr, userMessage;
-
     // 0. Make an initial assumption of the file-names
     int i = 0;
     while (1)
@@ -629,34 +642,41 @@ RETURN_CODE CPostEvaluationController::GetArchivingfileName(novac::CString &pakF
     }
     txtFile.Format("%s%cUnknownScans%c%d.txt", (const char*)g_userSettings.m_outputDirectory, Poco::Path::separator(), Poco::Path::separator(), i);
 
-    // 1. Read the first spectrum in the scan
-    const std::string temporaryScanFileStr((const char*)temporaryScanFile);
-    if (SUCCESS != reader.ReadSpectrum(temporaryScanFileStr, 0, tmpSpec))
+    // 1. Get the serial, channel and start time of the scan
+    FileHandler::CPakFileCatalog::Entry pakFileInfo;
+    if (!GetPakFileInfo(temporaryScanFile, pakFileInfo))
     {
         return FAIL;
     }
-    CSpectrumInfo &info = tmpSpec.m_info;
-    int channel = info.m_channel;
 
-    // 1a. If the GPS had no connection with the satelites when collecting the sky-spectrum,
-    //   then try to find a spectrum in the file for which it had connection...
-    i = 1;
-    while (info.m_startTime.year == 2004 && info.m_startTime.month == 3 && info.m_startTime.second == 22)
+    return GetArchivingfileName(pakFile, txtFile, fitWindowName, pakFileInfo, mode);
+}
+
+bool CPostEvaluationController::GetPakFileInfo(const novac::CString &scanFile, FileHandler::CPakFileCatalog::Entry &pakFileInfo)
+{
+    const std::string scanFileStr((const char*)scanFile);
+    if (g_pakFileCatalog.Find(scanFileStr, pakFileInfo))
     {
-        if (SUCCESS != reader.ReadSpectrum(temporaryScanFileStr, i++, tmpSpec))
-        {
-            break;
-        }
-        info = tmpSpec.m_info;
+        return true;
     }
 
+    // not in the catalog, read the information from the spectra in the file
+    return FileHandler::CPakFileCatalog::ReadEntry(scanFileStr, pakFileInfo);
+}
+
+RETURN_CODE CPostEvaluationController::GetArchivingfileName(novac::CString &pakFile, novac::CString &txtFile, const novac::CString &fitWindowName, const FileHandler::CPakFileCatalog::Entry &pakFileInfo, MEASUREMENT_MODE mode)
+{
+    novac::CString serialNumber, dateStr, timeStr, dateStr2, modeStr, userMessage;
+    int channel = pakFileInfo.channel;
+    const CDateTime& startTime = pakFileInfo.startTime;
+
     // 2. Get the serialNumber of the spectrometer
-    serialNumber.Format("%s", info.m_device.c_str());
+    serialNumber.Format("%s", pakFileInfo.serial.c_str());
 
     // 3. Get the time and date when the scan started
-    dateStr.Format("%02d%02d%02d", info.m_startTime.year % 1000, info.m_startTime.month, info.m_startTime.day);
-    dateStr2.Format("%04d.%02d.%02d", info.m_startTime.year, info.m_startTime.month, info.m_startTime.day);
-    timeStr.Format("%02d%02d", info.m_startTime.hour, info.m_startTime.minute);
+    dateStr.Format("%02d%02d%02d", startTime.year % 1000, startTime.month, startTime.day);
+    dateStr2.Format("%04d.%02d.%02d", startTime.year, startTime.month, startTime.day);
+    timeStr.Format("%02d%02d", startTime.hour, startTime.minute);
 
 
     // 4. Write the archiving name of the spectrum file
@@ -1,13 +1,19 @@
 #pragma once
 
 #include "ScanResult.h"
+#include "PlumeSpectrumArchiver.h"
+#include <memory>
+#include <vector>
 
 #include <SpectralEvaluation/File/ScanFileHandler.h>
 #include <SpectralEvaluation/Evaluation/Ratio.h>
 #include "../Configuration/NovacPPPConfiguration.h"
+#include "../Common/PakFileCatalog.h"
 
 namespace Evaluation
 {
+    class CScanEvaluation;
+
     /** <b>CPostEvaluationController</b> is used to to perform the
         evaluation of the scans.
 
@@ -53,16 +59,41 @@ namespace Evaluation
           */
         int EvaluateScan(const novac::CString& pakFileName, const novac::CString &fitWindowName, novac::CString *txtFileName = NULL, CPlumeInScanProperty *plumeProperties = NULL);
 
+        /** Evaluates the spectra of one scan in several fit-windows and writes the results to file.
+            The scan is only read once and the same spectra are then evaluated in each of the fit-windows.
+            The evaluation stops at the first fit-window in which the scan could not be evaluated.
+            @param pakFileName - the name of the .pak-file that should be evaluated
+            @param fitWindowNames - array of 'nFitWindows' names of the fit-windows to use.
+            @param txtFileNames - if not NULL then this array of 'nFitWindows' strings will
+                on return be filled with the names of the generated txt-files, one for each fit-window.
+            @param plumeProperties - if not NULL then this array of 'nFitWindows' elements will
+                on return be filled with the properties of the scan, as evaluated in each fit-window.
+            @param scanResults - if not NULL then this array of 'nFitWindows' elements will on return
+                be filled with the results of the evaluation in each fit-window, as written to the txt-files.
+            @return 0 on success, otherwise the same values as the single fit-window EvaluateScan
+                for the fit-window which failed. */
+        int EvaluateScan(const novac::CString& pakFileName, const novac::CString *fitWindowNames, int nFitWindows, novac::CString *txtFileNames, CPlumeInScanProperty *plumeProperties, std::shared_ptr<const CScanResult> *scanResults = nullptr);
+
     private:
         // ----------------------------------------------------------------------
         // ---------------------- PRIVATE DATA ----------------------------------
         // ----------------------------------------------------------------------
 
+        /** The plume spectra to create from the scan currently being evaluated,
+            these are handed over to the plume spectrum archiver once the scan has been
+            evaluated in all fit-windows. */
+        std::vector<CPlumeSpectrumArchiver::Request> m_plumeSpectraToArchive;
 
         // ----------------------------------------------------------------------
         // --------------------- PRIVATE METHODS --------------------------------
         // ----------------------------------------------------------------------
 
+        /** Evaluates the already opened scan in one fit-window and writes the result to file.
+            @param ev - the scan evaluation to use, this keeps the spectra read from the scan
+                such that they are only read once for all fit-windows.
+            @return the same values as EvaluateScan. */
+        int EvaluateScanInFitWindow(FileHandler::CScanFileHandler& scan, CScanEvaluation& ev, Configuration::CDarkSettings& darkSettings, const novac::CString& pakFileName, const novac::CString &fitWindowName, novac::CString *txtFileName, CPlumeInScanProperty *plumeProperties, std::shared_ptr<const CScanResult> *scanResult);
+
         /** Looks in the configuration of the instruments and searches
             for a configured location and fit-window (for evaluation) which
             is valid for the spectrometer that collected the given scan and
@@ -120,6 +151,16 @@ namespace Evaluation
             @return SUCCESS if a filename is found. */
         RETURN_CODE GetArchivingfileName(novac::CString &pakFile, novac::CString &txtFile, const novac::CString &fitWindowName, const novac::CString &temporaryScanFile, MEASUREMENT_MODE mode);
 
+        /** Gets the filename under which the scan-file should be stored, from the
+            already read information about the scan-file.
+            @return SUCCESS if a filename is found. */
+        RETURN_CODE GetArchivingfileName(novac::CString &pakFile, novac::CString &txtFile, const novac::CString &fitWindowName, const FileHandler::CPakFileCatalog::Entry &pakFileInfo, MEASUREMENT_MODE mode);
+
+        /** Retrieves the information about the given scan-file, from the catalog
+            of .pak-files if the file is there and otherwise from the file itself.
+            @return false if the file could not be read. */
+        static bool GetPakFileInfo(const novac::CString &scanFile, FileHandler::CPakFileCatalog::Entry &pakFileInfo);
+
         /** This function takes as input parameter an eval-log containing the result of a flux - measurement
             and checks the quality of the measurement.
             @param evalLog - the full path and filename of the flux measurement
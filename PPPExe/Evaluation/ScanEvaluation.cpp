@@ -13,13 +13,48 @@
 // This is the settings for how to do the procesing
 #include "../Configuration/UserConfiguration.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
 
 extern CPostProcessingStatistics					g_processingStats; // <-- The statistics of the processing itself
 extern Configuration::CUserConfiguration			g_userSettings;// <-- The settings of the user
 
 using namespace Evaluation;
 
+// The number of scan evaluation threads which have no more scans to evaluate and are not
+//  currently used to evaluate the spectra of another scan.
+static std::atomic<size_t> s_idleThreads{ 0 };
+
+void CScanEvaluation::ResetIdleThreads()
+{
+    s_idleThreads = 0;
+}
+
+void CScanEvaluation::AddIdleThread()
+{
+    ++s_idleThreads;
+}
+
+size_t CScanEvaluation::BorrowIdleThreads(size_t maxNum)
+{
+    size_t available = s_idleThreads.load();
+    size_t taken = std::min(maxNum, available);
+    while (taken > 0 && !s_idleThreads.compare_exchange_weak(available, available - taken))
+    {
+        taken = std::min(maxNum, available);
+    }
+    return taken;
+}
+
+void CScanEvaluation::ReturnIdleThreads(size_t num)
+{
+    s_idleThreads += num;
+}
+
 CScanEvaluation::CScanEvaluation()
     : ScanEvaluationBase()
 {
@@ -140,7 +175,6 @@ long CScanEvaluation::EvaluateScan(FileHandler::CScanFileHandler *scan, const CF
 
 long CScanEvaluation::EvaluateOpenedScan(FileHandler::CScanFileHandler *scan, CEvaluationBase *eval, const Configuration::CDarkSettings *darkSettings) {
     novac::CString message;	// used for ShowMessage messages
-    int	curSpectrumIndex = 0;		// keeping track of the index of the current spectrum into the .pak-file
     double highestColumnInScan = 0.0;	// the highest column-value in the evaluation
 
     CSpectrum dark, current;
@@ -176,7 +210,6 @@ long CScanEvaluation::EvaluateOpenedScan(FileHandler::CScanFileHandler *scan, CE
     m_fitLow -= sky.m_info.m_startChannel;
     m_fitHigh -= sky.m_info.m_startChannel;
 
-    curSpectrumIndex = -1; // we're at spectrum number 0 in the .pak-file
     m_indexOfMostAbsorbingSpectrum = -1;	// as far as we know, there's no absorption in any spectrum...
 
     // the data structure to keep track of the evaluation results
@@ -186,10 +219,127 @@ long CScanEvaluation::EvaluateOpenedScan(FileHandler::CScanFileHandler *scan, CE
     m_result->SetSkySpecInfo(skySpecBeforeDarkCorrection.m_info);
     m_result->SetDarkSpecInfo(dark.m_info);
 
+    // Read the spectra of the scan. This is only done once for each scan, such that
+    //  the same scan can be evaluated in several fit-windows without reading it again.
+    if (m_preparedScan != scan || m_preparedScanFile != scan->GetFileName()) {
+        if (!ReadScanSpectra(scan, sky, dark, darkSettings)) {
+            return -1;
+        }
+    }
+    for (int spectrumIndex : m_corruptedSpectra) {
+        m_result->MarkAsCorrupted(spectrumIndex);
+    }
+
+    // Prepare the spectra for the evaluation in this fit-window. This is done first, such that
+    //  the (time consuming) evaluations can be made in parallel.
+    std::vector<CSpectrum> spectraToEvaluate;
+    std::vector<int> indexInScanFile; // the index of each spectrum to evaluate in the .pak-file
+    for (const PreparedSpectrum& prepared : m_preparedSpectra) {
+        current = prepared.spectrum;
+        dark = prepared.dark;
+
+        // b. Calculate the intensity in the fit region, before we divide by the number of spectra
+        //		and before we subtract the dark
+        current.m_info.m_fitIntensity = (float)current.MaxValue(m_fitLow, m_fitHigh);
+
+        // c. Divide the measured spectrum with the number of co-added spectra
+        //     The sky and dark spectra should already be divided before this loop.
+        if (current.NumSpectra() > 0 && !m_averagedSpectra)
+            current.Div(current.NumSpectra());
+
+        // d. Get the dark spectrum
+        if (dark.NumSpectra() > 0 && !m_averagedSpectra)
+            dark.Div(dark.NumSpectra());
+
+        // e. Check if this spectrum is worth evaluating
+        if (Ignore(current, dark, m_fitLow, m_fitHigh)) {
+            message.Format("  - Ignoring spectrum %d in scan %s.", current.ScanIndex(), scan->GetFileName().c_str());
+            ShowMessage(message);
+            continue;
+        }
+
+        // f. The spectrum is ok, remove the dark.
+        current.Sub(dark);
+
+        spectraToEvaluate.push_back(current);
+        indexInScanFile.push_back(prepared.indexInScanFile);
+    }
+
+    // Evaluate the spectra
+    std::vector<CEvaluationResult> evaluationResults(spectraToEvaluate.size());
+    std::vector<char> evaluationFailed(spectraToEvaluate.size(), 0);
+    const size_t nThreadsWanted = std::min((size_t)g_userSettings.m_threadsPerScan, spectraToEvaluate.size());
+    const size_t nHelperThreads = (nThreadsWanted > 1) ? BorrowIdleThreads(nThreadsWanted - 1) : 0;
+    if (nHelperThreads == 0) {
+        for (size_t k = 0; k < spectraToEvaluate.size(); ++k) {
+            evaluationFailed[k] = (0 != eval->Evaluate(spectraToEvaluate[k]));
+            evaluationResults[k] = eval->GetEvaluationResult();
+        }
+    }
+    else {
+        // Each thread uses its own evaluator, set up in the same way as 'eval', and takes the next
+        //  spectrum to evaluate until there are no more. The results are stored by index to keep the order.
+        std::atomic<size_t> nextSpectrum{ 0 };
+        auto evaluateSpectra = [&](CEvaluationBase* evaluator) {
+            size_t k;
+            while ((k = nextSpectrum++) < spectraToEvaluate.size()) {
+                evaluationFailed[k] = (0 != evaluator->Evaluate(spectraToEvaluate[k]));
+                evaluationResults[k] = evaluator->GetEvaluationResult();
+            }
+        };
+
+        std::vector<std::unique_ptr<CEvaluationBase>> evaluators;
+        std::vector<std::thread> evalThreads;
+        for (size_t threadIdx = 0; threadIdx < nHelperThreads; ++threadIdx) {
+            evaluators.push_back(std::unique_ptr<CEvaluationBase>(new CEvaluationBase(eval->FitWindow())));
+            evaluators.back()->SetSkySpectrum(sky);
+            evalThreads.push_back(std::thread(evaluateSpectra, evaluators.back().get()));
+        }
+        evaluateSpectra(eval);
+
+        for (std::thread& t : evalThreads) {
+            t.join();
+        }
+        ReturnIdleThreads(nHelperThreads);
+    }
+
+    // Save the evaluation results, in the order of the spectra in the scan
+    for (size_t k = 0; k < spectraToEvaluate.size(); ++k) {
+        const CSpectrum& spectrum = spectraToEvaluate[k];
+        if (evaluationFailed[k]) {
+            message.Format("Failed to evaluate spectrum %d out of %d in scan %s from spectrometer %s.",
+                spectrum.ScanIndex(), spectrum.SpectraPerScan(), scan->GetFileName().c_str(), spectrum.m_info.m_device.c_str());
+            ShowMessage(message);
+        }
+
+        // e. Save the evaluation result
+        m_result->AppendResult(evaluationResults[k], spectrum.m_info);
+
+        // f. Check if this was an ok data point (CScanResult)
+        m_result->CheckGoodnessOfFit(spectrum.m_info);
+
+        // g. If it is ok, then check if the value is higher than any of the previous ones
+        if (m_result->IsOk(m_result->GetEvaluatedNum() - 1) && fabs(m_result->GetColumn(m_result->GetEvaluatedNum() - 1, 0)) > highestColumnInScan) {
+            highestColumnInScan = fabs(m_result->GetColumn(m_result->GetEvaluatedNum() - 1, 0));
+            m_indexOfMostAbsorbingSpectrum = indexInScanFile[k];
+        }
+    }
+
+    return m_result->GetEvaluatedNum();
+}
+
+bool CScanEvaluation::ReadScanSpectra(FileHandler::CScanFileHandler *scan, const CSpectrum &sky, CSpectrum dark, const Configuration::CDarkSettings *darkSettings) {
+    int	curSpectrumIndex = -1;		// keeping track of the index of the current spectrum into the .pak-file
+    CSpectrum current;
+
+    m_preparedScan = nullptr;
+    m_preparedScanFile.clear();
+    m_preparedSpectra.clear();
+    m_corruptedSpectra.clear();
+
     // Make sure that we'll start with the first spectrum in the scan
     scan->ResetCounter();
 
-    // Evaluate all the spectra in the scan.
     while (1) {
         // remember which spectrum we're at
         int	spectrumIndex = current.ScanIndex();
@@ -216,7 +366,7 @@ long CScanEvaluation::EvaluateOpenedScan(FileHandler::CScanFileHandler *scan, CE
                 }
                 ShowMessage(errMsg);
                 // remember that this spectrum is corrupted
-                m_result->MarkAsCorrupted(spectrumIndex);
+                m_corruptedSpectra.push_back(spectrumIndex);
                 continue;
             }
         }
@@ -236,56 +386,26 @@ long CScanEvaluation::EvaluateOpenedScan(FileHandler::CScanFileHandler *scan, CE
         // b. Get the dark spectrum for this measured spectrum
         if (!GetDark(scan, current, dark, darkSettings))
         {
-            delete scan;
-            delete eval;
-            return 0;
+            m_preparedSpectra.clear();
+            m_corruptedSpectra.clear();
+            return false;
         }
 
-        // b. Calculate the intensities, before we divide by the number of spectra
+        // b. Calculate the peak intensity, before we divide by the number of spectra
         //		and before we subtract the dark
         current.m_info.m_peakIntensity = (float)current.MaxValue(0, current.m_length - 2);
-        current.m_info.m_fitIntensity = (float)current.MaxValue(m_fitLow, m_fitHigh);
-
-        // c. Divide the measured spectrum with the number of co-added spectra
-        //     The sky and dark spectra should already be divided before this loop.
-        if (current.NumSpectra() > 0 && !m_averagedSpectra)
-            current.Div(current.NumSpectra());
-
-        // d. Get the dark spectrum
-        if (dark.NumSpectra() > 0 && !m_averagedSpectra)
-            dark.Div(dark.NumSpectra());
-
-        // e. Check if this spectrum is worth evaluating
-        if (Ignore(current, dark, m_fitLow, m_fitHigh)) {
-            message.Format("  - Ignoring spectrum %d in scan %s.", current.ScanIndex(), scan->GetFileName().c_str());
-            ShowMessage(message);
-            continue;
-        }
 
-        // f. The spectrum is ok, remove the dark.
-        current.Sub(dark);
-
-        // e. Evaluate the spectrum
-        if (eval->Evaluate(current)) {
-            message.Format("Failed to evaluate spectrum %d out of %d in scan %s from spectrometer %s.",
-                current.ScanIndex(), current.SpectraPerScan(), scan->GetFileName().c_str(), current.m_info.m_device.c_str());
-            ShowMessage(message);
-        }
-
-        // e. Save the evaluation result
-        m_result->AppendResult(eval->GetEvaluationResult(), current.m_info);
-
-        // f. Check if this was an ok data point (CScanResult)
-        m_result->CheckGoodnessOfFit(current.m_info);
-
-        // g. If it is ok, then check if the value is higher than any of the previous ones
-        if (m_result->IsOk(m_result->GetEvaluatedNum() - 1) && fabs(m_result->GetColumn(m_result->GetEvaluatedNum() - 1, 0)) > highestColumnInScan) {
-            highestColumnInScan = fabs(m_result->GetColumn(m_result->GetEvaluatedNum() - 1, 0));
-            m_indexOfMostAbsorbingSpectrum = curSpectrumIndex;
-        }
+        PreparedSpectrum prepared;
+        prepared.spectrum = current;
+        prepared.dark = dark;
+        prepared.indexInScanFile = curSpectrumIndex;
+        m_preparedSpectra.push_back(prepared);
     } // end while(1)
 
-    return m_result->GetEvaluatedNum();
+    m_preparedScan = scan;
+    m_preparedScanFile = scan->GetFileName();
+
+    return true;
 }
 
 bool CScanEvaluation::GetDark(FileHandler::CScanFileHandler *scan, const CSpectrum &spec, CSpectrum &dark, const Configuration::CDarkSettings *darkSettings)
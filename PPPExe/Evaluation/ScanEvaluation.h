@@ -4,6 +4,8 @@
 #include "../Common/Common.h"
 #include <SpectralEvaluation/File/ScanFileHandler.h>
 #include <SpectralEvaluation/Evaluation/ScanEvaluationBase.h>
+#include <string>
+#include <vector>
 
 namespace Evaluation
 {
@@ -34,18 +36,41 @@ namespace Evaluation
         CScanResult *m_result = nullptr;
 
         /** Called to evaluate one scan.
+            The spectra of the scan are only read the first time a scan is evaluated, the same
+                CScanEvaluation can therefore be used to evaluate one scan in several fit-windows.
                 @return the number of spectra evaluated. */
         long EvaluateScan(FileHandler::CScanFileHandler *scan, const CFitWindow &fitWindow, const Configuration::CDarkSettings *darkSettings = NULL);
 
+        /** The spectra of one scan are only evaluated in parallel by borrowing the capacity of the
+            scan evaluation threads which have no more scans to evaluate (e.g. for the last few
+            large scans of the processing), such that the total number of threads evaluating spectra
+            never exceeds the number of scan evaluation threads (g_userSettings.m_maxThreadNum).
+            ResetIdleThreads is called before the scan evaluation threads are started and each of
+            these calls AddIdleThread once it has no more scans to evaluate. */
+        static void ResetIdleThreads();
+        static void AddIdleThread();
+
     private:
 
         // ----------------------- PRIVATE METHODS ---------------------------
 
-        /** Performs the evaluation using the supplied evaluator
+        /** Performs the evaluation using the supplied evaluator.
+            All spectra in the scan are read first and are then evaluated using up to
+            g_userSettings.m_threadsPerScan threads, each with its own copy of the evaluator.
+            Threads beyond the calling one are only used if there are idle scan evaluation threads.
             @return the number of spectra evaluated
             @return -1 if something goes wrong */
         long EvaluateOpenedScan(FileHandler::CScanFileHandler *scan, CEvaluationBase *eval, const Configuration::CDarkSettings *darkSettings = NULL);
 
+        /** Reads all the spectra of the scan which are to be evaluated and prepares them for the
+            evaluation as far as possible without knowing the fit-window (the spectra are
+            interpolated and their dark spectra are retrieved). The result is kept in
+            m_preparedSpectra, such that the scan can be evaluated in several fit-windows.
+            @param sky - the sky spectrum of the scan. This is not evaluated.
+            @param dark - the dark spectrum of the sky spectrum. This is not evaluated.
+            @return true on success. */
+        bool ReadScanSpectra(FileHandler::CScanFileHandler *scan, const CSpectrum &sky, CSpectrum dark, const Configuration::CDarkSettings *darkSettings);
+
         /** This returns the sky spectrum that is to be used in the fitting.
             Which spectrum to be used is taken from the given settings.
             @return true on success. */
@@ -75,12 +100,38 @@ namespace Evaluation
             @return nullptr if the evaluation failed. */
         CEvaluationBase* FindOptimumShiftAndSqueeze(const CFitWindow &fitWindow, int indexOfMostAbsorbingSpectrum, FileHandler::CScanFileHandler& scan);
 
+        /** Takes up to 'maxNum' of the idle scan evaluation threads.
+            @return the number of threads taken, these must be given back using ReturnIdleThreads. */
+        static size_t BorrowIdleThreads(size_t maxNum);
+        static void ReturnIdleThreads(size_t num);
+
         // ------------------------ THE PARAMETERS FOR THE EVALUATION ------------------
 
         /** Remember the index of the spectrum with the highest absorption, to be able to
             adjust the shift and squeeze with it later */
         int m_indexOfMostAbsorbingSpectrum;
 
+        /** A spectrum read from the scan, together with its dark spectrum.
+            Neither of these have yet been divided by the number of co-added spectra. */
+        struct PreparedSpectrum
+        {
+            CSpectrum spectrum;
+            CSpectrum dark;
+
+            /** The index of the spectrum in the .pak-file */
+            int indexInScanFile = 0;
+        };
+
+        /** The scan which the spectra in m_preparedSpectra were read from */
+        const FileHandler::CScanFileHandler *m_preparedScan = nullptr;
+        std::string m_preparedScanFile;
+
+        /** The spectra to evaluate in the last read scan */
+        std::vector<PreparedSpectrum> m_preparedSpectra;
+
+        /** The indices of the corrupted spectra in the last read scan */
+        std::vector<int> m_corruptedSpectra;
+
         /** how many spectra there are in the current scan-file (for showing the progress) */
         long m_prog_SpecNum;
 
@@ -3,11 +3,31 @@
 #include <PPPLib/CFileUtils.h>
 #include <Poco/DirectoryIterator.h>
 #include <Poco/Exception.h>
+#include <Poco/File.h>
 
 void ShowMessage(const char message[]);
 
 namespace Filesystem
 {
+    bool GetFileVersion(const std::string& fileName, FileVersion& version)
+    {
+        try
+        {
+            Poco::File file(fileName);
+            if (!file.exists())
+            {
+                return false;
+            }
+            version.lastModified = (long long)file.getLastModified().epochMicroseconds();
+            version.size = (long long)file.getSize();
+            return true;
+        }
+        catch (Poco::Exception&)
+        {
+            return false;
+        }
+    }
+
     void SearchDirectoryForFiles(const novac::CString &path, bool includeSubdirectories, std::vector<std::string>& fileList, FileSearchCriterion* criteria)
     {
         try
@@ -55,7 +75,11 @@ namespace Filesystem
                     {
                         if (!novac::Equals(fileName.Right(criteria->fileExtension.size()), criteria->fileExtension))
                         {
-                            continue;
+                            const std::string compressedExtension = criteria->fileExtension + ".gz";
+                            if (!criteria->includeCompressedFiles || !novac::Equals(fileName.Right(compressedExtension.size()), compressedExtension))
+                            {
+                                continue;
+                            }
                         }
                         if (novac::Equals(criteria->fileExtension, ".pak"))
                         {
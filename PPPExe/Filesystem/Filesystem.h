@@ -17,8 +17,25 @@ namespace Filesystem
         CDateTime startTime;
         CDateTime endTime;
         std::string fileExtension;
+
+        /** If true then files with the extension followed by '.gz' (i.e. compressed files) are also found. */
+        bool includeCompressedFiles = false;
+    };
+
+    /** The version of a file, i.e. the time it was last modified and its size.
+        Used to find out if a file has been changed since it was last read. */
+    struct FileVersion
+    {
+        long long lastModified = 0;
+        long long size = 0;
+
+        bool operator==(const FileVersion& other) const { return lastModified == other.lastModified && size == other.size; }
     };
 
+    /** Retrieves the current version of the given file.
+        @return false if the file doesn't exist or cannot be accessed */
+    bool GetFileVersion(const std::string& fileName, FileVersion& version);
+
     /** Scans through the given directory in search for files with the given criteria.
         @param path - the directory (on the local computer) where to search for files.
         @param includeSubdirectories If set to true then sub-directories of the provided path will also be searched.
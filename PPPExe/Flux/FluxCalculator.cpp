@@ -31,6 +31,10 @@ CFluxCalculator::~CFluxCalculator(void)
     @return 0 on success, else non-zero value
     */
 int CFluxCalculator::CalculateFlux(const novac::CString& evalLogFileName, const Meteorology::CWindDataBase &windDataBase, const Geometry::CPlumeHeight &plumeAltitude, CFluxResult &fluxResult) {
+    return CalculateFlux(evalLogFileName, nullptr, windDataBase, plumeAltitude, fluxResult);
+}
+
+int CFluxCalculator::CalculateFlux(const novac::CString& evalLogFileName, const Evaluation::CScanResult *scanResult, const Meteorology::CWindDataBase &windDataBase, const Geometry::CPlumeHeight &plumeAltitude, CFluxResult &fluxResult) {
     CDateTime skyStartTime;
     novac::CString errorMessage, shortFileName, serial;
     Geometry::CPlumeHeight relativePlumeHeight;
@@ -71,22 +75,28 @@ int CFluxCalculator::CalculateFlux(const novac::CString& evalLogFileName, const
         return 6;
     }
 
-    // 5. Read in the evaluation log file 
-    FileHandler::CEvaluationLogFileHandler reader;
-    reader.m_evaluationLog.Format(evalLogFileName);
-    reader.ReadEvaluationLog();
-    if (reader.m_scan.size() == 0) {
-        errorMessage.Format("Recieved evaluation log file (%s) with no scans inside. Cannot calculate flux", (const char*)evalLogFileName);
-        ShowMessage(errorMessage);
-        return 2;
-    }
-    else if (reader.m_scan.size() > 1) {
-        errorMessage.Format("Recieved evaluation log file (%s) with more than one scans inside. Can only calculate flux for the first scan.", (const char*)evalLogFileName);
-        ShowMessage(errorMessage);
+    // 5. Read in the evaluation log file, unless we already have the scan
+    Evaluation::CScanResult result;
+    if (scanResult != nullptr) {
+        result = *scanResult;
     }
+    else {
+        FileHandler::CEvaluationLogFileHandler reader;
+        reader.m_evaluationLog.Format(evalLogFileName);
+        reader.ReadEvaluationLog();
+        if (reader.m_scan.size() == 0) {
+            errorMessage.Format("Recieved evaluation log file (%s) with no scans inside. Cannot calculate flux", (const char*)evalLogFileName);
+            ShowMessage(errorMessage);
+            return 2;
+        }
+        else if (reader.m_scan.size() > 1) {
+            errorMessage.Format("Recieved evaluation log file (%s) with more than one scans inside. Can only calculate flux for the first scan.", (const char*)evalLogFileName);
+            ShowMessage(errorMessage);
+        }
 
-    // 6. extract the scan
-    Evaluation::CScanResult &result = reader.m_scan[0];
+        // 6. extract the scan
+        result = reader.m_scan[0];
+    }
 
     // 6b. Improve on the start-time of the scan...
     result.GetSkyStartTime(skyStartTime);
@@ -57,6 +57,12 @@ namespace Flux {
           */
         int CalculateFlux(const novac::CString& evalLogFileName, const Meteorology::CWindDataBase &windDataBase, const Geometry::CPlumeHeight &plumeAltitude, CFluxResult &fluxResult);
 
+        /** Calculates the flux from the scan found in the given evaluation log file.
+            @param scanResult - if not null then this is the already evaluated scan in
+                the evaluation log file and the file will not be read.
+            The other parameters and the return values are the same as above. */
+        int CalculateFlux(const novac::CString& evalLogFileName, const Evaluation::CScanResult *scanResult, const Meteorology::CWindDataBase &windDataBase, const Geometry::CPlumeHeight &plumeAltitude, CFluxResult &fluxResult);
+
     private:
         // ----------------------------------------------------------------------
         // ---------------------- PRIVATE DATA ----------------------------------
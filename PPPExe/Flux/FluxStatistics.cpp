@@ -106,7 +106,7 @@ void CFluxStatistics::Clear() {
 
 /** Attaches the supplied list of flux results to the current set
     of measured data. */
-void CFluxStatistics::AttachFluxList(novac::CList <CFluxResult, CFluxResult&>& calculatedFluxes) {
+void CFluxStatistics::AttachFluxList(novac::CVectorList <CFluxResult, CFluxResult&>& calculatedFluxes) {
     auto p = calculatedFluxes.GetHeadPosition();
     while (p != nullptr) {
         AttachFlux(calculatedFluxes.GetNext(p));
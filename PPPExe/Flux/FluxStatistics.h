@@ -6,6 +6,7 @@
 // #include <afxtempl.h>
 #include <PPPLib/CString.h>
 #include <PPPLib/CList.h>
+#include <PPPLib/CVectorList.h>
 #include "FluxResult.h"
 
 namespace Flux {
@@ -29,7 +30,7 @@ namespace Flux {
 
         /** Attaches the supplied list of flux results to the current set
             of measured data. */
-        void AttachFluxList(novac::CList<CFluxResult, CFluxResult&>& calculatedFluxes);
+        void AttachFluxList(novac::CVectorList<CFluxResult, CFluxResult&>& calculatedFluxes);
 
         /** Attaches the given flux result to the current set of
             measured data */
@@ -686,6 +686,19 @@ bool CGeometryCalculator::CalculatePlumeHeight(const novac::CString &evalLog, in
         @return true on success */
 bool CGeometryCalculator::CalculateWindDirection(const novac::CString &evalLog, int scanIndex, Geometry::CPlumeHeight &absolutePlumeHeight, Configuration::CInstrumentLocation location, Geometry::CGeometryResult &result) {
     FileHandler::CEvaluationLogFileHandler reader;
+
+    // Read the evaluation-log
+    reader.m_evaluationLog.Format("%s", (const char*)evalLog);
+    if (SUCCESS != reader.ReadEvaluationLog())
+        return false;
+
+    return CalculateWindDirection(reader.m_scan[scanIndex], absolutePlumeHeight, location, result);
+}
+
+/** Calculate the wind direction using the given scan.
+        @return true on success */
+bool CGeometryCalculator::CalculateWindDirection(const Evaluation::CScanResult &scanResult, Geometry::CPlumeHeight &absolutePlumeHeight, Configuration::CInstrumentLocation location, Geometry::CGeometryResult &result) {
+    Evaluation::CScanResult scan = scanResult;
     CPlumeInScanProperty plume;
     CGPSData source, scannerPos;
 
@@ -700,13 +713,8 @@ bool CGeometryCalculator::CalculateWindDirection(const novac::CString &evalLog,
     source.m_longitude = g_volcanoes.GetPeakLongitude(volcanoIndex1);
     source.m_altitude = (long)g_volcanoes.GetPeakAltitude(volcanoIndex1);
 
-    // 3. Read the evaluation-log
-    reader.m_evaluationLog.Format("%s", (const char*)evalLog);
-    if (SUCCESS != reader.ReadEvaluationLog())
-        return false;
-
     // 4. Get the scan-angles around which the plumes are centred
-    if (false == reader.m_scan[scanIndex].CalculatePlumeCentre(CMolecule(g_userSettings.m_molecule), plume)) {
+    if (false == scan.CalculatePlumeCentre(CMolecule(g_userSettings.m_molecule), plume)) {
         return false; // <-- cannot see the plume
     }
     if (plume.completeness < g_userSettings.m_calcGeometry_CompletenessLimit + 0.01) {
@@ -750,7 +758,7 @@ bool CGeometryCalculator::CalculateWindDirection(const novac::CString &evalLog,
     if (windDirectionErr > g_userSettings.m_calcGeometry_MaxWindDirectionError)
         return false;
 
-    reader.m_scan[scanIndex].GetStartTime(0, result.m_averageStartTime);
+    scan.GetStartTime(0, result.m_averageStartTime);
     result.m_plumeAltitude = NOT_A_NUMBER;
     result.m_plumeAltitudeError = 0.0;
     result.m_windDirection = windDirection;
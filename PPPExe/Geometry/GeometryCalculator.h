@@ -7,6 +7,11 @@
 
 #include <PPPLib/CString.h>
 
+namespace Evaluation
+{
+    class CScanResult;
+}
+
 namespace Geometry {
 
     /** <b>CGeometryCalculator</b> contains generic methods for performing
@@ -74,6 +79,10 @@ namespace Geometry {
                 @return true on success */
         static bool CalculateWindDirection(const novac::CString &evalLog, int scanIndex, Geometry::CPlumeHeight &absolutePlumeHeight, Configuration::CInstrumentLocation location, Geometry::CGeometryResult &result);
 
+        /** Calculate the wind direction using the given, already evaluated, scan.
+                This is the same calculation as above, without reading the evaluation-file. */
+        static bool CalculateWindDirection(const Evaluation::CScanResult &scanResult, Geometry::CPlumeHeight &absolutePlumeHeight, Configuration::CInstrumentLocation location, Geometry::CGeometryResult &result);
+
     protected:
 
         /** Calculates the height of the plume given data from two scans
@@ -10,6 +10,7 @@
 #include "Configuration/UserConfiguration.h"
 #include "Common/EvaluationConfigurationParser.h"
 #include "Common/ProcessingFileReader.h"
+#include "Common/AsynchronousLogger.h"
 #include "PostProcessing.h"
 
 #include <iostream>
@@ -24,6 +25,7 @@
 
 extern Configuration::CNovacPPPConfiguration        g_setup;	   // <-- The settings
 extern Configuration::CUserConfiguration            g_userSettings;// <-- The settings of the user
+extern CAsynchronousLogger                          g_logger;      // <-- Writes the messages to the log in the background
 
 novac::CVolcanoInfo g_volcanoes;   // <-- A list of all known volcanoes
 
@@ -103,17 +105,24 @@ protected:
             splitterChannel->addChannel(new Poco::FileChannel(g_userSettings.m_outputDirectory.std_str() + "StatusLog.txt"));
             log.setChannel(splitterChannel);
 
+            // From now on the messages are written to the log by a background thread
+            g_logger.Start(g_userSettings.m_dropLogMessagesWhenBusy);
+
             // Start calculating the fluxes, this is the old button handler
             std::cout << " Setup done: starting calculations" << std::endl;
             StartProcessing();
+
+            g_logger.Stop();
         }
         catch (Poco::FileNotFoundException& e)
         {
+            g_logger.Stop();
             std::cout << e.displayText() << std::endl;
             return 1;
         }
         catch (std::exception& e)
         {
+            g_logger.Stop();
             std::cout << e.what() << std::endl;
             return 1;
         }
@@ -248,7 +257,11 @@ void CalculateAllFluxes()
         }
 
         // Do the post-processing
-        if (g_userSettings.m_processingMode == PROCESSING_MODE_COMPOSITION)
+        if (g_userSettings.m_restoreEvaluationLogs)
+        {
+            post.RestoreEvaluationLogs();
+        }
+        else if (g_userSettings.m_processingMode == PROCESSING_MODE_COMPOSITION)
         {
             ShowMessage("Warning: Post processing of composition measurements is not yet fully implemented");
             post.DoPostProcessing_Flux(); // this uses the same code as the flux processing
@@ -366,6 +379,85 @@ void ParseCommandLineOptions(const std::vector<std::string> &arguments)
             continue;
         }
 
+        // running the processing as a pipeline
+        if (Equals(currentToken, FLAG(str_pipelinedProcessing), strlen(FLAG(str_pipelinedProcessing))))
+        {
+            int pipelined = 0;
+            sscanf(currentToken.c_str() + strlen(FLAG(str_pipelinedProcessing)), "%d", &pipelined);
+            g_userSettings.m_pipelinedProcessing = (pipelined != 0);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // the number of threads to use for evaluating each scan
+        if (Equals(currentToken, FLAG(str_threadsPerScan), strlen(FLAG(str_threadsPerScan))))
+        {
+            sscanf(currentToken.c_str() + strlen(FLAG(str_threadsPerScan)), "%ld", &g_userSettings.m_threadsPerScan);
+            g_userSettings.m_threadsPerScan = std::max(g_userSettings.m_threadsPerScan, (unsigned long)1);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // keeping the evaluated scans in memory
+        if (Equals(currentToken, FLAG(str_keepScanResultsInMemory), strlen(FLAG(str_keepScanResultsInMemory))))
+        {
+            int keepInMemory = 0;
+            sscanf(currentToken.c_str() + strlen(FLAG(str_keepScanResultsInMemory)), "%d", &keepInMemory);
+            g_userSettings.m_keepScanResultsInMemory = (keepInMemory != 0);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // writing binary copies of the evaluation logs
+        if (Equals(currentToken, FLAG(str_writeBinaryEvaluationLogs), strlen(FLAG(str_writeBinaryEvaluationLogs))))
+        {
+            int writeBinaryLogs = 0;
+            sscanf(currentToken.c_str() + strlen(FLAG(str_writeBinaryEvaluationLogs)), "%d", &writeBinaryLogs);
+            g_userSettings.m_writeBinaryEvaluationLogs = (writeBinaryLogs != 0);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // regenerating the evaluation logs from their binary copies
+        if (Equals(currentToken, FLAG(str_restoreEvaluationLogs), strlen(FLAG(str_restoreEvaluationLogs))))
+        {
+            int restoreLogs = 0;
+            sscanf(currentToken.c_str() + strlen(FLAG(str_restoreEvaluationLogs)), "%d", &restoreLogs);
+            g_userSettings.m_restoreEvaluationLogs = (restoreLogs != 0);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // the memory used for the most recently read evaluation logs
+        if (Equals(currentToken, FLAG(str_evaluationLogCacheSize), strlen(FLAG(str_evaluationLogCacheSize))))
+        {
+            int cacheSize = 0;
+            sscanf(currentToken.c_str() + strlen(FLAG(str_evaluationLogCacheSize)), "%d", &cacheSize);
+            g_userSettings.m_evaluationLogCacheSize = (unsigned long)std::max(cacheSize, 0);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // dropping log messages when the log can't keep up
+        if (Equals(currentToken, FLAG(str_dropLogMessagesWhenBusy), strlen(FLAG(str_dropLogMessagesWhenBusy))))
+        {
+            int dropMessages = 0;
+            sscanf(currentToken.c_str() + strlen(FLAG(str_dropLogMessagesWhenBusy)), "%d", &dropMessages);
+            g_userSettings.m_dropLogMessagesWhenBusy = (dropMessages != 0);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
+        // compressing the evaluation logs
+        if (Equals(currentToken, FLAG(str_compressLogs), strlen(FLAG(str_compressLogs))))
+        {
+            int compressLogs = 0;
+            sscanf(currentToken.c_str() + strlen(FLAG(str_compressLogs)), "%d", &compressLogs);
+            g_userSettings.m_compressLogs = (compressLogs != 0);
+            token = tokenizer.NextToken();
+            continue;
+        }
+
         // The options for the local directory
         if (Equals(currentToken, FLAG(str_includeSubDirectories_Local), strlen(FLAG(str_includeSubDirectories_Local))))
         {
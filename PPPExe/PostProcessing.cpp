@@ -6,9 +6,14 @@
 #undef max
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <unordered_map>
 
 // the PostEvaluationController takes care of the DOAS evaluations
 #include "Evaluation/PostEvaluationController.h"
+#include "Evaluation/ScanEvaluation.h"
 
 // The FluxCalculator takes care of calculating the fluxes
 #include "Flux/FluxCalculator.h"
@@ -33,6 +38,12 @@
 #include "Meteorology/XMLWindFileReader.h"
 #include "Filesystem/Filesystem.h"
 #include "Common/EvaluationLogFileHandler.h"
+#include "Common/BinaryEvaluationLog.h"
+#include "Common/EvaluationLogIndex.h"
+#include "Common/PakFileCatalog.h"
+#include "Common/SummaryFileWriter.h"
+#include "Common/TextFileWriter.h"
+#include "Evaluation/PlumeSpectrumArchiver.h"
 
 #include <PPPLib/VolcanoInfo.h>
 #include <PPPLib/CFileUtils.h>
@@ -47,6 +58,7 @@
 
 #include <Poco/DirectoryIterator.h>
 #include <Poco/Exception.h>
+#include <Poco/Path.h>
 
 #undef min
 #undef max
@@ -54,21 +66,41 @@
 extern Configuration::CNovacPPPConfiguration    g_setup;    // <-- The settings
 extern Configuration::CUserConfiguration        g_userSettings;// <-- The settings of the user
 extern novac::CVolcanoInfo                      g_volcanoes;   // <-- A list of all known volcanoes
+extern FileHandler::CSummaryFileWriter          g_summaryFiles; // <-- The summary files shared by the evaluation threads
+extern Evaluation::CPlumeSpectrumArchiver       g_plumeSpectrumArchiver; // <-- Writes the plume spectra in the background
+extern FileHandler::CPakFileCatalog             g_pakFileCatalog; // <-- The information about the .pak-files to evaluate
 CPostProcessingStatistics                       g_processingStats; // <-- The statistics of the processing itself
 
 
+// The outcome of evaluating one .pak-file, handed from the evaluation threads
+//  to the following calculations when running the processing as a pipeline.
+struct EvaluatedPakFile
+{
+    std::string pakFile;
+    bool succeeded = false;
+    Evaluation::CExtendedScanResult result;
+};
+
 // this is the working-thread that takes care of evaluating a portion of the scans
-void EvaluateScansThread();
+//  'threadIndex' is the index of the queue in 's_pakFilesRemaining' which this thread primarily takes its files from.
+//  if 'evaluatedPakFiles' is not null then the outcome of every evaluation is pushed onto
+//  this queue, otherwise the successfully evaluated scans are added to 's_evalLogs'.
+void EvaluateScansThread(size_t threadIndex, novac::BoundedQueue<EvaluatedPakFile>* evaluatedPakFiles);
 
-// this takes care of adding the evaluated log-files to the list in an synchronized way
+// this estimates the relative time it takes to evaluate the given .pak-file, as the size
+//  of the file times the number of fit-windows it will be evaluated in.
+//  'fitWindowsPerChannel' caches the number of fit-windows found for each instrument and channel.
+double EstimateEvaluationCost(const std::string& pakFile, std::map<std::string, int>& fitWindowsPerChannel);
+
+// this creates the result of a successfully evaluated scan
 //  the parameter passed in a reference to an array of strings holding the names of the 
 //  eval-log files generated
-void AddResultToList(const novac::CString &pakFileName, const novac::CString(&evalLog)[MAX_FIT_WINDOWS], const CPlumeInScanProperty &scanProperties);
+Evaluation::CExtendedScanResult CreateEvaluationResult(const novac::CString &pakFileName, const novac::CString(&evalLog)[MAX_FIT_WINDOWS], const CPlumeInScanProperty &scanProperties);
 
 void CPostProcessing::DoPostProcessing_Flux()
 {
     novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> evalLogFiles;
-    novac::CList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> geometryResults;
+    novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> geometryResults;
     novac::CString messageToUser, windFileName;
 
     ShowMessage("--- Prepairing to perform Flux Calculations --- ");
@@ -135,12 +167,27 @@ void CPostProcessing::DoPostProcessing_Flux()
             return;
         }
 
-        // Evaluate the scans. This at the same time generates a list of evaluation-log
-        // files with the evaluated results
-        ShowMessage("--- Running Evaluations --- ");
-        EvaluateScans(pakFileList, evalLogFiles);
-        messageToUser.Format("%d evaluation log files accepted", evalLogFiles.GetCount());
-        ShowMessage(messageToUser);
+        // Read the information about the .pak-files needed before they are evaluated
+        CatalogPakFiles(pakFileList);
+
+        if (g_userSettings.m_pipelinedProcessing)
+        {
+            // Evaluate the scans and calculate the geometries, dual-beam wind speeds
+            //  and fluxes while the evaluations are still running.
+            ShowMessage("--- Running Evaluations and Calculations as a pipeline --- ");
+            RunPipelinedProcessing(pakFileList, evalLogFiles, geometryResults);
+            messageToUser.Format("%d evaluation log files accepted", evalLogFiles.GetCount());
+            ShowMessage(messageToUser);
+        }
+        else
+        {
+            // Evaluate the scans. This at the same time generates a list of evaluation-log
+            // files with the evaluated results
+            ShowMessage("--- Running Evaluations --- ");
+            EvaluateScans(pakFileList, evalLogFiles);
+            messageToUser.Format("%d evaluation log files accepted", evalLogFiles.GetCount());
+            ShowMessage(messageToUser);
+        }
     }
     else
     {
@@ -148,28 +195,37 @@ void CPostProcessing::DoPostProcessing_Flux()
         LocateEvaluationLogFiles(g_userSettings.m_outputDirectory, evalLogFiles);
     }
 
-    // Sort the evaluation-logs in order of increasing start-time, this to make
-    // the looking for matching files in 'CalculateGeometries' faster
-    ShowMessage("Evaluation done. Sorting the evaluation log files");
-    SortEvaluationLogs(evalLogFiles);
-    ShowMessage("Sort done.");
+    if (g_userSettings.m_doEvaluations && g_userSettings.m_pipelinedProcessing)
+    {
+        // The geometries, wind speeds and fluxes have already been calculated by the pipeline,
+        //  what remains is to write the calculated geometries to file.
+        WriteCalculatedGeometriesToFile(geometryResults);
+    }
+    else
+    {
+        // Sort the evaluation-logs in order of increasing start-time, this to make
+        // the looking for matching files in 'CalculateGeometries' faster
+        ShowMessage("Evaluation done. Sorting the evaluation log files");
+        SortEvaluationLogs(evalLogFiles);
+        ShowMessage("Sort done.");
 
-    // 3. Loop through list with output text files from evaluation and calculate
-    //      the geometries
-    CalculateGeometries(evalLogFiles, geometryResults);
+        // 3. Loop through list with output text files from evaluation and calculate
+        //      the geometries
+        CalculateGeometries(evalLogFiles, geometryResults);
 
-    // 4.1 write the calculations to file, for later checking or other uses...
-    WriteCalculatedGeometriesToFile(geometryResults);
+        // 4.1 write the calculations to file, for later checking or other uses...
+        WriteCalculatedGeometriesToFile(geometryResults);
 
-    // 4.2 Insert the calculated geometries into the plume height database
-    InsertCalculatedGeometriesIntoDataBase(geometryResults);
+        // 4.2 Insert the calculated geometries into the plume height database
+        InsertCalculatedGeometriesIntoDataBase(geometryResults);
 
-    // 5. Calculate the wind-speeds from the wind-speed measurements
-    //  the plume heights are taken from the database
-    CalculateDualBeamWindSpeeds(evalLogFiles);
+        // 5. Calculate the wind-speeds from the wind-speed measurements
+        //  the plume heights are taken from the database
+        CalculateDualBeamWindSpeeds(evalLogFiles);
 
-    // 6. Calculate flux from evaluation text files
-    CalculateFluxes(evalLogFiles);
+        // 6. Calculate flux from evaluation text files
+        CalculateFluxes(evalLogFiles);
+    }
 
     // 7. Write the statistics
     novac::CString statFileName;
@@ -246,6 +302,9 @@ void CPostProcessing::DoPostProcessing_Strat()
         return;
     }
 
+    // Read the information about the .pak-files needed before they are evaluated
+    CatalogPakFiles(pakFileList);
+
     // Evaluate the scans. This at the same time generates a list of evaluation-log
     // files with the evaluated results
     EvaluateScans(pakFileList, evalLogFiles);
@@ -268,6 +327,46 @@ void CPostProcessing::DoPostProcessing_Strat()
     g_processingStats.WriteStatToFile(statFileName);
 }
 
+void CPostProcessing::RestoreEvaluationLogs()
+{
+    novac::CString messageToUser;
+    std::vector<std::string> binaryLogFiles;
+
+    messageToUser.Format("Searching for binary evaluation logs in directory %s", (const char*)g_userSettings.m_outputDirectory);
+    ShowMessage(messageToUser);
+
+    // the binary logs are named as the (uncompressed) evaluation logs, with '.bin' appended
+    Filesystem::FileSearchCriterion limits;
+    limits.startTime = g_userSettings.m_fromDate;
+    limits.endTime = g_userSettings.m_toDate;
+    limits.fileExtension = ".txt.bin";
+    Filesystem::SearchDirectoryForFiles(g_userSettings.m_outputDirectory, true, binaryLogFiles, &limits);
+
+    size_t nRestored = 0;
+    size_t nFailed = 0;
+    for (const std::string& binaryLogFile : binaryLogFiles)
+    {
+        const std::string evaluationLog = binaryLogFile.substr(0, binaryLogFile.size() - 4);
+        if (FileHandler::CTextFileWriter::FindFile(evaluationLog).size() > 0)
+        {
+            continue; // the evaluation log is still there
+        }
+
+        FileHandler::CBinaryEvaluationLog binaryLog;
+        if (SUCCESS != binaryLog.ReadFromFile(novac::CString(binaryLogFile)) || SUCCESS != binaryLog.WriteTextLog(novac::CString(evaluationLog)))
+        {
+            messageToUser.Format("Failed to restore evaluation log %s", evaluationLog.c_str());
+            ShowMessage(messageToUser);
+            ++nFailed;
+            continue;
+        }
+        ++nRestored;
+    }
+
+    messageToUser.Format("%d binary evaluation logs found, %d evaluation logs restored and %d failed", (int)binaryLogFiles.size(), (int)nRestored, (int)nFailed);
+    ShowMessage(messageToUser);
+}
+
 void CPostProcessing::CheckForSpectraOnFTPServer(std::vector<std::string>& fileList)
 {
     Communication::CFTPServerConnection serverDownload;
@@ -287,31 +386,63 @@ void CPostProcessing::CheckForSpectraOnFTPServer(std::vector<std::string>& fileL
     }
 }
 
-novac::GuardedList<std::string> s_pakFilesRemaining;
+void CPostProcessing::CatalogPakFiles(const std::vector<std::string>& pakFileList)
+{
+    novac::CString catalogFile, messageToUser;
+    catalogFile.Format("%s%cPakFileCatalog.txt", (const char*)g_userSettings.m_outputDirectory, Poco::Path::separator());
+
+    // the catalog from the previous processing, if any
+    g_pakFileCatalog.ReadFromFile(catalogFile.std_str());
+
+    const size_t nFilesRead = g_pakFileCatalog.Build(pakFileList, g_userSettings.m_maxThreadNum);
+    messageToUser.Format("%d of %d spectrum files read into the catalog of spectrum files", (int)nFilesRead, (int)pakFileList.size());
+    ShowMessage(messageToUser);
+
+    if (nFilesRead > 0 && !g_pakFileCatalog.WriteToFile(catalogFile.std_str()))
+    {
+        messageToUser.Format("Failed to write the catalog of spectrum files to %s", (const char*)catalogFile);
+        ShowMessage(messageToUser);
+    }
+}
+
+// the .pak-files which remains to be evaluated, in one queue per evaluation thread.
+novac::WorkStealingQueue<std::string> s_pakFilesRemaining;
 novac::GuardedList<Evaluation::CExtendedScanResult> s_evalLogs;
 
 volatile unsigned long s_nFilesToProcess;
 
+// The number of plume spectrum files written at the same time during the evaluation
+static const size_t s_plumeSpectrumArchivingThreads = 2;
+
 void CPostProcessing::EvaluateScans(const std::vector<std::string>& pakFileList, novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &>& evalLogFiles)
 {
     s_nFilesToProcess = (long)pakFileList.size();
     novac::CString messageToUser;
 
-    // share the list of pak-files with the other functions around here
+    // share the list of pak-files with the other functions around here.
+    //  The files are handed out with the most time consuming first, such that the
+    //  evaluation doesn't end with a few threads working on the largest files.
+    std::map<std::string, int> fitWindowsPerChannel;
+    std::vector<std::pair<std::string, double>> jobs;
     for (const std::string& file : pakFileList)
     {
-        s_pakFilesRemaining.AddItem(file);
+        jobs.push_back(std::make_pair(file, EstimateEvaluationCost(file, fitWindowsPerChannel)));
     }
+    s_pakFilesRemaining.Reset(g_userSettings.m_maxThreadNum);
+    s_pakFilesRemaining.Distribute(jobs);
 
     // Keep the user informed about what we're doing
     messageToUser.Format("%ld spectrum files found. Begin evaluation using %d threads.", s_nFilesToProcess, g_userSettings.m_maxThreadNum);
     ShowMessage(messageToUser);
 
-    // start the threads
+    // start the threads, the summary files and the plume spectra are written by separate threads
+    g_summaryFiles.Start();
+    g_plumeSpectrumArchiver.Start(s_plumeSpectrumArchivingThreads);
+    Evaluation::CScanEvaluation::ResetIdleThreads();
     std::vector<std::thread> evalThreads(g_userSettings.m_maxThreadNum);
     for (unsigned int threadIdx = 0; threadIdx < g_userSettings.m_maxThreadNum; ++threadIdx)
     {
-        std::thread t{ EvaluateScansThread };
+        std::thread t{ EvaluateScansThread, (size_t)threadIdx, nullptr };
         evalThreads[threadIdx] = std::move(t);
     }
 
@@ -320,6 +451,8 @@ void CPostProcessing::EvaluateScans(const std::vector<std::string>& pakFileList,
     {
         evalThreads[threadIdx].join();
     }
+    g_summaryFiles.Stop();
+    g_plumeSpectrumArchiver.Stop();
 
     // copy out the result
     s_evalLogs.CopyTo(evalLogFiles);
@@ -328,7 +461,280 @@ void CPostProcessing::EvaluateScans(const std::vector<std::string>& pakFileList,
     ShowMessage(messageToUser);
 }
 
-void EvaluateScansThread()
+void CPostProcessing::RunPipelinedProcessing(const std::vector<std::string>& pakFileList,
+    novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &>& evalLogFiles,
+    novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*>& geometryResults)
+{
+    // The start time of a scan is here taken from the name of the .pak-file, this may differ
+    //  slightly from the start time in the name of the evaluation log. All scans are therefore
+    //  only considered to be evaluated up to this many seconds before the first remaining .pak-file.
+    const int startTimeMargin = 10 * 60;
+    const CDateTime endOfTime = CDateTime(9999, 12, 31, 23, 59, 59);
+    novac::CString messageToUser;
+
+    auto earliest = [](const CDateTime& t1, const CDateTime& t2) { return (t2 < t1) ? t2 : t1; };
+    auto byStartTime = [](const Evaluation::CExtendedScanResult& r1, const Evaluation::CExtendedScanResult& r2) { return r1.m_startTime < r2.m_startTime; };
+
+    // 1. Evaluate the .pak-files in order of increasing start time, this makes the range of
+    //  completely evaluated scans (and thus the calculations) move forward as fast as possible.
+    struct PakFileInfo
+    {
+        std::string fileName;
+        CDateTime startTime;
+        bool evaluated = false;
+    };
+    std::vector<PakFileInfo> pakFiles;
+    for (const std::string& file : pakFileList)
+    {
+        PakFileInfo info;
+        info.fileName = file;
+
+        novac::CString serial;
+        int channel;
+        MEASUREMENT_MODE mode;
+        FileHandler::CPakFileCatalog::Entry catalogEntry;
+        if (!novac::CFileUtils::GetInfoFromFileName(novac::CString(file), info.startTime, serial, channel, mode))
+        {
+            if (g_pakFileCatalog.Find(file, catalogEntry))
+            {
+                info.startTime = catalogEntry.startTime;
+            }
+            else
+            {
+                // unknown start time, nothing can be calculated before this file has been evaluated
+                info.startTime = CDateTime(0, 0, 0, 0, 0, 0);
+            }
+        }
+        pakFiles.push_back(info);
+    }
+    std::stable_sort(begin(pakFiles), end(pakFiles), [](const PakFileInfo& f1, const PakFileInfo& f2) { return f1.startTime < f2.startTime; });
+
+    // the files are dealt out in time order to the evaluation threads, the threads
+    //  which runs out of files takes over the earliest files of the busiest thread.
+    std::map<std::string, int> fitWindowsPerChannel;
+    std::map<std::string, size_t> pakFileIndex;
+    s_pakFilesRemaining.Reset(g_userSettings.m_maxThreadNum);
+    for (size_t k = 0; k < pakFiles.size(); ++k)
+    {
+        pakFileIndex[pakFiles[k].fileName] = k;
+        s_pakFilesRemaining.AddItem(k, pakFiles[k].fileName, EstimateEvaluationCost(pakFiles[k].fileName, fitWindowsPerChannel));
+    }
+    s_nFilesToProcess = (long)pakFiles.size();
+
+    // Keep the user informed about what we're doing
+    messageToUser.Format("%ld spectrum files found. Begin evaluation using %d threads.", s_nFilesToProcess, g_userSettings.m_maxThreadNum);
+    ShowMessage(messageToUser);
+
+    // 2. Start the evaluation threads. These hands over the evaluated scans to this thread
+    //  through a bounded queue, such that the evaluations can't run too far ahead of the calculations.
+    novac::BoundedQueue<EvaluatedPakFile> evaluatedPakFiles(4 * g_userSettings.m_maxThreadNum);
+    g_summaryFiles.Start();
+    g_plumeSpectrumArchiver.Start(s_plumeSpectrumArchivingThreads);
+    Evaluation::CScanEvaluation::ResetIdleThreads();
+    std::vector<std::thread> evalThreads(g_userSettings.m_maxThreadNum);
+    for (unsigned int threadIdx = 0; threadIdx < g_userSettings.m_maxThreadNum; ++threadIdx)
+    {
+        std::thread t{ EvaluateScansThread, (size_t)threadIdx, &evaluatedPakFiles };
+        evalThreads[threadIdx] = std::move(t);
+    }
+
+    // the queue is closed when all evaluation threads are done
+    std::thread evaluationMonitor{ [&evalThreads, &evaluatedPakFiles]() {
+        for (std::thread& t : evalThreads)
+        {
+            t.join();
+        }
+        g_summaryFiles.Stop();
+        g_plumeSpectrumArchiver.Stop();
+        evaluatedPakFiles.Close();
+    } };
+
+    // 3. Run the calculations as the scans are being evaluated. The evaluated scans are kept sorted in order
+    //  of increasing start time and each of the calculations is done for the scans in order.
+    //  A calculation is only made on a scan once all the data it depends on is complete, this makes
+    //  the result identical to running the calculations after all evaluations are done.
+    std::vector<Evaluation::CExtendedScanResult> scans;
+    size_t nGeometriesDone = 0;
+    size_t nDualBeamDone = 0;
+    size_t nFluxesDone = 0;
+    size_t firstRemainingPakFile = 0;
+    novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> calculatedFluxes;
+
+    // the geometry calculations use the plume heights as they were before any geometries were calculated
+    const Geometry::CPlumeDataBase initialPlumeDataBase = m_plumeDataBase;
+
+    // the wind field is rebuilt once all calculations are done, starting from the wind field read from file
+    const Meteorology::CWindDataBase initialWindDataBase = m_windDataBase;
+    std::vector<DualBeamWindSpeed> dualBeamWindSpeeds;
+    int nWindMeasFound = 0;
+
+    ShowMessage("Begin to calculate plume heights from scans");
+
+    std::vector<EvaluatedPakFile> evaluatedBatch;
+    bool evaluationsDone = false;
+    while (!evaluationsDone)
+    {
+        // 3a. Wait for the next evaluated scan and collect all others which are done
+        if (evaluatedPakFiles.PopBatch(evaluatedBatch, evaluatedPakFiles.Capacity()) > 0)
+        {
+            for (EvaluatedPakFile& evaluatedPakFile : evaluatedBatch)
+            {
+                auto index = pakFileIndex.find(evaluatedPakFile.pakFile);
+                if (index != pakFileIndex.end())
+                {
+                    pakFiles[index->second].evaluated = true;
+                }
+
+                if (evaluatedPakFile.succeeded)
+                {
+                    auto insertPosition = std::upper_bound(begin(scans), end(scans), evaluatedPakFile.result, byStartTime);
+                    if (insertPosition < begin(scans) + nGeometriesDone)
+                    {
+                        // this should not happen unless the start time of the scan differs very much from the name of the .pak-file
+                        messageToUser.Format("Scan %s was evaluated after the geometries for its start time were calculated", evaluatedPakFile.pakFile.c_str());
+                        ShowMessage(messageToUser);
+                        insertPosition = begin(scans) + nGeometriesDone;
+                    }
+                    scans.insert(insertPosition, std::move(evaluatedPakFile.result));
+                }
+            }
+        }
+        else
+        {
+            evaluationsDone = true;
+        }
+
+        // 3b. All scans which starts before 'evaluatedUntil' have now been evaluated.
+        while (firstRemainingPakFile < pakFiles.size() && pakFiles[firstRemainingPakFile].evaluated)
+        {
+            ++firstRemainingPakFile;
+        }
+        const bool allEvaluated = evaluationsDone || (firstRemainingPakFile == pakFiles.size());
+        CDateTime evaluatedUntil = endOfTime;
+        if (!allEvaluated)
+        {
+            evaluatedUntil = pakFiles[firstRemainingPakFile].startTime;
+            evaluatedUntil.Decrement(startTimeMargin);
+        }
+
+        // 3c. The geometries can be calculated for a scan once all scans it may be combined with have been evaluated.
+        size_t nGeometriesReady = nGeometriesDone;
+        while (nGeometriesReady < scans.size() &&
+            (allEvaluated || (nGeometriesReady + 1 < scans.size() && CDateTime::Difference(evaluatedUntil, scans[nGeometriesReady].m_startTime) > g_userSettings.m_calcGeometry_MaxTimeDifference)))
+        {
+            ++nGeometriesReady;
+        }
+        if (nGeometriesReady > nGeometriesDone)
+        {
+            // the scans to calculate the geometries for, followed by all scans they may be combined with
+            //  and the scan after that (which tells that the last scan to calculate the geometry for isn't the last scan).
+            size_t windowEnd = nGeometriesReady;
+            while (windowEnd < scans.size() && CDateTime::Difference(scans[windowEnd].m_startTime, scans[nGeometriesReady - 1].m_startTime) <= g_userSettings.m_calcGeometry_MaxTimeDifference)
+            {
+                ++windowEnd;
+            }
+            windowEnd = std::min(windowEnd + 1, scans.size());
+
+            novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> window;
+            for (size_t k = nGeometriesDone; k < windowEnd; ++k)
+            {
+                window.AddTail(scans[k]);
+            }
+
+            const int nOldGeometryResults = geometryResults.GetCount();
+            CalculateGeometries(initialPlumeDataBase, window, (int)(nGeometriesReady - nGeometriesDone), geometryResults);
+            nGeometriesDone = nGeometriesReady;
+
+            // Insert the new geometries into the plume height database
+            novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> newGeometryResults;
+            newGeometryResults.Reserve(geometryResults.GetCount() - nOldGeometryResults);
+            for (int k = nOldGeometryResults; k < geometryResults.GetCount(); ++k)
+            {
+                newGeometryResults.AddTail(geometryResults.GetAt(k));
+            }
+            InsertCalculatedGeometriesIntoDataBase(newGeometryResults);
+        }
+        const CDateTime geometriesUntil = (nGeometriesDone < scans.size()) ? earliest(scans[nGeometriesDone].m_startTime, evaluatedUntil) : evaluatedUntil;
+
+        // 3d. The dual-beam wind speeds can be calculated once all plume heights valid at the time of the scan are known.
+        size_t nDualBeamReady = nDualBeamDone;
+        while (nDualBeamReady < nGeometriesDone && CDateTime::Difference(geometriesUntil, scans[nDualBeamReady].m_startTime) > g_userSettings.m_calcGeometryValidTime)
+        {
+            ++nDualBeamReady;
+        }
+        if (nDualBeamReady > nDualBeamDone)
+        {
+            novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> dualBeamScans;
+            for (size_t k = nDualBeamDone; k < nDualBeamReady; ++k)
+            {
+                dualBeamScans.AddTail(scans[k]);
+            }
+            const size_t nOldWindSpeeds = dualBeamWindSpeeds.size();
+            nWindMeasFound += CalculateDualBeamWindSpeeds(dualBeamScans, dualBeamWindSpeeds);
+            nDualBeamDone = nDualBeamReady;
+
+            // Insert the new wind speeds into the wind database, these are reported to the user at the end
+            for (size_t k = nOldWindSpeeds; k < dualBeamWindSpeeds.size(); ++k)
+            {
+                InsertDualBeamWindSpeed(dualBeamWindSpeeds[k]);
+            }
+        }
+        const CDateTime dualBeamUntil = (nDualBeamDone < scans.size()) ? earliest(scans[nDualBeamDone].m_startTime, geometriesUntil) : geometriesUntil;
+
+        // 3e. The fluxes can be calculated once all plume heights, wind directions and wind speeds valid at the time of the scan are known.
+        size_t nFluxesReady = nFluxesDone;
+        while (nFluxesReady < nDualBeamDone &&
+            CDateTime::Difference(geometriesUntil, scans[nFluxesReady].m_startTime) > g_userSettings.m_calcGeometryValidTime &&
+            CDateTime::Difference(dualBeamUntil, scans[nFluxesReady].m_startTime) > g_userSettings.m_dualBeam_ValidTime)
+        {
+            ++nFluxesReady;
+        }
+        if (nFluxesReady > nFluxesDone)
+        {
+            novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> fluxScans;
+            for (size_t k = nFluxesDone; k < nFluxesReady; ++k)
+            {
+                fluxScans.AddTail(scans[k]);
+            }
+            CalculateFluxes(fluxScans, calculatedFluxes);
+            nFluxesDone = nFluxesReady;
+        }
+    }
+
+    evaluationMonitor.join();
+
+    messageToUser.Format("All %ld scans evaluated.", s_nFilesToProcess);
+    ShowMessage(messageToUser);
+
+    // Tell the user what we have done
+    if (geometryResults.GetCount() == 0)
+    {
+        ShowMessage("No plume heights could be calculated");
+    }
+    else
+    {
+        messageToUser.Format("Done calculating geometries. Plume height calculated on %d occasions", geometryResults.GetCount());
+        ShowMessage(messageToUser);
+    }
+
+    // The wind directions and wind speeds were inserted into the wind field batch by batch. Rebuild it in the
+    //  order they are inserted when not pipelined, first all wind directions and then all dual-beam wind speeds
+    //  with the measurements from the Heidelberg instruments first, such that GeneratedWindField.wxml is the same.
+    std::stable_partition(begin(dualBeamWindSpeeds), end(dualBeamWindSpeeds), [](const DualBeamWindSpeed& w) { return w.heidelberg; });
+    m_windDataBase = initialWindDataBase;
+    InsertCalculatedWindDirectionsIntoDataBase(geometryResults);
+    WriteDualBeamWindSpeeds(nWindMeasFound, dualBeamWindSpeeds);
+
+    // 4. Write the fluxes to file and copy out the sorted list of evaluated scans
+    WriteFluxResults(calculatedFluxes);
+
+    for (const Evaluation::CExtendedScanResult& scan : scans)
+    {
+        evalLogFiles.AddTail(scan);
+    }
+}
+
+void EvaluateScansThread(size_t threadIndex, novac::BoundedQueue<EvaluatedPakFile>* evaluatedPakFiles)
 {
     std::string fileName;
 
@@ -336,27 +742,30 @@ void EvaluateScansThread()
     Evaluation::CPostEvaluationController eval;
 
     // while there are more .pak-files
-    while (s_pakFilesRemaining.PopFront(fileName))
+    while (s_pakFilesRemaining.PopFront(threadIndex, fileName))
     {
         novac::CString evalLog[MAX_FIT_WINDOWS];
         CPlumeInScanProperty scanProperties[MAX_FIT_WINDOWS];
+        std::shared_ptr<const Evaluation::CScanResult> scanResults[MAX_FIT_WINDOWS];
 
         // evaluate the .pak-file in all the specified fit-windows and retrieve the name of the 
         // eval-logs. If any of the fit-windows fails then the scan is not inserted.
-        bool evaluationSucceeded = true;
-        for (int fitWindowIndex = 0; fitWindowIndex < g_userSettings.m_nFitWindowsToUse; ++fitWindowIndex)
-        {
-            if (0 != eval.EvaluateScan(fileName, g_userSettings.m_fitWindowsToUse[fitWindowIndex], &evalLog[fitWindowIndex], &scanProperties[fitWindowIndex]))
-            {
-                evaluationSucceeded = false;
-                break;
-            }
-        }
+        const bool evaluationSucceeded = (0 == eval.EvaluateScan(fileName, g_userSettings.m_fitWindowsToUse, g_userSettings.m_nFitWindowsToUse, evalLog, scanProperties,
+            g_userSettings.m_keepScanResultsInMemory ? scanResults : nullptr));
+
+        EvaluatedPakFile evaluatedPakFile;
+        evaluatedPakFile.pakFile = fileName;
+        evaluatedPakFile.succeeded = evaluationSucceeded;
 
         if (evaluationSucceeded)
         {
             // If we made it this far then the measurement is ok, insert it into the list!
-            AddResultToList(fileName, evalLog, scanProperties[g_userSettings.m_mainFitWindow]);
+            evaluatedPakFile.result = CreateEvaluationResult(fileName, evalLog, scanProperties[g_userSettings.m_mainFitWindow]);
+            evaluatedPakFile.result.m_scanResult = scanResults[g_userSettings.m_mainFitWindow];
+            if (evaluatedPakFiles == nullptr)
+            {
+                s_evalLogs.AddItem(evaluatedPakFile.result);
+            }
 
             // Tell the user what is happening
             novac::CString messageToUser;
@@ -369,17 +778,95 @@ void EvaluateScansThread()
             messageToUser.Format(" - Evaluation of scan %s failed", fileName.c_str());
             ShowMessage(messageToUser);
         }
+
+        // the pipeline needs to know about the failed evaluations as well, to know when all
+        //  scans in a given time range have been evaluated.
+        if (evaluatedPakFiles != nullptr)
+        {
+            evaluatedPakFiles->Push(std::move(evaluatedPakFile));
+        }
+    }
+
+    // the scans still being evaluated by the other threads may use this thread's share of the processors
+    Evaluation::CScanEvaluation::AddIdleThread();
+}
+
+double EstimateEvaluationCost(const std::string& pakFile, std::map<std::string, int>& fitWindowsPerChannel)
+{
+    double fileSize = 1.0;
+    CDateTime startTime;
+    novac::CString serial;
+    int channel;
+    MEASUREMENT_MODE mode;
+
+    // use the size, serial and channel from the catalog of .pak-files if the file is there
+    FileHandler::CPakFileCatalog::Entry catalogEntry;
+    if (g_pakFileCatalog.Find(pakFile, catalogEntry))
+    {
+        fileSize = (double)std::max(catalogEntry.size, 1LL);
+        serial = novac::CString(catalogEntry.serial);
+        channel = catalogEntry.channel;
+    }
+    else
+    {
+        try
+        {
+            novac::CString fileName(pakFile);
+            fileSize = (double)std::max(Common::RetrieveFileSize(fileName), 1L);
+        }
+        catch (Poco::Exception&)
+        {
+            // the file will fail quickly in the evaluation anyway
+        }
+
+        if (!novac::CFileUtils::GetInfoFromFileName(novac::CString(pakFile), startTime, serial, channel, mode))
+        {
+            return fileSize;
+        }
+    }
+
+    // Count the number of fit-windows to use which are configured for this instrument and channel.
+    //  The evaluation stops at the first fit-window which cannot be found.
+    novac::CString key;
+    key.Format("%s_%d", (const char*)serial, channel % 16);
+    auto cached = fitWindowsPerChannel.find(key.std_str());
+    if (cached == fitWindowsPerChannel.end())
+    {
+        int nFitWindows = 0;
+        const Configuration::CInstrumentConfiguration* instrumentConf = g_setup.GetInstrument(serial);
+        if (instrumentConf != nullptr)
+        {
+            const Configuration::CEvaluationConfiguration& evalConf = instrumentConf->m_eval;
+            Evaluation::CFitWindow window;
+            CDateTime validFrom, validTo;
+            for (nFitWindows = 0; nFitWindows < g_userSettings.m_nFitWindowsToUse; ++nFitWindows)
+            {
+                bool found = false;
+                for (unsigned int k = 0; k < evalConf.GetFitWindowNum() && !found; ++k)
+                {
+                    evalConf.GetFitWindow(k, window, validFrom, validTo);
+                    found = (window.channel == channel % 16) && Equals(window.name, g_userSettings.m_fitWindowsToUse[nFitWindows]);
+                }
+                if (!found)
+                {
+                    break;
+                }
+            }
+        }
+        cached = fitWindowsPerChannel.insert(std::make_pair(key.std_str(), std::max(nFitWindows, 1))).first;
     }
+
+    return fileSize * cached->second;
 }
 
-void AddResultToList(const novac::CString &pakFileName, const novac::CString(&evalLog)[MAX_FIT_WINDOWS], const CPlumeInScanProperty &scanProperties)
+Evaluation::CExtendedScanResult CreateEvaluationResult(const novac::CString &pakFileName, const novac::CString(&evalLog)[MAX_FIT_WINDOWS], const CPlumeInScanProperty &scanProperties)
 {
     // these are not used...
     novac::CString serial;
     int channel;
     MEASUREMENT_MODE mode;
 
-    // Create a new Extended scan result and add it to the end of the list
+    // Create a new Extended scan result
     Evaluation::CExtendedScanResult newResult;
     newResult.m_pakFile.Format(pakFileName);
     for (int fitWindowIndex = 0; fitWindowIndex < g_userSettings.m_nFitWindowsToUse; ++fitWindowIndex)
@@ -390,11 +877,10 @@ void AddResultToList(const novac::CString &pakFileName, const novac::CString(&ev
     novac::CFileUtils::GetInfoFromFileName(evalLog[0], newResult.m_startTime, serial, channel, mode);
     newResult.m_scanProperties = scanProperties;
 
-    // store the name of the evaluation-log file generated
-    s_evalLogs.AddItem(newResult);
-
     // update the statistics
     g_processingStats.InsertAcception(serial);
+
+    return newResult;
 }
 
 int CPostProcessing::CheckSettings()
@@ -795,43 +1281,82 @@ int CPostProcessing::PreparePlumeHeights()
     return 0;
 }
 
-void CPostProcessing::CalculateGeometries(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult&> &evalLogFiles, novac::CList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
+void CPostProcessing::CalculateGeometries(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult&> &evalLogFiles, novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
 {
-    novac::CString serial1, serial2, messageToUser;
-    CDateTime startTime1, startTime2;
-    MEASUREMENT_MODE measMode1, measMode2;
-    int channel;
-    unsigned long nFilesChecked1 = 0; // this is for debugging purposes...
-    unsigned long nFilesChecked2 = 0; // this is for debugging purposes...
-    unsigned long nCalculationsMade = 0; // this is for debugging purposes...
-    unsigned long nTooLongdistance = 0; // this is for debugging purposes...
-    unsigned long nTooLargeAbsoluteError = 0; // this is for debugging purposes...
-    unsigned long nTooLargeRelativeError = 0; // this is for debugging purposes...
-    Configuration::CInstrumentLocation location[2];
+    novac::CString messageToUser;
 
     // Tell the user what's happening
     ShowMessage("Begin to calculate plume heights from scans");
 
-    // Loop through list with output text files from evaluation and apply geometrical corrections
-    auto pos1 = evalLogFiles.GetHeadPosition();
-    while (pos1 != nullptr)
+    CalculateGeometries(m_plumeDataBase, evalLogFiles, evalLogFiles.GetCount(), geometryResults);
+
+    // Tell the user what we have done
+    if (geometryResults.GetCount() == 0)
+    {
+        ShowMessage("No plume heights could be calculated");
+    }
+    else
+    {
+        messageToUser.Format("Done calculating geometries. Plume height calculated on %d occasions", geometryResults.GetCount());
+        ShowMessage(messageToUser);
+    }
+}
+
+void CPostProcessing::CalculateGeometries(const Geometry::CPlumeDataBase &plumeDataBase, novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult&> &evalLogFiles, int nScansToCombine, novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
+{
+    novac::CString messageToUser;
+    std::atomic<unsigned long> nFilesChecked2{ 0 }; // this is for debugging purposes...
+    std::atomic<unsigned long> nCalculationsMade{ 0 }; // this is for debugging purposes...
+    std::atomic<unsigned long> nTooLongdistance{ 0 }; // this is for debugging purposes...
+    std::atomic<unsigned long> nTooLargeAbsoluteError{ 0 }; // this is for debugging purposes...
+    std::atomic<unsigned long> nTooLargeRelativeError{ 0 }; // this is for debugging purposes...
+
+    std::vector<const Evaluation::CExtendedScanResult*> scans;
+    auto pos = evalLogFiles.GetHeadPosition();
+    while (pos != nullptr)
     {
-        const novac::CString &evalLog1 = evalLogFiles.GetAt(pos1).m_evalLogFile[g_userSettings.m_mainFitWindow];
-        const CPlumeInScanProperty &plume1 = evalLogFiles.GetNext(pos1).m_scanProperties;
+        scans.push_back(&evalLogFiles.GetNext(pos));
+    }
 
-        ++nFilesChecked1; // for debugging...
+    // The last file in the list cannot be combined with anything
+    const size_t nFilesChecked1 = std::min((size_t)std::max(nScansToCombine, 0), scans.size()); // this is for debugging purposes...
+    const size_t nFirstScans = std::min(nFilesChecked1, (scans.size() > 0) ? scans.size() - 1 : 0);
 
-        // if this is the last file in the list, then
-        // quit. There's nothing more to compare to...
-        if (pos1 == nullptr)
-        {
-            break;
-        }
+    // The results of the calculations made with each scan as the first scan, these are
+    //  inserted into 'geometryResults' in the order of the scans.
+    struct ScanGeometries
+    {
+        // the results of combining this scan with the following scans
+        std::vector<Geometry::CGeometryResult*> combinedResults;
+
+        // set if a wind direction should be calculated from this scan alone
+        bool calculateWindDirection = false;
+        novac::CString serial;
+        CDateTime startTime;
+        Configuration::CInstrumentLocation location;
+        Geometry::CPlumeHeight plumeHeight;
+        Geometry::CGeometryResult *windDirectionResult = nullptr;
+    };
+    std::vector<ScanGeometries> scanGeometries(nFirstScans);
+
+    // 1. Try to combine each scan with every following scan from another instrument. This is done in parallel, 
+    //  each pair of scans is only combined with the first scan of the pair.
+    auto combineScans = [&](size_t index1)
+    {
+        ScanGeometries& geometries = scanGeometries[index1];
+        novac::CString serial1, serial2;
+        CDateTime startTime1, startTime2;
+        MEASUREMENT_MODE measMode1, measMode2;
+        int channel;
+        Configuration::CInstrumentLocation location[2];
+
+        const novac::CString &evalLog1 = scans[index1]->m_evalLogFile[g_userSettings.m_mainFitWindow];
+        const CPlumeInScanProperty &plume1 = scans[index1]->m_scanProperties;
 
         // if this scan does not see a large enough portion of the plume, then ignore it...
         if (plume1.completeness < g_userSettings.m_calcGeometry_CompletenessLimit)
         {
-            continue;
+            return;
         }
 
         //  Get the information about evaluation log file #1
@@ -840,20 +1365,17 @@ void CPostProcessing::CalculateGeometries(novac::CList <Evaluation::CExtendedSca
         // If this is not a flux-measurement, then there's no use in trying to use it...
         if (measMode1 != MODE_FLUX)
         {
-            continue;
+            return;
         }
 
         // try to combine this evaluation-log file with every other eval-log
         //  use the fact that the list of eval-logs is sorted by increasing start-time
         //  thus we start at the eval-log next after this one and compare with all
         //  eval-logs until the difference in start-time is too big.
-        auto pos2 = pos1;
-        evalLogFiles.GetNext(pos2);
-        bool successfullyCombined = false; // this is true if evalLog1 was combined with (at least one) other eval-log to make a geomery calculation.
-        while (pos2 != nullptr)
+        for (size_t index2 = index1 + 1; index2 < scans.size(); ++index2)
         {
-            const novac::CString &evalLog2 = evalLogFiles.GetAt(pos2).m_evalLogFile[g_userSettings.m_mainFitWindow];
-            const CPlumeInScanProperty &plume2 = evalLogFiles.GetNext(pos2).m_scanProperties;
+            const novac::CString &evalLog2 = scans[index2]->m_evalLogFile[g_userSettings.m_mainFitWindow];
+            const CPlumeInScanProperty &plume2 = scans[index2]->m_scanProperties;
 
             ++nFilesChecked2; // for debugging...
 
@@ -871,8 +1393,7 @@ void CPostProcessing::CalculateGeometries(novac::CList <Evaluation::CExtendedSca
             double timeDifference = fabs(CDateTime::Difference(startTime1, startTime2));
             if (timeDifference > g_userSettings.m_calcGeometry_MaxTimeDifference)
             {
-                pos2 = nullptr;
-                continue;
+                break;
             }
 
             // If this is not a flux-measurement, then there's no use in trying to use it...
@@ -930,13 +1451,7 @@ void CPostProcessing::CalculateGeometries(novac::CList <Evaluation::CExtendedSca
                     result->m_instr1.Format(serial1);
                     result->m_instr2.Format(serial2);
 
-                    geometryResults.AddTail(result);
-
-                    messageToUser.Format(" + Calculated a plume altitude of %.0lf +- %.0lf meters and wind direction of %.0lf +- %.0lf degrees by combining measurements from %s and %s",
-                        result->m_plumeAltitude, result->m_plumeAltitudeError, result->m_windDirection, result->m_windDirectionError, (const char*)serial1, (const char*)serial2);
-                    ShowMessage(messageToUser);
-
-                    successfullyCombined = true;
+                    geometries.combinedResults.push_back(result);
                 }
             }
             else
@@ -944,98 +1459,184 @@ void CPostProcessing::CalculateGeometries(novac::CList <Evaluation::CExtendedSca
                 // something went wrong... delete the 'info'
                 delete result;
             }
-        } // end while(pos2 != nullptr)
+        } // end for (index2...)
 
         // if it was not possible to combine this scan with any other to generate an
         // estimated plume height and wind direction we might still be able to use it to calculate
         // a wind direction given the plume height at the time of the measurement.
-        if (!successfullyCombined)
+        if (geometries.combinedResults.size() == 0)
         {
-            Meteorology::CWindField windField;
-            Geometry::CPlumeHeight plumeHeight;
-
             // Get the location of the instrument
-            if (g_setup.GetInstrumentLocation(serial1, startTime1, location[0]))
-                continue;
+            if (g_setup.GetInstrumentLocation(serial1, startTime1, geometries.location))
+                return;
 
-            Geometry::CGeometryResult *result = new Geometry::CGeometryResult();
+            geometries.calculateWindDirection = true;
+            geometries.serial = serial1;
+            geometries.startTime = startTime1;
+        }
+    };
+
+    // 2. Calculate the wind direction from the scans which could not be combined with any other scan
+    auto calculateWindDirection = [&](size_t index1)
+    {
+        ScanGeometries& geometries = scanGeometries[index1];
+        if (!geometries.calculateWindDirection)
+        {
+            return;
+        }
+
+        const Evaluation::CScanResult *scanResult1 = scans[index1]->m_scanResult.get();
+        const novac::CString &evalLog1 = scans[index1]->m_evalLogFile[g_userSettings.m_mainFitWindow];
 
-            // Get the altitude of the plume at this moment. First look into the
-            // general database. Then have a look in the list of geometry-results
-            // that we just generated to see if there's anything better there...
-            m_plumeDataBase.GetPlumeHeight(startTime1, plumeHeight);
-            auto gp = geometryResults.GetTailPosition();
-            while (gp != nullptr)
+        Geometry::CGeometryResult *result = new Geometry::CGeometryResult();
+        const bool windDirectionCalculated = (scanResult1 != nullptr) ?
+            Geometry::CGeometryCalculator::CalculateWindDirection(*scanResult1, geometries.plumeHeight, geometries.location, *result) :
+            Geometry::CGeometryCalculator::CalculateWindDirection(evalLog1, 0, geometries.plumeHeight, geometries.location, *result);
+        if (windDirectionCalculated)
+        {
+            result->m_instr1.Format(geometries.serial);
+            geometries.windDirectionResult = result;
+        }
+        else
+        {
+            delete result;
+        }
+    };
+
+    auto runInParallel = [&](std::function<void(size_t)> calculation)
+    {
+        std::atomic<size_t> nextScan{ 0 };
+        auto runCalculations = [&]()
+        {
+            size_t k;
+            while ((k = nextScan++) < nFirstScans)
             {
-                const Geometry::CGeometryResult *oldResult = geometryResults.GetPrev(gp);
-                if (fabs(CDateTime::Difference(oldResult->m_averageStartTime, startTime1)) < g_userSettings.m_calcGeometryValidTime)
-                {
-                    if ((oldResult->m_plumeAltitudeError < plumeHeight.m_plumeAltitudeError) && (oldResult->m_plumeAltitude > NOT_A_NUMBER))
-                    {
-                        plumeHeight.m_plumeAltitude = oldResult->m_plumeAltitude;
-                        plumeHeight.m_plumeAltitudeError = oldResult->m_plumeAltitudeError;
-                        plumeHeight.m_plumeAltitudeSource = oldResult->m_calculationType;
-                    }
-                }
+                calculation(k);
             }
+        };
 
-            // Try to calculate the wind-direction
-            if (Geometry::CGeometryCalculator::CalculateWindDirection(evalLog1, 0, plumeHeight, location[0], *result))
-            {
-                // Success!!
-                result->m_instr1.Format(serial1);
-                geometryResults.AddTail(result);
+        const size_t nThreads = std::min((size_t)g_userSettings.m_maxThreadNum, nFirstScans);
+        std::vector<std::thread> threads;
+        for (size_t threadIdx = 1; threadIdx < nThreads; ++threadIdx)
+        {
+            threads.push_back(std::thread(runCalculations));
+        }
+        runCalculations();
+        for (std::thread& t : threads)
+        {
+            t.join();
+        }
+    };
 
-                // tell the user   
-                messageToUser.Format(" + Calculated a wind direction of %.0lf +- %.0lf degrees from a scan by instrument %s",
-                    result->m_windDirection, result->m_windDirectionError, (const char*)serial1);
-                ShowMessage(messageToUser);
-            }
-            else
+    runInParallel(combineScans);
+
+    // Get the altitude of the plume at the time of each scan which needs a wind direction. First look into the
+    //  general database. Then have a look in the geometry-results from the scans before this one to see if
+    //  there's anything better there, starting with the latest result.
+    auto useIfBetter = [](const Geometry::CGeometryResult *oldResult, const CDateTime &startTime, Geometry::CPlumeHeight &plumeHeight)
+    {
+        if (fabs(CDateTime::Difference(oldResult->m_averageStartTime, startTime)) < g_userSettings.m_calcGeometryValidTime)
+        {
+            if ((oldResult->m_plumeAltitudeError < plumeHeight.m_plumeAltitudeError) && (oldResult->m_plumeAltitude > NOT_A_NUMBER))
             {
-                delete result;
-                continue;
+                plumeHeight.m_plumeAltitude = oldResult->m_plumeAltitude;
+                plumeHeight.m_plumeAltitudeError = oldResult->m_plumeAltitudeError;
+                plumeHeight.m_plumeAltitudeSource = oldResult->m_calculationType;
             }
         }
-    } // end while(pos1 != nullptr)
-
-    // Tell the user what we have done
-    if (geometryResults.GetCount() == 0)
+    };
+    for (size_t index1 = 0; index1 < nFirstScans; ++index1)
     {
-        ShowMessage("No plume heights could be calculated");
+        ScanGeometries& geometries = scanGeometries[index1];
+        if (!geometries.calculateWindDirection)
+        {
+            continue;
+        }
+
+        plumeDataBase.GetPlumeHeight(geometries.startTime, geometries.plumeHeight);
+        for (size_t k = index1; k > 0; --k)
+        {
+            const std::vector<Geometry::CGeometryResult*>& previousResults = scanGeometries[k - 1].combinedResults;
+            for (auto it = previousResults.rbegin(); it != previousResults.rend(); ++it)
+            {
+                useIfBetter(*it, geometries.startTime, geometries.plumeHeight);
+            }
+        }
+        auto gp = geometryResults.GetTailPosition();
+        while (gp != nullptr)
+        {
+            useIfBetter(geometryResults.GetPrev(gp), geometries.startTime, geometries.plumeHeight);
+        }
     }
-    else
+
+    runInParallel(calculateWindDirection);
+
+    // 3. Insert the results in the order of the scans
+    for (size_t index1 = 0; index1 < nFirstScans; ++index1)
     {
-        messageToUser.Format("Done calculating geometries. Plume height calculated on %d occasions", geometryResults.GetCount());
-        ShowMessage(messageToUser);
+        ScanGeometries& geometries = scanGeometries[index1];
+        for (Geometry::CGeometryResult *result : geometries.combinedResults)
+        {
+            geometryResults.AddTail(result);
+
+            messageToUser.Format(" + Calculated a plume altitude of %.0lf +- %.0lf meters and wind direction of %.0lf +- %.0lf degrees by combining measurements from %s and %s",
+                result->m_plumeAltitude, result->m_plumeAltitudeError, result->m_windDirection, result->m_windDirectionError, (const char*)result->m_instr1, (const char*)result->m_instr2);
+            ShowMessage(messageToUser);
+        }
+
+        if (geometries.windDirectionResult != nullptr)
+        {
+            geometryResults.AddTail(geometries.windDirectionResult);
+
+            // tell the user   
+            messageToUser.Format(" + Calculated a wind direction of %.0lf +- %.0lf degrees from a scan by instrument %s",
+                geometries.windDirectionResult->m_windDirection, geometries.windDirectionResult->m_windDirectionError, (const char*)geometries.serial);
+            ShowMessage(messageToUser);
+        }
     }
-    messageToUser.Format("nFilesChecked1 = %ld, nFilesChecked2 = %ld, nCalculationsMade = %ld", nFilesChecked1, nFilesChecked2, nCalculationsMade);
+
+    messageToUser.Format("nFilesChecked1 = %ld, nFilesChecked2 = %ld, nCalculationsMade = %ld", (unsigned long)nFilesChecked1, (unsigned long)nFilesChecked2, (unsigned long)nCalculationsMade);
     ShowMessage(messageToUser);
 }
 
 void CPostProcessing::CalculateFluxes(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogFiles)
+{
+    // we keep the calculated fluxes in a list
+    novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> calculatedFluxes;
+
+    CalculateFluxes(evalLogFiles, calculatedFluxes);
+
+    WriteFluxResults(calculatedFluxes);
+}
+
+void CPostProcessing::CalculateFluxes(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogFiles, novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes)
 {
     CDateTime scanStartTime;
     novac::CString serial, messageToUser;
-    Geometry::CPlumeHeight plumeHeight; // the altitude of the plume, in meters above sea level
     MEASUREMENT_MODE measMode;
     int channel;
-    Flux::CFluxStatistics stat;
-
-    // we keep the calculated fluxes in a list
-    novac::CList <Flux::CFluxResult, Flux::CFluxResult &> calculatedFluxes;
 
-    // Initiate the flux-calculator
-    Flux::CFluxCalculator fluxCalc;
+    // The flux of each scan is calculated independently of the other scans, the calculations
+    //  are therefore spread out over several threads. The results are kept in the same order as the scans.
+    struct FluxCalculation
+    {
+        novac::CString evalLog;
+        const Evaluation::CScanResult *scanResult = nullptr;
+        Geometry::CPlumeHeight plumeHeight; // the altitude of the plume, in meters above sea level
+        bool succeeded = false;
+        Flux::CFluxResult fluxResult;
+    };
+    std::vector<FluxCalculation> calculations;
 
     // Loop through the list of evaluation log files. For each of them, find
-    // the best available wind-speed, wind-direction and plume height and
-    // calculate the flux.
+    // the best available plume height. The wind-speed and wind-direction are
+    // found by the flux-calculator.
     auto pos = evalLogFiles.GetHeadPosition();
     while (pos != nullptr)
     {
         // Get the name of this eval-log
         const novac::CString &evalLog = evalLogFiles.GetAt(pos).m_evalLogFile[g_userSettings.m_mainFitWindow];
+        const Evaluation::CScanResult *scanResult = evalLogFiles.GetAt(pos).m_scanResult.get();
         const CPlumeInScanProperty &plume = evalLogFiles.GetNext(pos).m_scanProperties;
 
         // if the completeness is too low then ignore this scan.
@@ -1053,21 +1654,61 @@ void CPostProcessing::CalculateFluxes(novac::CList <Evaluation::CExtendedScanRes
         if (measMode != MODE_FLUX)
             continue;
 
+        FluxCalculation calculation;
+        calculation.evalLog = evalLog;
+        calculation.scanResult = scanResult;
+
         // Extract a plume height at this time of day
-        m_plumeDataBase.GetPlumeHeight(scanStartTime, plumeHeight);
+        m_plumeDataBase.GetPlumeHeight(scanStartTime, calculation.plumeHeight);
 
-        // tell the user
-        messageToUser.Format("Calculating flux for measurement %s", (const char*)evalLog);
-        ShowMessage(messageToUser);
+        calculations.push_back(calculation);
+    }
 
-        // Calculate the flux. This also takes care of writing
-        // the results to file
-        Flux::CFluxResult fluxResult;
-        if (0 == fluxCalc.CalculateFlux(evalLog, m_windDataBase, plumeHeight, fluxResult))
+    // Calculate the fluxes. Each thread uses its own flux-calculator and takes the next scan
+    //  until there are no more.
+    std::atomic<size_t> nextCalculation{ 0 };
+    auto calculateFluxes = [this, &calculations, &nextCalculation]()
+    {
+        Flux::CFluxCalculator fluxCalc;
+        size_t k;
+        while ((k = nextCalculation++) < calculations.size())
+        {
+            FluxCalculation& calculation = calculations[k];
+
+            // tell the user
+            novac::CString message;
+            message.Format("Calculating flux for measurement %s", (const char*)calculation.evalLog);
+            ShowMessage(message);
+
+            calculation.succeeded = (0 == fluxCalc.CalculateFlux(calculation.evalLog, calculation.scanResult, m_windDataBase, calculation.plumeHeight, calculation.fluxResult));
+        }
+    };
+
+    const size_t nThreads = std::min((size_t)g_userSettings.m_maxThreadNum, calculations.size());
+    std::vector<std::thread> fluxThreads;
+    for (size_t threadIdx = 1; threadIdx < nThreads; ++threadIdx)
+    {
+        fluxThreads.push_back(std::thread(calculateFluxes));
+    }
+    calculateFluxes();
+    for (std::thread& t : fluxThreads)
+    {
+        t.join();
+    }
+
+    // Collect the results, in the order of the scans
+    for (const FluxCalculation& calculation : calculations)
+    {
+        if (calculation.succeeded)
         {
-            calculatedFluxes.AddTail(fluxResult);
+            calculatedFluxes.AddTail(calculation.fluxResult);
         }
     }
+}
+
+void CPostProcessing::WriteFluxResults(novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes)
+{
+    Flux::CFluxStatistics stat;
 
     // Now we can write the final fluxes to file
     ShowMessage("Writing flux log");
@@ -1083,7 +1724,7 @@ void CPostProcessing::CalculateFluxes(novac::CList <Evaluation::CExtendedScanRes
     stat.WriteFluxStat(fluxStatFileName);
 }
 
-void CPostProcessing::WriteFluxResult_XML(novac::CList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes)
+void CPostProcessing::WriteFluxResult_XML(novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes)
 {
     novac::CString fluxLogFile, styleFile, wsSrc, wdSrc, phSrc, typeStr;
     CDateTime now;
@@ -1235,7 +1876,7 @@ void CPostProcessing::WriteFluxResult_XML(novac::CList <Flux::CFluxResult, Flux:
     fclose(f);
 }
 
-void CPostProcessing::WriteFluxResult_Txt(novac::CList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes)
+void CPostProcessing::WriteFluxResult_Txt(novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes)
 {
     novac::CString fluxLogFile, wsSrc, wdSrc, phSrc, typeStr;
     CDateTime now;
@@ -1252,19 +1893,20 @@ void CPostProcessing::WriteFluxResult_Txt(novac::CList <Flux::CFluxResult, Flux:
         Common::ArchiveFile(fluxLogFile);
     }
 
-    FILE *f = fopen(fluxLogFile, "w");
-    if (f == nullptr)
+    // the flux log is uploaded to the FTP-server and is hence never compressed
+    FileHandler::CTextFileWriter f;
+    if (!f.Open(fluxLogFile.std_str(), false))
     {
         ShowMessage("Could not open flux log file for writing. Writing of results failed. ");
         return;
     }
 
     // Write the header and the starting comments
-    fprintf(f, "# This is result of the flux calculations the NOVAC Post Processing Program \n");
-    fprintf(f, "#   File generated on %04d.%02d.%02d at %02d:%02d:%02d \n\n", now.year, now.month, now.day, now.hour, now.minute, now.second);
+    f.Printf("# This is result of the flux calculations the NOVAC Post Processing Program \n");
+    f.Printf("#   File generated on %04d.%02d.%02d at %02d:%02d:%02d \n\n", now.year, now.month, now.day, now.hour, now.minute, now.second);
 
-    fprintf(f, "#StartTime\tStopTime\tSerial\tInstrumentType\tFlux_kgs\tFluxQuality\tFluxError_Wind_kgs\tFluxError_PlumeHeight_kgs\tWindSpeed_ms\tWindSpeedErr_ms\tWindSpeedSrc\tWindDir_deg\tWindDirErr_deg\tWindDirSrc\tPlumeHeight_m\tPlumeHeightErr_m\tPlumeHeightSrc\t");
-    fprintf(f, "Compass\tConeAngle\tTilt\tnSpectra\tPlumeCentre_1\tPlumeCentre_2\tPlumeCompleteness\tScanOffset\n");
+    f.Printf("#StartTime\tStopTime\tSerial\tInstrumentType\tFlux_kgs\tFluxQuality\tFluxError_Wind_kgs\tFluxError_PlumeHeight_kgs\tWindSpeed_ms\tWindSpeedErr_ms\tWindSpeedSrc\tWindDir_deg\tWindDirErr_deg\tWindDirSrc\tPlumeHeight_m\tPlumeHeightErr_m\tPlumeHeightSrc\t");
+    f.Printf("Compass\tConeAngle\tTilt\tnSpectra\tPlumeCentre_1\tPlumeCentre_2\tPlumeCompleteness\tScanOffset\n");
 
     auto pos = calculatedFluxes.GetHeadPosition();
     while (pos != nullptr)
@@ -1288,70 +1930,73 @@ void CPostProcessing::WriteFluxResult_Txt(novac::CList <Flux::CFluxResult, Flux:
         Meteorology::MetSourceToString(fluxResult.m_plumeHeight.m_plumeAltitudeSource, phSrc);
 
         // write the date and time when the measurement started and ended
-        fprintf(f, "%04d.%02d.%02dT%02d:%02d:%02d\t",
+        f.Printf("%04d.%02d.%02dT%02d:%02d:%02d\t",
             fluxResult.m_startTime.year, fluxResult.m_startTime.month, fluxResult.m_startTime.day,
             fluxResult.m_startTime.hour, fluxResult.m_startTime.minute, fluxResult.m_startTime.second);
-        fprintf(f, "%04d.%02d.%02dT%02d:%02d:%02d\t",
+        f.Printf("%04d.%02d.%02dT%02d:%02d:%02d\t",
             fluxResult.m_stopTime.year, fluxResult.m_stopTime.month, fluxResult.m_stopTime.day,
             fluxResult.m_stopTime.hour, fluxResult.m_stopTime.minute, fluxResult.m_stopTime.second);
 
         // the type of instrument and the serial-number
-        fprintf(f, "%s\t", (const char*)fluxResult.m_instrument);
-        fprintf(f, "%s\t", (const char*)typeStr);
+        f.Printf("%s\t", (const char*)fluxResult.m_instrument);
+        f.Printf("%s\t", (const char*)typeStr);
 
         // The actual flux!!!
-        fprintf(f, "%.2lf\t", fluxResult.m_flux);
+        f.Printf("%.2lf\t", fluxResult.m_flux);
 
         // The judged quality of the calculated flux
         if (fluxResult.m_fluxQualityFlag == FLUX_QUALITY_GREEN)
         {
-            fprintf(f, "g\t");
+            f.Printf("g\t");
         }
         else if (fluxResult.m_fluxQualityFlag == FLUX_QUALITY_YELLOW)
         {
-            fprintf(f, "y\t");
+            f.Printf("y\t");
         }
         else
         {
-            fprintf(f, "r\t");
+            f.Printf("r\t");
         }
 
         // the errors
-        fprintf(f, "%.2lf\t", fluxResult.m_fluxError_Wind);
-        fprintf(f, "%.2lf\t", fluxResult.m_fluxError_PlumeHeight);
+        f.Printf("%.2lf\t", fluxResult.m_fluxError_Wind);
+        f.Printf("%.2lf\t", fluxResult.m_fluxError_PlumeHeight);
 
         // the wind speed
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindSpeed());
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindSpeedError());
-        fprintf(f, "%s\t", (const char*)wsSrc);
+        f.Printf("%.2lf\t", fluxResult.m_windField.GetWindSpeed());
+        f.Printf("%.2lf\t", fluxResult.m_windField.GetWindSpeedError());
+        f.Printf("%s\t", (const char*)wsSrc);
 
         // the wind direction
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindDirection());
-        fprintf(f, "%.2lf\t", fluxResult.m_windField.GetWindDirectionError());
-        fprintf(f, "%s\t", (const char*)wdSrc);
+        f.Printf("%.2lf\t", fluxResult.m_windField.GetWindDirection());
+        f.Printf("%.2lf\t", fluxResult.m_windField.GetWindDirectionError());
+        f.Printf("%s\t", (const char*)wdSrc);
 
         // the plume height
-        fprintf(f, "%.2lf\t", fluxResult.m_plumeHeight.m_plumeAltitude);
-        fprintf(f, "%.2lf\t", fluxResult.m_plumeHeight.m_plumeAltitudeError);
-        fprintf(f, "%s\t", (const char*)phSrc);
+        f.Printf("%.2lf\t", fluxResult.m_plumeHeight.m_plumeAltitude);
+        f.Printf("%.2lf\t", fluxResult.m_plumeHeight.m_plumeAltitudeError);
+        f.Printf("%s\t", (const char*)phSrc);
 
         // write additional information about the scan
-        fprintf(f, "%.1lf\t", fluxResult.m_compass);
-        fprintf(f, "%.1lf\t", fluxResult.m_coneAngle);
-        fprintf(f, "%.1lf\t", fluxResult.m_tilt);
-        fprintf(f, "%d\t", fluxResult.m_numGoodSpectra);
-        fprintf(f, "%.1lf\t", fluxResult.m_plumeCentre[0]);
-        fprintf(f, "%.1lf\t", fluxResult.m_plumeCentre[1]);
-        fprintf(f, "%.2lf\t", fluxResult.m_completeness);
-        fprintf(f, "%.1e\n", fluxResult.m_scanOffset);
+        f.Printf("%.1lf\t", fluxResult.m_compass);
+        f.Printf("%.1lf\t", fluxResult.m_coneAngle);
+        f.Printf("%.1lf\t", fluxResult.m_tilt);
+        f.Printf("%d\t", fluxResult.m_numGoodSpectra);
+        f.Printf("%.1lf\t", fluxResult.m_plumeCentre[0]);
+        f.Printf("%.1lf\t", fluxResult.m_plumeCentre[1]);
+        f.Printf("%.2lf\t", fluxResult.m_completeness);
+        f.Printf("%.1e\n", fluxResult.m_scanOffset);
 
     }
 
     // remember to close the file
-    fclose(f);
+    if (!f.Close())
+    {
+        ShowMessage("Failed to write the flux log file.");
+    }
 }
 
-void CPostProcessing::WriteCalculatedGeometriesToFile(novac::CList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
+void CPostProcessing::WriteCalculatedGeometriesToFile(novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
 {
     if (geometryResults.GetCount() == 0)
         return; // nothing to write...
@@ -1413,12 +2058,8 @@ void CPostProcessing::WriteCalculatedGeometriesToFile(novac::CList <Geometry::CG
     fclose(f);
 }
 
-void CPostProcessing::InsertCalculatedGeometriesIntoDataBase(novac::CList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
+void CPostProcessing::InsertCalculatedGeometriesIntoDataBase(novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
 {
-    Meteorology::CWindField windField;
-    CDateTime validFrom, validTo;
-    Configuration::CInstrumentLocation location;
-
     auto pos = geometryResults.GetHeadPosition();
     while (pos != nullptr)
     {
@@ -1429,6 +2070,20 @@ void CPostProcessing::InsertCalculatedGeometriesIntoDataBase(novac::CList <Geome
             // insert the plume height into the plume height database
             this->m_plumeDataBase.InsertPlumeHeight(*result);
         }
+    }
+
+    InsertCalculatedWindDirectionsIntoDataBase(geometryResults);
+}
+
+void CPostProcessing::InsertCalculatedWindDirectionsIntoDataBase(novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults)
+{
+    CDateTime validFrom, validTo;
+    Configuration::CInstrumentLocation location;
+
+    auto pos = geometryResults.GetHeadPosition();
+    while (pos != nullptr)
+    {
+        Geometry::CGeometryResult *result = geometryResults.GetNext(pos);
 
         if (result->m_windDirection > NOT_A_NUMBER)
         {
@@ -1449,257 +2104,281 @@ void CPostProcessing::InsertCalculatedGeometriesIntoDataBase(novac::CList <Geome
 
 void CPostProcessing::CalculateDualBeamWindSpeeds(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogs)
 {
-    novac::CList <novac::CString, novac::CString &> masterList; // list of wind-measurements from the master channel
-    novac::CList <novac::CString, novac::CString &> slaveList;  // list of wind-measurements from the slave channel
-    novac::CList <novac::CString, novac::CString &> heidelbergList;  // list of wind-measurements from the Heidelbergensis
-    CDateTime validFrom, validTo;
+    std::vector<DualBeamWindSpeed> windSpeeds;
+    const int nWindMeasFound = CalculateDualBeamWindSpeeds(evalLogs, windSpeeds);
 
-    novac::CString serial, serial2, fileName, fileName2, nonsenseString;
-    novac::CString userMessage, windLogFile;
-    CDateTime startTime, startTime2;
-    int channel, channel2, nWindMeasFound = 0;
-    MEASUREMENT_MODE meas_mode, meas_mode2;
+    WriteDualBeamWindSpeeds(nWindMeasFound, windSpeeds);
+}
+
+int CPostProcessing::CalculateDualBeamWindSpeeds(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogs, std::vector<DualBeamWindSpeed>& windSpeeds)
+{
+    // A wind-measurement, together with the information in its file name
+    struct WindMeasurement
+    {
+        novac::CString fileNameAndPath;
+        novac::CString fileName;
+        novac::CString serial;
+        CDateTime startTime;
+    };
+    std::vector<WindMeasurement> masterList; // list of wind-measurements from the master channel
+    std::vector<WindMeasurement> slaveList;  // list of wind-measurements from the slave channel
+    std::vector<WindMeasurement> heidelbergList;  // list of wind-measurements from the Heidelbergensis
+
+    int channel, nWindMeasFound = 0;
+    MEASUREMENT_MODE meas_mode;
     Configuration::CInstrumentLocation location;
-    WindSpeedMeasurement::CWindSpeedCalculator calculator;
-    Geometry::CPlumeHeight plumeHeight;
-    Meteorology::CWindField windField, oldWindField;
 
     // -------------------------------- step 1. -------------------------------------
     // search through 'evalLogs' for dual-beam measurements from master and from slave
     auto logPosition = evalLogs.GetHeadPosition();
     while (logPosition != nullptr)
     {
-        const novac::CString &fileNameAndPath = evalLogs.GetNext(logPosition).m_evalLogFile[g_userSettings.m_mainFitWindow];
+        WindMeasurement measurement;
+        measurement.fileNameAndPath = evalLogs.GetNext(logPosition).m_evalLogFile[g_userSettings.m_mainFitWindow];
 
         // to know the start-time of the measurement, we need to 
         // extract just the file-name, i.e. remove the path
-        fileName = novac::CString(fileNameAndPath);
-        Common::GetFileName(fileName);
+        measurement.fileName = measurement.fileNameAndPath;
+        Common::GetFileName(measurement.fileName);
 
-        novac::CFileUtils::GetInfoFromFileName(fileName, startTime, serial, channel, meas_mode);
+        novac::CFileUtils::GetInfoFromFileName(measurement.fileName, measurement.startTime, measurement.serial, channel, meas_mode);
 
         if (meas_mode == MODE_WINDSPEED)
         {
             ++nWindMeasFound;
             // first check if this is a heidelberg instrument
-            if (g_setup.GetInstrumentLocation(serial, startTime, location))
+            if (g_setup.GetInstrumentLocation(measurement.serial, measurement.startTime, location))
                 continue;
 
             if (location.m_instrumentType == INSTR_HEIDELBERG)
             {
                 // this is a heidelberg instrument
-                heidelbergList.AddTail(novac::CString(fileNameAndPath));
+                heidelbergList.push_back(measurement);
             }
             else
             {
                 // this is a gothenburg instrument
                 if (channel == 0)
                 {
-                    masterList.AddTail(novac::CString(fileNameAndPath));
+                    masterList.push_back(measurement);
                 }
                 else if (channel == 1)
                 {
-                    slaveList.AddTail(novac::CString(fileNameAndPath));
+                    slaveList.push_back(measurement);
                 }
             }
         }
     }
     if (nWindMeasFound == 0)
     {
-        ShowMessage("No dual-beam wind speed measurements found.");
-        return; // if nothing was found...
+        return 0; // if nothing was found...
     }
 
-    userMessage.Format("%d dual-beam wind speed measurements found. Calculating wind-speeds", nWindMeasFound);
-    ShowMessage(userMessage);
-
-    // Create the dual-beam log-file
-    windLogFile.Format("%s%cDualBeamLog.txt", (const char*)g_userSettings.m_outputDirectory, Poco::Path::separator());
-    calculator.WriteWindSpeedLogHeader(windLogFile);
-
-
     // -------------------------------- step 2. -------------------------------------
-    // loop through each of the measurements from the heidelberg instruments
-    // and calculate the wind speed for each measurement
-    auto instrPos = heidelbergList.GetHeadPosition();
-    while (instrPos != nullptr)
-    {
-        const novac::CString &fileNameAndPath = heidelbergList.GetNext(instrPos);
+    // Make a list of the wind speed calculations to make. First each of the measurements 
+    //  from the heidelberg instruments and then each measurement from a master-channel
+    //  together with the measurements from the slave channel made at the same time.
+    std::vector<DualBeamWindSpeed> calculations;
 
-        // to know the start-time of the measurement, we need to 
-        // extract just the file-name, i.e. remove the path
-        fileName = novac::CString(fileNameAndPath);
-        Common::GetFileName(fileName);
-        novac::CFileUtils::GetInfoFromFileName(fileName, startTime, serial, channel, meas_mode);
+    auto addCalculation = [&](const WindMeasurement &measurement, const novac::CString &secondFileNameAndPath, bool heidelberg)
+    {
+        DualBeamWindSpeed calculation;
+        calculation.fileNameAndPath = measurement.fileNameAndPath;
+        calculation.fileName = measurement.fileName;
+        calculation.secondFileNameAndPath = secondFileNameAndPath;
+        calculation.startTime = measurement.startTime;
+        calculation.heidelberg = heidelberg;
 
         // Get the plume height at the time of the measurement
-        m_plumeDataBase.GetPlumeHeight(startTime, plumeHeight);
+        m_plumeDataBase.GetPlumeHeight(measurement.startTime, calculation.plumeHeight);
 
         // Get the location of the instrument at the time of the measurement
-        g_setup.GetInstrumentLocation(serial, startTime, location);
-
-        // calculate the speed of the wind at the time of the measurement
-        if (0 == calculator.CalculateWindSpeed(fileNameAndPath, nonsenseString, location, plumeHeight, windField))
-        {
-            // append the results to file
-            calculator.AppendResultToFile(windLogFile, startTime, location, plumeHeight, windField);
+        g_setup.GetInstrumentLocation(measurement.serial, measurement.startTime, calculation.location);
 
-            // insert the newly calculated wind-speed into the database
-            if (windField.GetWindSpeedError() > g_userSettings.m_dualBeam_MaxWindSpeedError)
-            {
-                userMessage.Format("-Calculated a wind-speed of %.1lf +- %.1lf m/s on %04d.%02d.%02d at %02d:%02d. Error too large, measurement discarded.", windField.GetWindSpeed(), windField.GetWindSpeedError(),
-                    startTime.year, startTime.month, startTime.day, startTime.hour, startTime.minute);
-            }
-            else
-            {
-                // tell the user...
-                userMessage.Format("+Calculated a wind-speed of %.1lf +- %.1lf m/s on %04d.%02d.%02d at %02d:%02d. Measurement accepted", windField.GetWindSpeed(), windField.GetWindSpeedError(),
-                    startTime.year, startTime.month, startTime.day, startTime.hour, startTime.minute);
+        calculations.push_back(calculation);
+    };
 
-                // get the time-interval that the measurement is valid for
-                windField.GetValidTimeFrame(validFrom, validTo);
+    for (const WindMeasurement &measurement : heidelbergList)
+    {
+        addCalculation(measurement, novac::CString(), true);
+    }
 
-                // insert the new wind speed into the database
-                m_windDataBase.InsertWindSpeed(validFrom, validTo, windField.GetWindSpeed(), windField.GetWindSpeedError(), Meteorology::MET_DUAL_BEAM_MEASUREMENT, nullptr);
-            }
-            ShowMessage(userMessage);
+    // match the measurements from the master- and slave-channels on serial and start time.
+    //  The serials are compared case-insensitively, as with Equals().
+    auto pairingKey = [](const WindMeasurement &measurement)
+    {
+        novac::CString key;
+        key.Format("%s_%04d%02d%02d%02d%02d%02d", (const char*)measurement.serial,
+            measurement.startTime.year, measurement.startTime.month, measurement.startTime.day,
+            measurement.startTime.hour, measurement.startTime.minute, measurement.startTime.second);
+        key.MakeUpper();
+        return key.std_str();
+    };
+    std::unordered_map<std::string, std::vector<size_t>> slavesByKey;
+    for (size_t k = 0; k < slaveList.size(); ++k)
+    {
+        slavesByKey[pairingKey(slaveList[k])].push_back(k);
+    }
+    for (const WindMeasurement &master : masterList)
+    {
+        auto slaves = slavesByKey.find(pairingKey(master));
+        if (slaves == slavesByKey.end())
+        {
+            continue;
         }
-        else
+        for (size_t slaveIndex : slaves->second)
         {
-            userMessage.Format("Failed to calculate wind speed from measurement: %s", (const char*)fileName);
-            ShowMessage(userMessage);
+            // we have found a match!!!
+            addCalculation(master, slaveList[slaveIndex].fileNameAndPath, false);
         }
     }
 
     // -------------------------------- step 3. -------------------------------------
-    // loop through each of the measurements from a master-channel and try to match them with a measurement
-    // from a slave channel...
-    auto masterPos = masterList.GetHeadPosition();
-    while (masterPos != nullptr)
+    // calculate the speed of the wind at the time of each measurement. The calculations are independent
+    //  of each other and are made in parallel, each thread using its own wind speed calculator.
+    std::atomic<size_t> nextCalculation{ 0 };
+    auto calculateWindSpeeds = [&calculations, &nextCalculation]()
     {
-        const novac::CString &fileNameAndPath = masterList.GetNext(masterPos);
+        WindSpeedMeasurement::CWindSpeedCalculator calculator;
+        size_t k;
+        while ((k = nextCalculation++) < calculations.size())
+        {
+            DualBeamWindSpeed &calculation = calculations[k];
+            calculation.succeeded = (0 == calculator.CalculateWindSpeed(calculation.fileNameAndPath, calculation.secondFileNameAndPath, calculation.location, calculation.plumeHeight, calculation.windField));
+        }
+    };
 
-        // extract just the file-name, i.e. remove the path
-        fileName = novac::CString(fileNameAndPath);
-        Common::GetFileName(fileName);
+    const size_t nThreads = std::min((size_t)g_userSettings.m_maxThreadNum, calculations.size());
+    std::vector<std::thread> windThreads;
+    for (size_t threadIdx = 1; threadIdx < nThreads; ++threadIdx)
+    {
+        windThreads.push_back(std::thread(calculateWindSpeeds));
+    }
+    calculateWindSpeeds();
+    for (std::thread &t : windThreads)
+    {
+        t.join();
+    }
 
-        novac::CFileUtils::GetInfoFromFileName(fileName, startTime, serial, channel, meas_mode);
+    for (DualBeamWindSpeed &calculation : calculations)
+    {
+        windSpeeds.push_back(std::move(calculation));
+    }
 
-        // now check if we can match this one with a file in the slave-channel
-        auto pos2 = slaveList.GetHeadPosition();
-        while (pos2 != nullptr)
-        {
-            const novac::CString &fileNameAndPath2 = slaveList.GetNext(pos2);
+    return nWindMeasFound;
+}
 
-            // extract just the file-name, i.e. remove the path
-            fileName2 = novac::CString(fileNameAndPath2);
-            Common::GetFileName(fileName2);
+bool CPostProcessing::InsertDualBeamWindSpeed(const DualBeamWindSpeed& windSpeed)
+{
+    const Meteorology::CWindField &windField = windSpeed.windField;
+    if (!windSpeed.succeeded || windField.GetWindSpeedError() > g_userSettings.m_dualBeam_MaxWindSpeedError)
+    {
+        return false;
+    }
 
-            novac::CFileUtils::GetInfoFromFileName(fileName2, startTime2, serial2, channel2, meas_mode2);
+    // get the time-interval that the measurement is valid for
+    CDateTime validFrom, validTo;
+    windField.GetValidTimeFrame(validFrom, validTo);
 
-            if (Equals(serial, serial2) && (startTime == startTime2))
-            {
-                // we have found a match!!!
+    // insert the new wind speed into the database
+    m_windDataBase.InsertWindSpeed(validFrom, validTo, windField.GetWindSpeed(), windField.GetWindSpeedError(), Meteorology::MET_DUAL_BEAM_MEASUREMENT, nullptr);
+    return true;
+}
 
-                // Get the plume height at the time of the measurement
-                m_plumeDataBase.GetPlumeHeight(startTime, plumeHeight);
+void CPostProcessing::WriteDualBeamWindSpeeds(int nWindMeasFound, const std::vector<DualBeamWindSpeed>& windSpeeds)
+{
+    novac::CString userMessage, windLogFile;
 
-                // Get the location of the instrument at the time of the measurement
-                g_setup.GetInstrumentLocation(serial, startTime, location);
+    if (nWindMeasFound == 0)
+    {
+        ShowMessage("No dual-beam wind speed measurements found.");
+        return; // if nothing was found...
+    }
 
-                // calculate the speed of the wind at the time of the measurement
-                if (0 == calculator.CalculateWindSpeed(fileNameAndPath, fileNameAndPath2, location, plumeHeight, windField))
-                {
-                    // append the results to file
-                    calculator.AppendResultToFile(windLogFile, startTime, location, plumeHeight, windField);
+    userMessage.Format("%d dual-beam wind speed measurements found. Calculating wind-speeds", nWindMeasFound);
+    ShowMessage(userMessage);
 
-                    // insert the newly calculated wind-speed into the database
-                    if (windField.GetWindSpeedError() > g_userSettings.m_dualBeam_MaxWindSpeedError)
-                    {
-                        userMessage.Format("-Calculated a wind-speed of %.1lf +- %.1lf m/s on %04d.%02d.%02d at %02d:%02d. Error too large, measurement discarded.", windField.GetWindSpeed(), windField.GetWindSpeedError(),
-                            startTime.year, startTime.month, startTime.day, startTime.hour, startTime.minute);
-                    }
-                    else
-                    {
-                        // tell the user...
-                        userMessage.Format("+Calculated a wind-speed of %.1lf +- %.1lf m/s on %04d.%02d.%02d at %02d:%02d. Measurement accepted", windField.GetWindSpeed(), windField.GetWindSpeedError(),
-                            startTime.year, startTime.month, startTime.day, startTime.hour, startTime.minute);
+    // Create the dual-beam log-file
+    windLogFile.Format("%s%cDualBeamLog.txt", (const char*)g_userSettings.m_outputDirectory, Poco::Path::separator());
+    WindSpeedMeasurement::CWindSpeedCalculator calculator;
+    calculator.WriteWindSpeedLogHeader(windLogFile);
 
-                        windField.GetValidTimeFrame(validFrom, validTo);
+    // write the results to file and insert them into the database, in the order of the measurements
+    for (const DualBeamWindSpeed &windSpeed : windSpeeds)
+    {
+        const CDateTime &startTime = windSpeed.startTime;
+        const Meteorology::CWindField &windField = windSpeed.windField;
 
-                        // insert the new wind speed into the database
-                        m_windDataBase.InsertWindSpeed(validFrom, validTo, windField.GetWindSpeed(), windField.GetWindSpeedError(), Meteorology::MET_DUAL_BEAM_MEASUREMENT, nullptr);
-                    }
-                    ShowMessage(userMessage);
+        if (windSpeed.succeeded)
+        {
+            // append the results to file
+            calculator.AppendResultToFile(windLogFile, startTime, windSpeed.location, windSpeed.plumeHeight, windField);
 
-                }
-                else
-                {
-                    userMessage.Format("Failed to calculate wind speed from measurement: %s", (const char*)fileName);
-                    ShowMessage(userMessage);
-                }
+            // insert the newly calculated wind-speed into the database
+            if (InsertDualBeamWindSpeed(windSpeed))
+            {
+                userMessage.Format("+Calculated a wind-speed of %.1lf +- %.1lf m/s on %04d.%02d.%02d at %02d:%02d. Measurement accepted", windField.GetWindSpeed(), windField.GetWindSpeedError(),
+                    startTime.year, startTime.month, startTime.day, startTime.hour, startTime.minute);
+            }
+            else
+            {
+                userMessage.Format("-Calculated a wind-speed of %.1lf +- %.1lf m/s on %04d.%02d.%02d at %02d:%02d. Error too large, measurement discarded.", windField.GetWindSpeed(), windField.GetWindSpeedError(),
+                    startTime.year, startTime.month, startTime.day, startTime.hour, startTime.minute);
             }
+            ShowMessage(userMessage);
+        }
+        else
+        {
+            userMessage.Format("Failed to calculate wind speed from measurement: %s", (const char*)windSpeed.fileName);
+            ShowMessage(userMessage);
         }
     }
 }
 
 void CPostProcessing::SortEvaluationLogs(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogs)
 {
-    novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> left;
-    novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> right;
+    // The sorting is done on a contiguous list of small records, holding the start time
+    //  of the scan as one integer (yyyymmddhhmmss) and a pointer to the result itself,
+    //  such that the (large) results only need to be copied once.
+    struct EvaluationLogSortKey
+    {
+        long long startTime;
+        Evaluation::CExtendedScanResult* result;
+    };
 
-    // If this list consists of only one element, then we're done
     if (evalLogs.GetCount() <= 1)
         return;
 
-    // Divide the list into two, and sort each one of them
-    auto pos1 = evalLogs.GetHeadPosition();
-    int index = 0;
-    while (pos1 != nullptr)
+    std::vector<EvaluationLogSortKey> keys;
+    keys.reserve(evalLogs.GetCount());
+    auto pos = evalLogs.GetHeadPosition();
+    while (pos != nullptr)
     {
-        Evaluation::CExtendedScanResult &log = evalLogs.GetNext(pos1);
-        if (index % 2 == 0)
-            left.AddTail(log);
-        else
-            right.AddTail(log);
-        ++index;
+        Evaluation::CExtendedScanResult& log = evalLogs.GetNext(pos);
+        const CDateTime& t = log.m_startTime;
+        const long long date = t.year * 10000LL + t.month * 100LL + t.day;
+        const long long time = t.hour * 10000LL + t.minute * 100LL + t.second;
+        keys.push_back(EvaluationLogSortKey{ date * 1000000LL + time, &log });
     }
 
-    SortEvaluationLogs(left);
-    SortEvaluationLogs(right);
+    novac::ParallelStableSort(keys, [](const EvaluationLogSortKey& k1, const EvaluationLogSortKey& k2) {
+        if (k1.startTime != k2.startTime)
+            return k1.startTime < k2.startTime;
+        return k1.result->m_startTime < k2.result->m_startTime; // scans started within the same second
+    }, std::max(g_userSettings.m_maxThreadNum, 1UL));
 
-    // Merge the two lists into one, sorted list
-    evalLogs.RemoveAll();
-    auto pos3 = left.GetHeadPosition();
-    auto pos2 = right.GetHeadPosition();
-    while (pos3 != nullptr && pos2 != nullptr)
-    {
-        Evaluation::CExtendedScanResult &log1 = left.GetAt(pos3);
-        Evaluation::CExtendedScanResult &log2 = right.GetAt(pos2);
-
-        if (log2.m_startTime < log1.m_startTime)
-        {
-            evalLogs.AddTail(log2);
-            right.GetNext(pos2);
-        }
-        else
-        {
-            evalLogs.AddTail(log1);
-            left.GetNext(pos3);
-        }
-    }
-
-    while (pos3 != nullptr)
+    std::vector<Evaluation::CExtendedScanResult> sortedLogs;
+    sortedLogs.reserve(keys.size());
+    for (const EvaluationLogSortKey& key : keys)
     {
-        evalLogs.AddTail(left.GetNext(pos3));
+        sortedLogs.push_back(*key.result);
     }
 
-    while (pos2 != nullptr)
+    evalLogs.RemoveAll();
+    for (Evaluation::CExtendedScanResult& log : sortedLogs)
     {
-        evalLogs.AddTail(right.GetNext(pos2));
+        evalLogs.AddTail(std::move(log));
     }
-
-    return;
 }
 
 void CPostProcessing::UploadResultsToFTP()
@@ -1808,25 +2487,53 @@ void CPostProcessing::LocateEvaluationLogFiles(const novac::CString& directory,
     limits.startTime = g_userSettings.m_fromDate;
     limits.endTime = g_userSettings.m_toDate;
     limits.fileExtension = "_flux.txt";
+    limits.includeCompressedFiles = true;
     Filesystem::SearchDirectoryForFiles(directory, includeSubDirs, evalLogFiles, &limits);
 
 
-    messageToUser.Format("%d Evaluation log files found, starting reading", evalLogFiles.size());
+    messageToUser.Format("%d Evaluation log files found, starting reading", (int)evalLogFiles.size());
     ShowMessage(messageToUser);
 
     size_t nofFailedLogReads = 0;
+    size_t nofIndexedLogs = 0;
+
+    // The indices of the directories, these are read in when the first log in each directory is found.
+    std::map<std::string, FileHandler::CEvaluationLogIndex> indices;
 
     for (std::string& f : evalLogFiles)
     {
+        Evaluation::CExtendedScanResult result;
+        result.m_evalLogFile[0] = f;
+
+        const std::string logDirectoryName = FileHandler::CEvaluationLogIndex::GetDirectory(f);
+        auto index = indices.find(logDirectoryName);
+        if (index == indices.end())
+        {
+            index = indices.emplace(logDirectoryName, FileHandler::CEvaluationLogIndex()).first;
+            if (index->second.Read(logDirectoryName))
+            {
+                // keep the index small, before any logs of this directory are added to it again
+                index->second.Compact(logDirectoryName);
+            }
+        }
+
+        // use the index if this log hasn't been changed since it was indexed
+        const FileHandler::CEvaluationLogIndex::Entry* entry = index->second.Find(f);
+        if (entry != nullptr)
+        {
+            result.m_startTime = entry->startTime;
+            result.m_scanProperties = entry->properties;
+            evaluationLogFiles.AddTail(result);
+            ++nofIndexedLogs;
+            continue;
+        }
+
         int channel;
         CDateTime startTime;
         MEASUREMENT_MODE mode;
         novac::CString serial;
         novac::CFileUtils::GetInfoFromFileName(f, startTime, serial, channel, mode);
-
-        Evaluation::CExtendedScanResult result;
-        result.m_evalLogFile[0] = f;
-        result.m_startTime      = startTime;
+        result.m_startTime = startTime;
 
         FileHandler::CEvaluationLogFileHandler logReader;
         logReader.m_evaluationLog = novac::CString(f);
@@ -1835,11 +2542,21 @@ void CPostProcessing::LocateEvaluationLogFiles(const novac::CString& directory,
             ++nofFailedLogReads;
             continue;
         }
-        Evaluation::CScanResult scanResult = logReader.m_scan[0];
+        const Evaluation::CScanResult& scanResult = logReader.m_scan[0];
+
+        // the completeness limits of the geometry- and flux calculations need the properties of the plume
+        result.m_scanProperties = FileHandler::CEvaluationLogIndex::CalculatePlumeProperties(scanResult);
+
+        // add the log to the index, such that it doesn't need to be read the next time.
+        //  The logs are stored in 'fitWindow/date/serial/'
+        const Poco::Path logDirectory(logDirectoryName);
+        const std::string fitWindow = (logDirectory.depth() >= 3) ? logDirectory.directory(logDirectory.depth() - 3) : std::string();
+        FileHandler::CEvaluationLogIndex::AddEvaluationLog(f, fitWindow, scanResult);
 
         evaluationLogFiles.AddTail(result);
     }
 
-    messageToUser.Format("%d Evaluation log files read successfully.", evalLogFiles.size() - nofFailedLogReads);
+    messageToUser.Format("%d Evaluation log files read successfully (%d from the index).", (int)(evalLogFiles.size() - nofFailedLogReads), (int)nofIndexedLogs);
     ShowMessage(messageToUser);
+    ShowMessage("The completeness, centre and edges of the plume in each of these scans have been calculated from its evaluation log.");
 }
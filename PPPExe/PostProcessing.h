@@ -7,6 +7,7 @@
 #include "Flux/FluxResult.h"
 #include "Evaluation/ExtendedScanResult.h"
 #include <PPPLib/CList.h>
+#include <PPPLib/CVectorList.h>
 #include <PPPLib/CString.h>
 
 /** The class <b>CPostProcessing</b> is the main class in the NovacPPP
@@ -44,6 +45,10 @@ public:
         good stratospheric data */
     void DoPostProcessing_Strat();
 
+    /** Regenerates the evaluation logs in the output directory from their binary copies,
+        for every binary copy whose evaluation log (compressed or not) is missing. */
+    void RestoreEvaluationLogs();
+
 protected:
 
     // ----------------------------------------------------------------------
@@ -96,6 +101,13 @@ protected:
         file-names of the found .pak-files (these will be in the TEMP directory) */
     void CheckForSpectraOnFTPServer(std::vector<std::string>& fileList);
 
+    /** Reads the serial, channel and start time of each of the given .pak-files
+        into the global catalog of .pak-files, using all the evaluation threads.
+        The catalog is saved in the output directory and read back in by the next
+        processing, such that only the new or changed files need to be read.
+        @param pakFileList - the list of pak-files to evaluate. */
+    void CatalogPakFiles(const std::vector<std::string>& pakFileList);
+
     /** Runs through the supplied list of .pak-files and evaluates
         each one using the setups found in the global settings.
         @param pakFileList - the list of pak-files to evaluate.
@@ -106,6 +118,22 @@ protected:
     void EvaluateScans(const std::vector<std::string>& pakFileList,
         novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogFiles);
 
+    /** Runs through the supplied list of .pak-files and evaluates each one,
+        while at the same time calculating the geometries, dual-beam wind speeds
+        and fluxes for the scans which have been evaluated. The calculations for a scan
+        are started as soon as all the scans which it depends on have been evaluated.
+        The results are the same as when evaluating all scans first and calculating afterwards.
+        @param pakFileList - the list of pak-files to evaluate.
+        @param evalLogFiles - will on successful return be filled with the evaluated
+            scans, sorted in order of increasing start time.
+        @param geometryResults - will on successfull return be filled with the
+            calculated plume heights and wind-directions. These are also inserted
+            into the databases.
+        The fluxes are written to the flux-log files in the output directory. */
+    void RunPipelinedProcessing(const std::vector<std::string>& pakFileList,
+        novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogFiles,
+        novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults);
+
     /** Runs through the supplied list of evaluation - logs and performs
         geometry calculations on the ones which does match. The results
         are returned in the list geometryResults.
@@ -116,28 +144,77 @@ protected:
             calculated plume heights and wind-directions.
         */
     void CalculateGeometries(novac::CList <Evaluation::CExtendedScanResult,
-        Evaluation::CExtendedScanResult &> &evalLogs, novac::CList <Geometry::CGeometryResult*,
+        Evaluation::CExtendedScanResult &> &evalLogs, novac::CVectorList <Geometry::CGeometryResult*,
         Geometry::CGeometryResult*> &geometryResults);
 
+    /** Performs the geometry calculations for the first 'nScansToCombine' scans in the
+        sorted list 'evalLogs', the remaining scans in the list are only used to combine with.
+        @param plumeDataBase - the plume heights to use when calculating wind directions
+            from single scans.
+        @param geometryResults - the calculated plume heights and wind-directions
+            are appended to this list.
+        The scans are combined using g_userSettings.m_maxThreadNum threads, the results are
+            appended in the same order as when combining the scans one at a time. */
+    void CalculateGeometries(const Geometry::CPlumeDataBase &plumeDataBase,
+        novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogs,
+        int nScansToCombine,
+        novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults);
+
     /** Writes each of the calculated geometry results to the GeometryLog file */
     void WriteCalculatedGeometriesToFile(
-        novac::CList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults);
+        novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults);
 
     /** Inserts the calculated geometry results into the databases.
         The wind directions will be inserted into m_windDataBase
         The plume altitudes will be inserted into m_plumeDataBase */
     void InsertCalculatedGeometriesIntoDataBase(
-        novac::CList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults);
+        novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults);
+
+    /** Inserts the wind directions of the calculated geometry results into m_windDataBase */
+    void InsertCalculatedWindDirectionsIntoDataBase(
+        novac::CVectorList <Geometry::CGeometryResult*, Geometry::CGeometryResult*> &geometryResults);
+
+    /** The wind speed calculated from one dual-beam measurement */
+    struct DualBeamWindSpeed
+    {
+        novac::CString fileNameAndPath;         // the evaluation log of the (master channel of the) measurement
+        novac::CString fileName;                // the file name of the evaluation log, without the path
+        novac::CString secondFileNameAndPath;   // the evaluation log of the slave channel, empty for a Heidelberg instrument
+        CDateTime startTime;
+        bool heidelberg = false;
+        Configuration::CInstrumentLocation location;
+        Geometry::CPlumeHeight plumeHeight;
+        bool succeeded = false;
+        Meteorology::CWindField windField;
+    };
 
     /** This calculates the wind speeds from the dual-beam measurements that has been made
         @param evalLogs - list of CExtendedScanResult, each holding the full path and filename
             of an evaluation-log file. Only the measurements containing a
             dual-beam measurement will be considered.
         The plume heights are taken from the database 'm_plumeDataBase' and the
-            results are written to the database 'm_windDataBase' */
+            results are written to the DualBeamLog and to the database 'm_windDataBase' */
     void CalculateDualBeamWindSpeeds(novac::CList <Evaluation::CExtendedScanResult,
         Evaluation::CExtendedScanResult &> &evalLogs);
 
+    /** Calculates the wind speeds from the dual-beam measurements in 'evalLogs', as above,
+        but only appends the calculated wind speeds to 'windSpeeds'. First come the measurements
+        from the Heidelberg instruments and then the measurements from the master channels,
+        each in the order of 'evalLogs'.
+        @return the number of dual-beam measurements found. */
+    int CalculateDualBeamWindSpeeds(novac::CList <Evaluation::CExtendedScanResult,
+        Evaluation::CExtendedScanResult &> &evalLogs, std::vector<DualBeamWindSpeed>& windSpeeds);
+
+    /** Inserts the calculated wind speed into the database 'm_windDataBase',
+        unless the calculation failed or its error is too large.
+        @return true if the wind speed was inserted. */
+    bool InsertDualBeamWindSpeed(const DualBeamWindSpeed& windSpeed);
+
+    /** Tells the user about the calculated wind speeds, writes them to the DualBeamLog
+        and inserts them into the database 'm_windDataBase', in the order of 'windSpeeds'.
+        @param nWindMeasFound - the number of dual-beam measurements found. */
+    void WriteDualBeamWindSpeeds(int nWindMeasFound, const std::vector<DualBeamWindSpeed>& windSpeeds);
+
     /** Runs through the supplied list of evaluation-results and
         calculates the flux for each scan. The resulting fluxes are written
         to a flux-log file in the output directory.
@@ -149,14 +226,25 @@ protected:
         */
     void CalculateFluxes(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogs);
 
+    /** Calculates the flux for each scan in the supplied list of evaluation-results
+        and appends the results to 'calculatedFluxes', without writing anything to file.
+        The fluxes are calculated using g_userSettings.m_maxThreadNum threads and are
+        appended in the same order as the scans in 'evalLogs'. */
+    void CalculateFluxes(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogs,
+        novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes);
+
+    /** Writes the calculated fluxes to the flux-log files and the flux statistics file */
+    void WriteFluxResults(novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes);
+
 
     /** Sorts the evaluation logs in order of increasing time
-        (this is mostly done since this speeds up the geometry calculations enormously) */
+        (this is mostly done since this speeds up the geometry calculations enormously).
+        The sort is stable and uses g_userSettings.m_maxThreadNum threads. */
     void SortEvaluationLogs(novac::CList <Evaluation::CExtendedScanResult, Evaluation::CExtendedScanResult &> &evalLogs);
 
     /** Writes the calculated fluxes to the flux result file */
-    void WriteFluxResult_XML(novac::CList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes);
-    void WriteFluxResult_Txt(novac::CList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes);
+    void WriteFluxResult_XML(novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes);
+    void WriteFluxResult_Txt(novac::CVectorList <Flux::CFluxResult, Flux::CFluxResult &> &calculatedFluxes);
 
     /** Takes care of uploading the result files to the FTP server */
     void UploadResultsToFTP();
@@ -7,6 +7,29 @@
 
 namespace novac
 {
+	/** The information which is stored in the name of a .pak-file or an evaluation log,
+		e.g. 'D2J2134_170129_0317_1.pak' or 'D2J2134_170129_0317_1_wind.txt' */
+	struct CFileNameInfo
+	{
+		/** The longest serial-number which can be stored. The serials in the file names
+			are the instrument names in the headers of the spectra, which are at most 16 characters. */
+		static const size_t MaxSerialLength = 16;
+
+		/** The serial-number of the spectrometer, null-terminated.
+			Empty if the serial-number in the file name is longer than MaxSerialLength. */
+		char serial[MaxSerialLength + 1] = {};
+
+		/** The length of the serial-number in the file name */
+		size_t serialLength = 0;
+
+		/** The date and time the scan started */
+		CDateTime startTime;
+
+		int channel = 0;
+
+		MEASUREMENT_MODE mode = MODE_FLUX;
+	};
+
 	class CFileUtils
 	{
 	public:
@@ -21,7 +44,17 @@ namespace novac
 		/** Takes the filename of an evaluation log and extracts the
 			Serial-number of the spectrometer, the date the scan was performed
 			and the start-time of the scan from the filename. */
-		static bool GetInfoFromFileName(const novac::CString fileName, CDateTime &start, novac::CString &serial, int &channel, MEASUREMENT_MODE &mode);
+		static bool GetInfoFromFileName(const novac::CString& fileName, CDateTime &start, novac::CString &serial, int &channel, MEASUREMENT_MODE &mode);
+
+		/** Takes the filename of a .pak-file or evaluation log and extracts the
+			information stored in it, as GetInfoFromFileName above, without allocating any memory.
+			The most recently parsed names are remembered (separately for each thread)
+			such that parsing the same name again only needs a look-up.
+			@param fileName the name of the file, possibly including the path. Need not be null-terminated.
+			@param length the number of characters in fileName.
+			@return true if the serial, start time and channel could be read.
+				False if the serial is longer than CFileNameInfo::MaxSerialLength. */
+		static bool GetInfoFromFileName(const char* fileName, size_t length, CFileNameInfo& info);
 
 		/** Judges if the provided .pak file is a complete file from the file name only. 
 			@return true if the file is from an incomplete scan */
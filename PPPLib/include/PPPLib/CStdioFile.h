@@ -2,6 +2,7 @@
 #define NOVAC_PPPLIB_CSTDIOFILE_H
 
 #include <fstream>
+#include <vector>
 #include "CString.h"
 
 namespace novac
@@ -44,9 +45,33 @@ namespace novac
 		// This reads until a new-line is encountered.
 		bool ReadString(CString& destination);
 
+		// Reads the next line from the file without copying it.
+		// The line ends at '\n' or "\r\n", the line ending is not included in the line.
+		// 'line' is set to point to the null-terminated line, which remains valid until the next read from, or Close() of, the file.
+		// 'length' is set to the number of characters in the line.
+		// Return FALSE if end-of-file was reached without reading any data.
+		bool ReadLine(const char*& line, size_t& length);
+
 	private:
 		std::ifstream m_f;
 
+		// The data read from the file. The lines are returned from this buffer, which is refilled
+		// from the file in large blocks and only grows if a line does not fit in it.
+		std::vector<char> m_buffer;
+
+		// The data in m_buffer which has not yet been returned is [m_begin, m_end)
+		size_t m_begin = 0;
+		size_t m_end = 0;
+
+		// Locates the next line in m_buffer, reading more data from the file if necessary.
+		// 'lineLength' is set to the length of the line (without the line ending) and 'nextLine'
+		// to the position in m_buffer where the following line starts.
+		// Return FALSE if end-of-file was reached without finding any data.
+		bool FindLine(size_t& lineLength, size_t& nextLine);
+
+		// Moves the remaining data to the start of m_buffer and reads more data from the file.
+		// Return FALSE if nothing more could be read.
+		bool FillBuffer();
 
 	};
 }
@@ -54,6 +54,16 @@ namespace novac
         CString& Append(const char* other);
         CString& Append(const std::string& other);
 
+        /** Appends the first 'length' characters of 'other' to this. */
+        CString& Append(const char* other, size_t length);
+
+        /** Appends one single character to this. */
+        CString& Append(char character);
+
+        /** Reserves memory for a string of the given length, such that the string
+            can be built up using Append and AppendFormat without reallocating. */
+        void Reserve(size_t capacity);
+
         // ---------------------- Extracting substrings -----------------------
 
         CString Left(int nChars) const;
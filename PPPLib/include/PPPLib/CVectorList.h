@@ -0,0 +1,375 @@
+#ifndef NOVAC_PPPLIB_CVECTORLIST_H
+#define NOVAC_PPPLIB_CVECTORLIST_H
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace novac
+{
+	/** A position in a CVectorList, used to iterate forward through the list.
+		The position is the index of the element in the list, it hence remains valid
+		when the list grows (but refers to the next element if an element is inserted before it). */
+	template<class TYPE>
+	struct VECTOR_POSITION
+	{
+	public:
+		VECTOR_POSITION()
+			: m_data(nullptr), m_index(0)
+		{
+		}
+
+		VECTOR_POSITION(std::vector<TYPE>& data, size_t index)
+			: m_data(&data), m_index(index)
+		{
+		}
+
+		VECTOR_POSITION(const TYPE*)
+			: m_data(nullptr), m_index(0)
+		{
+		}
+
+		VECTOR_POSITION& operator=(const TYPE*)
+		{
+			this->m_data = nullptr;
+			this->m_index = 0;
+
+			return *this;
+		}
+
+		bool HasNext() const
+		{
+			return nullptr != m_data && m_index < m_data->size();
+		}
+
+		TYPE& GetNext()
+		{
+			return (*m_data)[m_index++];
+		}
+
+		TYPE& GetAt() const
+		{
+			return (*m_data)[m_index];
+		}
+
+		/** @return the index in the list of the element at this position */
+		size_t GetIndex() const
+		{
+			return m_index;
+		}
+
+		void InsertBefore(TYPE item)
+		{
+			m_data->insert(m_data->begin() + m_index, std::move(item));
+			++m_index; // keep pointing at the same element
+		}
+
+		bool operator==(void* data)
+		{
+			return (nullptr == data) ? (!this->HasNext()) : false;
+		}
+
+		bool operator!=(void* data)
+		{
+			return (nullptr == data) ? (this->HasNext()) : true;
+		}
+
+	private:
+		std::vector<TYPE>* m_data;
+		size_t m_index;
+	};
+
+	template<class TYPE>
+	struct CONST_VECTOR_POSITION
+	{
+	public:
+		CONST_VECTOR_POSITION()
+			: m_data(nullptr), m_index(0)
+		{
+		}
+
+		CONST_VECTOR_POSITION(const std::vector<TYPE>& data, size_t index)
+			: m_data(&data), m_index(index)
+		{
+		}
+
+		CONST_VECTOR_POSITION(const TYPE*)
+			: m_data(nullptr), m_index(0)
+		{
+		}
+
+		bool HasNext() const
+		{
+			return nullptr != m_data && m_index < m_data->size();
+		}
+
+		const TYPE& GetNext()
+		{
+			return (*m_data)[m_index++];
+		}
+
+		const TYPE& GetAt() const
+		{
+			return (*m_data)[m_index];
+		}
+
+		size_t GetIndex() const
+		{
+			return m_index;
+		}
+
+		bool operator==(void* data)
+		{
+			return (nullptr == data) ? (!this->HasNext()) : false;
+		}
+
+		bool operator!=(void* data)
+		{
+			return (nullptr == data) ? (this->HasNext()) : true;
+		}
+
+	private:
+		const std::vector<TYPE>* m_data;
+		size_t m_index;
+	};
+
+	/** A position in a CVectorList, used to iterate backwards through the list. */
+	template<class TYPE>
+	struct VECTOR_REVERSE_POSITION
+	{
+	public:
+		VECTOR_REVERSE_POSITION()
+			: m_data(nullptr), m_remaining(0)
+		{
+		}
+
+		VECTOR_REVERSE_POSITION(std::vector<TYPE>& data)
+			: m_data(&data), m_remaining(data.size())
+		{
+		}
+
+		VECTOR_REVERSE_POSITION(void*)
+			: m_data(nullptr), m_remaining(0)
+		{
+		}
+
+		bool HasPrevious() const
+		{
+			return nullptr != m_data && m_remaining > 0 && m_remaining <= m_data->size();
+		}
+
+		TYPE& GetAt()
+		{
+			return (*m_data)[m_remaining - 1];
+		}
+
+		TYPE& GetPrev()
+		{
+			return (*m_data)[--m_remaining];
+		}
+
+		bool operator==(void* data)
+		{
+			return (nullptr == data) ? (!this->HasPrevious()) : false;
+		}
+
+		bool operator!=(void* data)
+		{
+			return (nullptr == data) ? (this->HasPrevious()) : true;
+		}
+
+	private:
+		std::vector<TYPE>* m_data;
+
+		/** The number of elements before, and including, this position */
+		size_t m_remaining;
+	};
+
+	template<class TYPE>
+	struct CONST_VECTOR_REVERSE_POSITION
+	{
+	public:
+		CONST_VECTOR_REVERSE_POSITION()
+			: m_data(nullptr), m_remaining(0)
+		{
+		}
+
+		CONST_VECTOR_REVERSE_POSITION(const std::vector<TYPE>& data)
+			: m_data(&data), m_remaining(data.size())
+		{
+		}
+
+		CONST_VECTOR_REVERSE_POSITION(void*)
+			: m_data(nullptr), m_remaining(0)
+		{
+		}
+
+		bool HasPrevious() const
+		{
+			return nullptr != m_data && m_remaining > 0 && m_remaining <= m_data->size();
+		}
+
+		const TYPE& GetAt() const
+		{
+			return (*m_data)[m_remaining - 1];
+		}
+
+		const TYPE& GetPrev()
+		{
+			return (*m_data)[--m_remaining];
+		}
+
+		bool operator==(void* data)
+		{
+			return (nullptr == data) ? (!this->HasPrevious()) : false;
+		}
+
+		bool operator!=(void* data)
+		{
+			return (nullptr == data) ? (this->HasPrevious()) : true;
+		}
+
+	private:
+		const std::vector<TYPE>* m_data;
+		size_t m_remaining;
+	};
+
+	/** CVectorList has the same interface as CList, but keeps the elements in one
+		contiguous block of memory instead of in a linked list. This makes iterating
+		through the list faster and gives access to the elements by index in constant time,
+		at the cost of AddHead and InsertBefore having to move the following elements.
+		Use this instead of CList for lists which are mainly built using AddTail and then
+		iterated over. Notice that, as for std::vector, references to the elements are
+		invalidated when the list grows, the positions remain valid since they are indices. */
+	template<class TYPE, class ARG_TYPE = const TYPE&>
+	class CVectorList
+	{
+	public:
+
+		// ---------------------- Construction -----------------------
+		CVectorList()
+		{
+		}
+
+		~CVectorList()
+		{
+		}
+
+		int GetSize() const
+		{
+			return (int)m_data.size();
+		}
+
+		int GetCount() const
+		{
+			return (int)m_data.size();
+		}
+
+		VECTOR_POSITION<TYPE> GetHeadPosition()
+		{
+			return VECTOR_POSITION<TYPE>(m_data, 0);
+		}
+
+		const CONST_VECTOR_POSITION<TYPE> GetHeadPosition() const
+		{
+			return CONST_VECTOR_POSITION<TYPE>(m_data, 0);
+		}
+
+		VECTOR_REVERSE_POSITION<TYPE> GetTailPosition()
+		{
+			return VECTOR_REVERSE_POSITION<TYPE>(m_data);
+		}
+
+		const CONST_VECTOR_REVERSE_POSITION<TYPE> GetTailPosition() const
+		{
+			return CONST_VECTOR_REVERSE_POSITION<TYPE>(m_data);
+		}
+
+		ARG_TYPE GetAt(VECTOR_POSITION<TYPE>& p) const
+		{
+			return p.GetAt();
+		}
+
+		ARG_TYPE GetAt(VECTOR_REVERSE_POSITION<TYPE>& p) const
+		{
+			return p.GetAt();
+		}
+
+		const ARG_TYPE GetAt(CONST_VECTOR_POSITION<TYPE>& p) const
+		{
+			return p.GetAt();
+		}
+
+		/** @return the element with the given index, in constant time */
+		TYPE& GetAt(int index)
+		{
+			assert(index >= 0 && (size_t)index < m_data.size());
+			return m_data[index];
+		}
+
+		const TYPE& GetAt(int index) const
+		{
+			assert(index >= 0 && (size_t)index < m_data.size());
+			return m_data[index];
+		}
+
+		ARG_TYPE GetNext(VECTOR_POSITION<TYPE>& p) const
+		{
+			return p.GetNext();
+		}
+
+		const ARG_TYPE GetNext(CONST_VECTOR_POSITION<TYPE>& p) const
+		{
+			return p.GetNext();
+		}
+
+		ARG_TYPE GetPrev(VECTOR_REVERSE_POSITION<TYPE>& p) const
+		{
+			return p.GetPrev();
+		}
+
+		const ARG_TYPE GetPrev(CONST_VECTOR_REVERSE_POSITION<TYPE>& p) const
+		{
+			return p.GetPrev();
+		}
+
+		// ---------------------- Operations -----------------------
+
+		/** Reserves memory for the given number of elements. */
+		void Reserve(int nElements)
+		{
+			m_data.reserve((size_t)nElements);
+		}
+
+		void RemoveAll()
+		{
+			m_data.clear();
+		}
+
+		void RemoveTail()
+		{
+			m_data.pop_back();
+		}
+
+		void AddTail(TYPE item)
+		{
+			m_data.push_back(std::move(item));
+		}
+
+		void AddHead(TYPE item)
+		{
+			m_data.insert(m_data.begin(), std::move(item));
+		}
+
+		void InsertBefore(VECTOR_POSITION<TYPE>& pos, TYPE item)
+		{
+			pos.InsertBefore(std::move(item));
+		}
+
+	private:
+		std::vector<TYPE> m_data;
+	};
+}
+
+#endif // !NOVAC_PPPLIB_CVECTORLIST_H
@@ -3,7 +3,14 @@
 
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
+#include <algorithm>
+#include <vector>
 #include <PPPLib/CList.h>
 
 namespace novac
@@ -78,19 +85,20 @@ namespace novac
         void CopyTo(novac::CList<Y, Y&>& dst)
         {
             std::lock_guard<std::mutex> lock(guard);
-            for (T item : m_items)
+            for (const T& item : m_items)
             {
                 dst.AddTail(Y(item));
             }
         }
 
+        /** Replaces the contents of 'dst' with a copy of the items in this list. */
         template<class Y>
         void CopyTo(std::vector<Y>& dst)
         {
             std::lock_guard<std::mutex> lock(guard);
             dst.clear();
-            dst.resize(m_items.size());
-            for (T item : m_items)
+            dst.reserve(m_items.size());
+            for (const T& item : m_items)
             {
                 dst.push_back(Y(item));
             }
@@ -106,6 +114,497 @@ namespace novac
         std::mutex guard;
     };
 
+    /** A first-in-first-out queue with a fixed capacity, used to hand items
+        from one or more producing threads to one or more consuming threads.
+        Producers are blocked while the queue is full and consumers are blocked
+        while the queue is empty. Once the queue has been closed no more items
+        can be added, and the consumers receive the remaining items followed
+        by a failed Pop.
+        The number of items and the closed-flag are also kept in atomics, such that
+        polling an empty queue (TryPop) and checking its size never takes the lock,
+        and the waiting threads are only notified when there actually is anyone waiting. */
+    template<class T>
+    struct BoundedQueue
+    {
+    public:
+        BoundedQueue(size_t capacity)
+            : m_capacity(capacity > 0 ? capacity : 1) { }
+
+        /** Adds an item to the end of the queue, waiting for free space if the queue is full.
+            @return true if the item was added, false if the queue has been closed. */
+        bool Push(T item)
+        {
+            std::unique_lock<std::mutex> lock(guard);
+            if (!m_closed && m_items.size() >= m_capacity) {
+                ++m_waitingProducers;
+                m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+                --m_waitingProducers;
+            }
+            if (m_closed) {
+                return false;
+            }
+            m_items.push_back(std::move(item));
+            m_size.store(m_items.size(), std::memory_order_release);
+            const bool notify = (m_waitingConsumers > 0);
+            lock.unlock();
+            if (notify) {
+                m_notEmpty.notify_one();
+            }
+            return true;
+        }
+
+        /** Adds an item to the end of the queue, if there is free space, without waiting.
+            The item is only moved from if it was added.
+            @return true if the item was added, false if the queue is full or has been closed. */
+        bool TryPush(T& item)
+        {
+            if (m_size.load(std::memory_order_acquire) >= m_capacity || m_closedFlag.load(std::memory_order_acquire)) {
+                return false;
+            }
+            std::unique_lock<std::mutex> lock(guard);
+            if (m_closed || m_items.size() >= m_capacity) {
+                return false;
+            }
+            m_items.push_back(std::move(item));
+            m_size.store(m_items.size(), std::memory_order_release);
+            const bool notify = (m_waitingConsumers > 0);
+            lock.unlock();
+            if (notify) {
+                m_notEmpty.notify_one();
+            }
+            return true;
+        }
+
+        /** Retrieves the first item in the queue, waiting for one to become available.
+            @return true if an item was retrieved, false if the queue is closed and empty. */
+        bool Pop(T& item)
+        {
+            std::unique_lock<std::mutex> lock(guard);
+            WaitForItems(lock);
+            if (m_items.size() == 0) {
+                return false;
+            }
+            item = std::move(m_items.front());
+            m_items.pop_front();
+            FinishPop(lock, 1);
+            return true;
+        }
+
+        /** Retrieves the first item in the queue, if there is any, without waiting.
+            @return true if an item was retrieved. */
+        bool TryPop(T& item)
+        {
+            if (m_size.load(std::memory_order_acquire) == 0) {
+                return false;
+            }
+            std::unique_lock<std::mutex> lock(guard);
+            if (m_items.size() == 0) {
+                return false;
+            }
+            item = std::move(m_items.front());
+            m_items.pop_front();
+            FinishPop(lock, 1);
+            return true;
+        }
+
+        /** Retrieves up to 'maxItems' items from the front of the queue, waiting until at least
+            one item is available. This takes the lock once for all the items.
+            @param items is cleared and then filled with the retrieved items, in order.
+            @return the number of retrieved items, zero if the queue is closed and empty. */
+        size_t PopBatch(std::vector<T>& items, size_t maxItems)
+        {
+            items.clear();
+            std::unique_lock<std::mutex> lock(guard);
+            WaitForItems(lock);
+            return MoveItemsTo(lock, items, maxItems);
+        }
+
+        /** Retrieves up to 'maxItems' items from the front of the queue without waiting.
+            @param items is cleared and then filled with the retrieved items, in order.
+            @return the number of retrieved items. */
+        size_t TryPopBatch(std::vector<T>& items, size_t maxItems)
+        {
+            items.clear();
+            if (m_size.load(std::memory_order_acquire) == 0) {
+                return 0;
+            }
+            std::unique_lock<std::mutex> lock(guard);
+            return MoveItemsTo(lock, items, maxItems);
+        }
+
+        /** Closes the queue. Waiting producers and consumers are woken up. */
+        void Close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                m_closed = true;
+                m_closedFlag.store(true, std::memory_order_release);
+            }
+            m_notEmpty.notify_all();
+            m_notFull.notify_all();
+        }
+
+        bool IsClosed() const {
+            return m_closedFlag.load(std::memory_order_acquire);
+        }
+
+        size_t Size() const {
+            return m_size.load(std::memory_order_acquire);
+        }
+
+        size_t Capacity() const {
+            return m_capacity;
+        }
+
+    private:
+        std::deque<T> m_items;
+        const size_t m_capacity;
+        bool m_closed = false;
+        std::mutex guard;
+        std::condition_variable m_notEmpty;
+        std::condition_variable m_notFull;
+
+        /** The number of threads waiting in Push and Pop, guarded by 'guard' */
+        int m_waitingProducers = 0;
+        int m_waitingConsumers = 0;
+
+        /** Copies of m_items.size() and m_closed which can be read without the lock */
+        std::atomic<size_t> m_size{ 0 };
+        std::atomic<bool> m_closedFlag{ false };
+
+        void WaitForItems(std::unique_lock<std::mutex>& lock)
+        {
+            if (!m_closed && m_items.size() == 0) {
+                ++m_waitingConsumers;
+                m_notEmpty.wait(lock, [this] { return m_closed || m_items.size() > 0; });
+                --m_waitingConsumers;
+            }
+        }
+
+        size_t MoveItemsTo(std::unique_lock<std::mutex>& lock, std::vector<T>& items, size_t maxItems)
+        {
+            const size_t nItems = std::min(maxItems, m_items.size());
+            for (size_t ii = 0; ii < nItems; ++ii) {
+                items.push_back(std::move(m_items.front()));
+                m_items.pop_front();
+            }
+            if (nItems > 0) {
+                FinishPop(lock, nItems);
+            }
+            return nItems;
+        }
+
+        // Updates the size after 'nItems' have been removed, releases the lock and wakes up the waiting producers
+        void FinishPop(std::unique_lock<std::mutex>& lock, size_t nItems)
+        {
+            m_size.store(m_items.size(), std::memory_order_release);
+            const int nWaiting = m_waitingProducers;
+            lock.unlock();
+            if (nWaiting == 1 || (nWaiting > 1 && nItems == 1)) {
+                m_notFull.notify_one();
+            }
+            else if (nWaiting > 1) {
+                m_notFull.notify_all();
+            }
+        }
+    };
+
+    /** A first-in-first-out queue with a fixed capacity which several threads can add items
+        to and retrieve items from at the same time without taking any lock. Each slot in the
+        buffer carries a sequence number which tells if the slot is free to be written or ready
+        to be read, and the producers (and consumers) reserve a slot with one compare-and-swap
+        on the shared write (read) position. Nothing ever waits, adding an item to a full buffer
+        or retrieving an item from an empty buffer fails at once.
+        The capacity is rounded up to the nearest power of two. */
+    template<class T>
+    struct RingBuffer
+    {
+    public:
+        RingBuffer(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity) {
+                size *= 2;
+            }
+            m_mask = size - 1;
+            m_slots.reset(new Slot[size]);
+            for (size_t k = 0; k < size; ++k) {
+                m_slots[k].sequence.store(k, std::memory_order_relaxed);
+            }
+        }
+
+        /** Adds an item to the end of the buffer.
+            The item is only moved from if it was added.
+            @return true if the item was added, false if the buffer is full. */
+        bool TryPush(T& item)
+        {
+            size_t position = m_writePosition.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = m_slots[position & m_mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+                if (difference == 0) {
+                    if (m_writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        slot.item = std::move(item);
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0) {
+                    return false; // full
+                }
+                else {
+                    position = m_writePosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** Retrieves the first item in the buffer.
+            @return true if an item was retrieved, false if the buffer is empty. */
+        bool TryPop(T& item)
+        {
+            size_t position = m_readPosition.load(std::memory_order_relaxed);
+            while (true) {
+                Slot& slot = m_slots[position & m_mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)(position + 1);
+                if (difference == 0) {
+                    if (m_readPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        item = std::move(slot.item);
+                        slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0) {
+                    return false; // empty
+                }
+                else {
+                    position = m_readPosition.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /** @return the number of items the buffer can hold */
+        size_t Capacity() const {
+            return m_mask + 1;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T item;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_mask = 0;
+
+        // the producers and the consumers update different positions, keep them on different cache lines
+        alignas(64) std::atomic<size_t> m_writePosition{ 0 };
+        alignas(64) std::atomic<size_t> m_readPosition{ 0 };
+    };
+
+    /** A set of job queues, one per worker thread, where each worker takes the jobs
+        from its own queue and steals jobs from the other workers' queues once its
+        own queue runs empty. Each job carries an estimated cost. Jobs added
+        through Distribute are dealt out longest-first to the queue with the
+        least total remaining cost, such that the expensive jobs are started
+        early and no single worker is left with a long tail of work. */
+    template<class T>
+    struct WorkStealingQueue
+    {
+    public:
+        WorkStealingQueue()
+            : m_queues() { }
+
+        /** Removes all jobs and sets the number of worker queues to use.
+            This must not be called while any worker is retrieving jobs. */
+        void Reset(size_t nWorkers)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            m_queues.clear();
+            for (size_t k = 0; k < std::max(nWorkers, (size_t)1); ++k)
+            {
+                m_queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+            }
+        }
+
+        /** Adds a job to the end of the queue of the given worker. */
+        void AddItem(size_t workerIndex, T item, double cost)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            WorkerQueue& queue = *m_queues[workerIndex % m_queues.size()];
+            std::lock_guard<std::mutex> queueLock(queue.guard);
+            queue.items.push_back(Job{ std::move(item), cost });
+            queue.remainingCost += cost;
+        }
+
+        /** Adds the given jobs, ordered by decreasing cost, each to the queue
+            of the worker with the least total remaining cost. */
+        void Distribute(std::vector<std::pair<T, double>> jobs)
+        {
+            std::stable_sort(begin(jobs), end(jobs), [](const std::pair<T, double>& j1, const std::pair<T, double>& j2) { return j1.second > j2.second; });
+
+            std::lock_guard<std::mutex> lock(guard);
+            for (std::pair<T, double>& job : jobs)
+            {
+                WorkerQueue* cheapest = m_queues.front().get();
+                for (auto& queue : m_queues)
+                {
+                    if (queue->remainingCost < cheapest->remainingCost)
+                    {
+                        cheapest = queue.get();
+                    }
+                }
+                std::lock_guard<std::mutex> queueLock(cheapest->guard);
+                cheapest->items.push_back(Job{ std::move(job.first), job.second });
+                cheapest->remainingCost += job.second;
+            }
+        }
+
+        /** Retrieves the next job for the given worker. This is the first job in the
+            worker's own queue or, if that is empty, the first job in the queue of the
+            worker with the largest total remaining cost.
+            @return true if a job was retrieved, false if there are no jobs left. */
+        bool PopFront(size_t workerIndex, T& item)
+        {
+            if (m_queues.size() == 0)
+            {
+                return false;
+            }
+            if (PopFrom(*m_queues[workerIndex % m_queues.size()], item))
+            {
+                return true;
+            }
+
+            // steal from the worker with the most work left
+            while (true)
+            {
+                WorkerQueue* victim = nullptr;
+                double largestCost = 0.0;
+                for (auto& queue : m_queues)
+                {
+                    std::lock_guard<std::mutex> queueLock(queue->guard);
+                    if (queue->items.size() > 0 && (victim == nullptr || queue->remainingCost > largestCost))
+                    {
+                        victim = queue.get();
+                        largestCost = queue->remainingCost;
+                    }
+                }
+                if (victim == nullptr)
+                {
+                    return false;
+                }
+                if (PopFrom(*victim, item))
+                {
+                    return true;
+                }
+            }
+        }
+
+        /** @return the total number of jobs left in all the queues. */
+        size_t Size()
+        {
+            size_t size = 0;
+            for (auto& queue : m_queues)
+            {
+                std::lock_guard<std::mutex> queueLock(queue->guard);
+                size += queue->items.size();
+            }
+            return size;
+        }
+
+    private:
+        struct Job
+        {
+            T item;
+            double cost;
+        };
+
+        struct WorkerQueue
+        {
+            std::deque<Job> items;
+            double remainingCost = 0.0;
+            std::mutex guard;
+        };
+
+        static bool PopFrom(WorkerQueue& queue, T& item)
+        {
+            std::lock_guard<std::mutex> queueLock(queue.guard);
+            if (queue.items.size() == 0)
+            {
+                return false;
+            }
+            item = std::move(queue.items.front().item);
+            queue.remainingCost -= queue.items.front().cost;
+            queue.items.pop_front();
+            return true;
+        }
+
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+
+        // serializes the adding of jobs, such that the balancing in Distribute sees a consistent state
+        std::mutex guard;
+    };
+
+    /** Sorts the items using a stable sort (items which compare equal keep their
+        relative order). The items are split into one block per thread, the blocks
+        are sorted in parallel and then merged pairwise, also in parallel.
+        @param nThreads the maximum number of threads to use, including the calling thread. */
+    template<class T, class Compare>
+    void ParallelStableSort(std::vector<T>& items, Compare comp, size_t nThreads)
+    {
+        // not worth the overhead of starting threads for the small blocks
+        const size_t minBlockSize = 4096;
+
+        const size_t nBlocks = std::max((size_t)1, std::min(nThreads, items.size() / minBlockSize));
+        if (nBlocks == 1)
+        {
+            std::stable_sort(begin(items), end(items), comp);
+            return;
+        }
+
+        std::vector<size_t> blockStart(nBlocks + 1);
+        for (size_t k = 0; k <= nBlocks; ++k)
+        {
+            blockStart[k] = (k * items.size()) / nBlocks;
+        }
+
+        // 1. Sort each of the blocks
+        std::vector<std::thread> sortThreads;
+        for (size_t k = 1; k < nBlocks; ++k)
+        {
+            sortThreads.push_back(std::thread([&items, &blockStart, &comp, k] {
+                std::stable_sort(begin(items) + blockStart[k], begin(items) + blockStart[k + 1], comp);
+            }));
+        }
+        std::stable_sort(begin(items), begin(items) + blockStart[1], comp);
+        for (std::thread& t : sortThreads)
+        {
+            t.join();
+        }
+
+        // 2. Merge neighbouring blocks until there is only one left.
+        //  The merge keeps the items of the left block first, which keeps the sort stable.
+        for (size_t width = 1; width < nBlocks; width *= 2)
+        {
+            std::vector<std::thread> mergeThreads;
+            for (size_t k = 0; k + width < nBlocks; k += 2 * width)
+            {
+                const size_t first = blockStart[k];
+                const size_t middle = blockStart[k + width];
+                const size_t last = blockStart[std::min(k + 2 * width, nBlocks)];
+                mergeThreads.push_back(std::thread([&items, &comp, first, middle, last] {
+                    std::inplace_merge(begin(items) + first, begin(items) + middle, begin(items) + last, comp);
+                }));
+            }
+            for (std::thread& t : mergeThreads)
+            {
+                t.join();
+            }
+        }
+    }
+
 }  // namespace novac
 
 #endif  // NOVAC_PPPLIB_THREAD_UTILS_H
\ No newline at end of file
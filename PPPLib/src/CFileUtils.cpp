@@ -1,5 +1,7 @@
 #include <PPPLib/CFileUtils.h>
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <cstring>
 
 #ifdef _MSC_VER
@@ -25,105 +27,281 @@ namespace novac
 		}
 	}
 
-	bool CFileUtils::GetInfoFromFileName(const CString fileName, CDateTime &start, CString &serial, int &channel, MEASUREMENT_MODE &mode)
+	// Retrieves the next token in the file-name, using the underscores as separators.
+	//	This follows CString::Tokenize, 'position' is set to -1 once the last token has been read.
+	//	@return false if there are no more tokens.
+	static bool NextToken(const char* name, size_t length, int& position, const char*& token, size_t& tokenLength)
 	{
-		CString name, sDate, sTime, resToken;
-		int iDate, iTime;
-		int curPos = 0;
+		if (position < 0 || (size_t)position >= length)
+		{
+			return false;
+		}
 
-		// set to default values
-		start = CDateTime();
-		serial = "";
-		channel = 0;
-		mode = MODE_FLUX;
+		size_t start = (size_t)position;
+		const char* separator = (const char*)memchr(name + start, '_', length - start);
+		if (nullptr == separator)
+		{
+			return false;
+		}
 
-		// make a local copy of the filename
-		name.Format(fileName);
+		if (separator == name + start)
+		{
+			// skip the separators, the last token is the remainder of the name
+			while (start < length && name[start] == '_')
+			{
+				++start;
+			}
+			separator = (start < length) ? (const char*)memchr(name + start, '_', length - start) : nullptr;
+			if (nullptr == separator)
+			{
+				position = -1;
+				token = name + start;
+				tokenLength = length - start;
+				return tokenLength > 0;
+			}
+		}
 
-		// remove the name of the path
-		GetFileName(name);
+		position = (int)(separator - name);
+		token = name + start;
+		tokenLength = (size_t)(separator - token);
+		return tokenLength > 0;
+	}
 
-		// Tokenize the file-name using the underscores as separators
-		resToken = name.Tokenize("_", curPos);
-		if (resToken == "")
+	// Reads the integer at the start of the token, in the same way as sscanf("%d").
+	//	@return false if the token does not start with a number, 'value' is then not changed.
+	static bool ParseInteger(const char* token, size_t tokenLength, int& value)
+	{
+		size_t pos = 0;
+		while (pos < tokenLength && isspace((unsigned char)token[pos]))
+		{
+			++pos;
+		}
+
+		bool negative = false;
+		if (pos < tokenLength && (token[pos] == '-' || token[pos] == '+'))
+		{
+			negative = (token[pos] == '-');
+			++pos;
+		}
+		if (pos >= tokenLength || !isdigit((unsigned char)token[pos]))
+		{
 			return false;
-		serial.Format(resToken);
+		}
+
+		int result = 0;
+		while (pos < tokenLength && isdigit((unsigned char)token[pos]))
+		{
+			result = 10 * result + (token[pos] - '0');
+			++pos;
+		}
+		value = negative ? -result : result;
+		return true;
+	}
+
+	// @return true if the token starts with the given four characters, without regard to case.
+	static bool StartsWith(const char* token, size_t tokenLength, const char prefix[4])
+	{
+		if (tokenLength < 4)
+		{
+			return false;
+		}
+		for (int k = 0; k < 4; ++k)
+		{
+			if (tolower((unsigned char)token[k]) != prefix[k])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool ParseFileName(const char* name, size_t length, CFileNameInfo& info)
+	{
+		const char* token = nullptr;
+		size_t tokenLength = 0;
+		int curPos = 0;
+		int iDate = 0;
+		int iTime = 0;
+
+		// set to default values
+		info = CFileNameInfo();
+
+		// The first part is the serial. A serial which is too long is not copied,
+		//	but the rest of the name is parsed anyway.
+		if (!NextToken(name, length, curPos, token, tokenLength))
+			return false;
+		info.serialLength = tokenLength;
+		if (tokenLength <= CFileNameInfo::MaxSerialLength)
+		{
+			memcpy(info.serial, token, tokenLength);
+			info.serial[tokenLength] = '\0';
+		}
 
 		if (curPos == -1)
 			return false;
 
 		// The second part is the date
-		resToken = name.Tokenize("_", curPos);
-		if (resToken == "")
+		if (!NextToken(name, length, curPos, token, tokenLength))
 			return false;
-		sscanf(resToken, "%d", &iDate);
-		start.year = (unsigned char)(iDate / 10000);
-		start.month = (unsigned char)((iDate - start.year * 10000) / 100);
-		start.day = (unsigned char)(iDate % 100);
-		start.year += 2000;
+		ParseInteger(token, tokenLength, iDate);
+		info.startTime.year = (unsigned char)(iDate / 10000);
+		info.startTime.month = (unsigned char)((iDate - info.startTime.year * 10000) / 100);
+		info.startTime.day = (unsigned char)(iDate % 100);
+		info.startTime.year += 2000;
 
 		if (curPos == -1)
 			return false;
 
 		// The third part is the time
-		resToken = name.Tokenize("_", curPos);
-		if (resToken == "")
+		if (!NextToken(name, length, curPos, token, tokenLength))
 			return false;
-		sscanf(resToken, "%d", &iTime);
-		start.hour = (unsigned char)(iTime / 100);
-		start.minute = (unsigned char)((iTime - start.hour * 100));
-		start.second = 0;
+		ParseInteger(token, tokenLength, iTime);
+		info.startTime.hour = (unsigned char)(iTime / 100);
+		info.startTime.minute = (unsigned char)((iTime - info.startTime.hour * 100));
+		info.startTime.second = 0;
 
 		if (curPos == -1)
 			return false;
 
 		// The fourth part is the channel
-		resToken = name.Tokenize("_", curPos);
-		if (resToken == "")
+		if (!NextToken(name, length, curPos, token, tokenLength))
 			return false;
-		sscanf(resToken, "%d", &channel);
+		ParseInteger(token, tokenLength, info.channel);
 
 		if (curPos == -1)
 			return true;
 
 		// The fifth part is the measurement mode. This is however not always available...
-		resToken = name.Tokenize("_", curPos);
-		if (resToken == "")
+		if (!NextToken(name, length, curPos, token, tokenLength))
 			return false;
-		if (Equals(resToken, "flux", 4)) {
-			mode = MODE_FLUX;
-		}
-		else if (Equals(resToken, "wind", 4)) {
-			mode = MODE_WINDSPEED;
+		if (StartsWith(token, tokenLength, "flux")) {
+			info.mode = MODE_FLUX;
 		}
-		else if (Equals(resToken, "stra", 4)) {
-			mode = MODE_STRATOSPHERE;
+		else if (StartsWith(token, tokenLength, "wind")) {
+			info.mode = MODE_WINDSPEED;
 		}
-		else if (Equals(resToken, "dsun", 4)) {
-			mode = MODE_DIRECT_SUN;
+		else if (StartsWith(token, tokenLength, "stra")) {
+			info.mode = MODE_STRATOSPHERE;
 		}
-		else if (Equals(resToken, "comp", 4)) {
-			mode = MODE_COMPOSITION;
+		else if (StartsWith(token, tokenLength, "dsun")) {
+			info.mode = MODE_DIRECT_SUN;
 		}
-		else if (Equals(resToken, "luna", 4)) {
-			mode = MODE_LUNAR;
+		else if (StartsWith(token, tokenLength, "comp")) {
+			info.mode = MODE_COMPOSITION;
 		}
-		else if (Equals(resToken, "trop", 4)) {
-			mode = MODE_TROPOSPHERE;
+		else if (StartsWith(token, tokenLength, "luna")) {
+			info.mode = MODE_LUNAR;
 		}
-		else if (Equals(resToken, "maxd", 4)) {
-			mode = MODE_MAXDOAS;
+		else if (StartsWith(token, tokenLength, "trop")) {
+			info.mode = MODE_TROPOSPHERE;
 		}
-		else if (Equals(resToken, "unkn", 4)) {
-			mode = MODE_UNKNOWN;
+		else if (StartsWith(token, tokenLength, "maxd")) {
+			info.mode = MODE_MAXDOAS;
 		}
 		else {
-			mode = MODE_UNKNOWN;
+			info.mode = MODE_UNKNOWN;
 		}
 
 		return true;
 	}
 
+	// The number of file names remembered by GetInfoFromFileName, must be a power of two
+	static const size_t s_fileNameCacheSize = 256;
+
+	struct CachedFileName
+	{
+		// The file name, without the path. Longer names are not remembered.
+		char name[64];
+		size_t length = 0;
+
+		bool result = false;
+		CFileNameInfo info;
+	};
+
+	// @return the file name without the path, 'nameLength' is set to its number of characters.
+	static const char* RemovePath(const char* fileName, size_t length, size_t& nameLength)
+	{
+		size_t nameStart = length;
+		while (nameStart > 0 && fileName[nameStart - 1] != '/' && fileName[nameStart - 1] != '\\')
+		{
+			--nameStart;
+		}
+		nameLength = length - nameStart;
+		return fileName + nameStart;
+	}
+
+	// Parses the file name (without the path) as ParseFileName, but remembers the result.
+	//	The result does not depend on the length of the serial.
+	static bool ParseFileNameCached(const char* name, size_t nameLength, CFileNameInfo& info)
+	{
+		// look for the name among the recently parsed names. The names are kept separately for each thread,
+		//	such that no locking is necessary, and are replaced as new names are parsed.
+		static thread_local CachedFileName cache[s_fileNameCacheSize];
+
+		uint32_t hash = 2166136261u;
+		for (size_t k = 0; k < nameLength; ++k)
+		{
+			hash = (hash ^ (unsigned char)name[k]) * 16777619u;
+		}
+		CachedFileName& entry = cache[hash & (s_fileNameCacheSize - 1)];
+
+		if (entry.length == nameLength && nameLength > 0 && 0 == memcmp(entry.name, name, nameLength))
+		{
+			info = entry.info;
+			return entry.result;
+		}
+
+		const bool result = ParseFileName(name, nameLength, info);
+
+		if (nameLength <= sizeof(entry.name))
+		{
+			memcpy(entry.name, name, nameLength);
+			entry.length = nameLength;
+			entry.result = result;
+			entry.info = info;
+		}
+
+		return result;
+	}
+
+	bool CFileUtils::GetInfoFromFileName(const char* fileName, size_t length, CFileNameInfo& info)
+	{
+		size_t nameLength = 0;
+		const char* name = RemovePath(fileName, length, nameLength);
+
+		const bool result = ParseFileNameCached(name, nameLength, info);
+
+		return result && info.serialLength <= CFileNameInfo::MaxSerialLength;
+	}
+
+	bool CFileUtils::GetInfoFromFileName(const CString& fileName, CDateTime &start, CString &serial, int &channel, MEASUREMENT_MODE &mode)
+	{
+		size_t nameLength = 0;
+		const char* name = RemovePath(fileName.c_str(), fileName.GetLength(), nameLength);
+
+		CFileNameInfo info;
+		const bool result = ParseFileNameCached(name, nameLength, info);
+
+		start = info.startTime;
+		if (info.serialLength <= CFileNameInfo::MaxSerialLength)
+		{
+			serial.SetData(info.serial);
+		}
+		else
+		{
+			// the serial didn't fit in CFileNameInfo, take it from the file name
+			int position = 0;
+			const char* token = nullptr;
+			size_t tokenLength = 0;
+			NextToken(name, nameLength, position, token, tokenLength);
+			serial.SetData(std::string(token, tokenLength));
+		}
+		channel = info.channel;
+		mode = info.mode;
+
+		return result;
+	}
+
 	bool CFileUtils::IsIncompleteFile(const novac::CString& fileName)
 	{
 		if (strstr((const char*)fileName, "Incomplete")) {
@@ -1,8 +1,11 @@
 #include "PPPLib/CStdioFile.h"
-#include <vector>
+#include <cstring>
 
 namespace novac
 {
+	// The size of the blocks in which the file is read
+	static const size_t s_blockSize = 65536;
+
 	CStdioFile::CStdioFile()
 	{
 	}
@@ -19,7 +22,10 @@ namespace novac
 
 	bool CStdioFile::Open(const char* fileName, unsigned nOpenFlags, CFileException* /*ex*/)
 	{
-		m_f.open(fileName, (std::ios_base::openmode)nOpenFlags);
+		// The file is always read in binary mode, the line endings are handled when reading the lines.
+		m_f.open(fileName, (std::ios_base::openmode)nOpenFlags | std::ios_base::binary);
+		m_begin = 0;
+		m_end = 0;
 
 		return m_f.is_open();
 	}
@@ -27,38 +33,132 @@ namespace novac
 	void CStdioFile::Close()
 	{
 		m_f.close();
+		m_begin = 0;
+		m_end = 0;
 	}
 
-	bool CStdioFile::ReadString(char* destination, unsigned int nMax)
+	bool CStdioFile::FillBuffer()
 	{
-		if (!m_f.is_open() || m_f.eof())
+		if (!m_f.is_open())
 		{
 			return false;
 		}
-		else
+
+		if (m_begin > 0)
+		{
+			memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+			m_end -= m_begin;
+			m_begin = 0;
+		}
+
+		// one byte is always kept free, such that the last line can be null-terminated
+		if (m_buffer.size() < s_blockSize)
+		{
+			m_buffer.resize(s_blockSize);
+		}
+		else if (m_end + 1 >= m_buffer.size())
+		{
+			m_buffer.resize(2 * m_buffer.size()); // the line does not fit in the buffer
+		}
+
+		m_f.read(m_buffer.data() + m_end, m_buffer.size() - 1 - m_end);
+		const size_t nRead = (size_t)m_f.gcount();
+		m_end += nRead;
+
+		return nRead > 0;
+	}
+
+	bool CStdioFile::FindLine(size_t& lineLength, size_t& nextLine)
+	{
+		size_t searchFrom = 0; // relative to m_begin, since FillBuffer() moves the data
+		while (true)
 		{
-			m_f.getline(destination, nMax, '\n');
-			return true;
+			if (m_begin + searchFrom < m_end)
+			{
+				const char* start = m_buffer.data() + m_begin + searchFrom;
+				const char* newLine = (const char*)memchr(start, '\n', m_end - m_begin - searchFrom);
+				if (nullptr != newLine)
+				{
+					const size_t newLinePosition = (size_t)(newLine - m_buffer.data());
+					lineLength = newLinePosition - m_begin;
+					if (lineLength > 0 && m_buffer[newLinePosition - 1] == '\r')
+					{
+						--lineLength;
+					}
+					nextLine = newLinePosition + 1;
+					return true;
+				}
+			}
+			searchFrom = m_end - m_begin;
+
+			if (!FillBuffer())
+			{
+				if (m_begin == m_end)
+				{
+					return false;
+				}
+
+				// the last line of the file does not end with a new-line
+				lineLength = m_end - m_begin;
+				if (m_buffer[m_end - 1] == '\r')
+				{
+					--lineLength;
+				}
+				nextLine = m_end;
+				return true;
+			}
 		}
 	}
 
-	bool CStdioFile::ReadString(CString& destination)
+	bool CStdioFile::ReadLine(const char*& line, size_t& length)
 	{
-		if (!m_f.is_open() || m_f.eof())
+		size_t nextLine = 0;
+		if (!FindLine(length, nextLine))
 		{
 			return false;
 		}
-		else
+
+		m_buffer[m_begin + length] = '\0';
+		line = m_buffer.data() + m_begin;
+		m_begin = nextLine;
+
+		return true;
+	}
+
+	bool CStdioFile::ReadString(char* destination, unsigned int nMax)
+	{
+		size_t lineLength = 0;
+		size_t nextLine = 0;
+		if (nMax == 0 || !FindLine(lineLength, nextLine))
+		{
+			return false;
+		}
+
+		if (lineLength > nMax - 1)
 		{
-			// TODO: This is formally a bit of cheating, this doesn't read the full string....
-			const size_t maxSize = 65535;
+			// the remainder of the line is returned by the next call
+			lineLength = nMax - 1;
+			nextLine = m_begin + lineLength;
+		}
 
-			std::vector<char> tmpBuffer(maxSize);
-			m_f.getline(tmpBuffer.data(), maxSize);
+		memcpy(destination, m_buffer.data() + m_begin, lineLength);
+		destination[lineLength] = '\0';
+		m_begin = nextLine;
 
-			destination.SetData(tmpBuffer.data());
+		return true;
+	}
 
-			return true;
+	bool CStdioFile::ReadString(CString& destination)
+	{
+		const char* line = nullptr;
+		size_t length = 0;
+		if (!ReadLine(line, length))
+		{
+			return false;
 		}
+
+		destination.SetData(line);
+
+		return true;
 	}
-}
\ No newline at end of file
+}
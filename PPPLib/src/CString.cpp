@@ -47,85 +47,110 @@ namespace novac
 
     // --------------------- Formatting -----------------------
 
+    // The size of the buffer on the stack which the formatted strings are first written into.
+    //  Only longer strings require an additional allocation.
+#define LOCAL_STACK_BUFFER_SIZE 1024
+
+    // Formats the string using the given arguments and appends the result to 'str'.
+    //  The arguments may point into 'str' itself, 'str' is only changed once the formatting is done.
+    static void AppendFormatted(std::string& str, const char* format, va_list args)
+    {
+        // First try to write into a stack-buffer, this also gives us the length of the result
+        char localStackBuffer[LOCAL_STACK_BUFFER_SIZE];
+
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        const int length = vsnprintf(localStackBuffer, LOCAL_STACK_BUFFER_SIZE, format, args);
+
+        if (length < 0)
+        {
+            // formatting error, nothing to append
+        }
+        else if (length < LOCAL_STACK_BUFFER_SIZE)
+        {
+            // It fit fine so we're done.
+            str.append(localStackBuffer, (size_t)length);
+        }
+        else
+        {
+            // The stack-buffer was too small, format again into a buffer of exactly the right size.
+            std::string heapBuffer((size_t)length + 1, '\0');
+            vsnprintf(&heapBuffer[0], heapBuffer.size(), format, argsCopy);
+            str.append(heapBuffer.data(), (size_t)length);
+        }
+
+        va_end(argsCopy);
+    }
+
     CString CString::FormatString(const char* format, ...)
     {
         CString str;
 
-        std::vector<char> localBuffer(65535);
-
         va_list args;
         va_start(args, format);
-        vsprintf(localBuffer.data(), format, args);
+        AppendFormatted(str.m_data, format, args);
         va_end(args);
 
-        str.m_data = std::string{ localBuffer.data() };
-
         return str;
     }
 
     void CString::Format(const char * format, ...)
     {
-        std::vector<char> localBuffer(65535);
+        std::string result;
 
         va_list args;
         va_start(args, format);
-        vsprintf(localBuffer.data(), format, args);
+        AppendFormatted(result, format, args);
         va_end(args);
 
-        m_data = std::string{ localBuffer.data() };
+        m_data.swap(result);
     }
 
-#define LOCAL_STACK_BUFFER_SIZE 1024
     CString& CString::AppendFormat(const char *format, ...)
     {
-        // First try to write into a stack-buffer
-        char localStackBuffer[LOCAL_STACK_BUFFER_SIZE];
-
         va_list args;
         va_start(args, format);
-        const int bytesWritten = vsprintf(localStackBuffer, format, args);
+        AppendFormatted(m_data, format, args);
         va_end(args);
 
-        if (bytesWritten <= LOCAL_STACK_BUFFER_SIZE && bytesWritten >= 0)
-        {
-            // It fit fine so we're done.
-            m_data = this->m_data + std::string{ localStackBuffer, (size_t)bytesWritten };
-            return *this;
-        }
-        else
-        {
-            // We failed to use the stack-buffer, use a much larger heap-buffer.
-            //   point is that this should happen much more infrequently
-            std::vector<char> heapBuffer(65535);
-
-            va_start(args, format);
-            vsprintf(heapBuffer.data(), format, args);
-            va_end(args);
-
-            m_data = this->m_data + std::string{ heapBuffer.data() };
-
-            return *this;
-        }
+        return *this;
     }
 
     CString& CString::Append(const CString& other)
     {
-        this->m_data = this->m_data + other.m_data;
+        this->m_data.append(other.m_data);
         return *this;
     }
 
     CString& CString::Append(const char* other)
     {
-        this->m_data = this->m_data + std::string(other);
+        this->m_data.append(other);
         return *this;
     }
 
     CString& CString::Append(const std::string& other)
     {
-        this->m_data = this->m_data + other;
+        this->m_data.append(other);
         return *this;
     }
 
+    CString& CString::Append(const char* other, size_t length)
+    {
+        this->m_data.append(other, length);
+        return *this;
+    }
+
+    CString& CString::Append(char character)
+    {
+        this->m_data.push_back(character);
+        return *this;
+    }
+
+    void CString::Reserve(size_t capacity)
+    {
+        this->m_data.reserve(capacity);
+    }
+
     CString CString::Left(int nChars) const
     {
         return Left((size_t)(nChars));
@@ -370,25 +395,23 @@ namespace novac
 
     void CleanString(const CString &in, CString &out)
     {
-        std::vector<char> buffer(strlen(in) + 2);
-
-        for (size_t it = 0; it < in.GetLength(); ++it)
-        {
-            buffer[it] = in.GetAt(it);
-        }
-        CleanString(buffer.data(), out);
+        CleanString(in.c_str(), out);
     }
 
     void CleanString(const char *in, CString &out)
     {
-        out.Format("");
-        for (unsigned int it = 0; it < strlen(in); ++it)
+        // build the result separately, 'in' may point into 'out'
+        std::string result;
+        const size_t length = strlen(in);
+        result.reserve(length);
+        for (size_t it = 0; it < length; ++it)
         {
             if ((unsigned char)in[it] >= 32)
             {
-                out.AppendFormat("%c", in[it]);
+                result.push_back(in[it]);
             }
         }
+        out.SetData(result);
     }
 
     void SimplifyString(const CString& in, CString& out)
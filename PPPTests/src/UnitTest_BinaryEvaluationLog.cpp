@@ -0,0 +1,105 @@
+#include "catch.hpp"
+#include <Common/BinaryEvaluationLog.h>
+#include <cstdio>
+#include <string>
+
+namespace novac
+{
+	static const char* s_binaryLogFileName = "UnitTest_BinaryEvaluationLog.txt.bin";
+	static const char* s_textLogFileName = "UnitTest_BinaryEvaluationLog.txt";
+
+	static std::string ReadTextFile(const char* fileName)
+	{
+		std::string contents;
+		FILE* f = fopen(fileName, "r");
+		REQUIRE(f != nullptr);
+		char buffer[4096];
+		size_t length = 0;
+		while ((length = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		{
+			contents.append(buffer, length);
+		}
+		fclose(f);
+		return contents;
+	}
+
+	// Builds a binary log in the same way as the CPostEvaluationController does
+	//  and returns the text evaluation log which was written next to it.
+	static std::string BuildEvaluationLog(FileHandler::CBinaryEvaluationLog& binaryLog)
+	{
+		const char* header[] = {
+			"<scaninformation>\n\tdate=2019.03.18\n\tstarttime=09:12:03\n\tcompass=165.0\n\ttilt=0.0\n\tspectrometer=I2J5678\n</scaninformation>\n",
+			"<fluxinfo>\n\tflux=12.34\n\twindspeed=10.00\n\twinddirection=165.00\n\tplumeheight=1000.00\n</fluxinfo>\n",
+			"#scanangle\tstarttime\tstoptime\tname\tspecsaturation\tfitsaturation\tcounts_ms\tdelta\tchisquare\texposuretime\tnumspec\tcolumn(SO2)\tcolumnerror(SO2)\tshift(SO2)\tshifterror(SO2)\tsqueeze(SO2)\tsqueezeerror(SO2)\tisgoodpoint\toffset\tflag",
+		};
+		const char* lines[] = {
+			"0\t09:12:03\t09:12:06\tsky\t0.65\t0.60\t352.17\t0.00e+00\t0.00e+00\t150\t15\t0.0\t0.0\t0.0\t0.0\t0.0\t0.0\t1\t0.00e+00\t0",
+			"0\t09:12:07\t09:12:08\tdark\t0.01\t0.01\t0.63\t0.00e+00\t0.00e+00\t150\t15\t0.0\t0.0\t0.0\t0.0\t0.0\t0.0\t1\t0.00e+00\t0",
+			"-90\t09:12:10\t09:12:14\tscan\t0.62\t0.58\t338.41\t1.25e-02\t3.12e-04\t150\t15\t1.23e+17\t4.56e+15\t0.12\t0.03\t1.00\t0.00\t1\t-2.50e+01\t0",
+			"-86\t09:12:15\t09:12:19\tscan\t0.61\t0.57\t331.02\t1.31e-02\t3.50e-04\t150\t15\t-2.01e+16\t4.44e+15\t-0.05\t0.03\t1.00\t0.00\t1\t-2.63e+01\t0",
+			"-82\t09:12:20\t09:12:24\tscan\t0.63\t0.59\t341.95\t9.87e-03\t2.71e-04\t150\t15\t3.14e+18\t5.02e+15\t0.20\t0.02\t1.00\t0.00\t0\t-2.41e+01\t0",
+		};
+
+		std::string original;
+		for (const char* text : header)
+		{
+			binaryLog.AppendText(text);
+			original.append(text);
+		}
+		binaryLog.AppendText("\n<spectraldata>\n");
+		original.append("\n<spectraldata>\n");
+
+		for (const char* line : lines)
+		{
+			binaryLog.AppendSpectrumLine(line);
+			original.append(line);
+			original.append("\n");
+		}
+
+		binaryLog.AppendText("</spectraldata>\n");
+		original.append("</spectraldata>\n");
+
+		return original;
+	}
+
+	TEST_CASE("CBinaryEvaluationLog regenerates the text evaluation log", "[BinaryEvaluationLog]")
+	{
+		FileHandler::CBinaryEvaluationLog binaryLog;
+		const std::string original = BuildEvaluationLog(binaryLog);
+
+		SECTION("Regenerated log is identical to the original")
+		{
+			REQUIRE(SUCCESS == binaryLog.WriteToFile(s_binaryLogFileName));
+
+			FileHandler::CBinaryEvaluationLog restoredLog;
+			REQUIRE(SUCCESS == restoredLog.ReadFromFile(s_binaryLogFileName));
+			REQUIRE(restoredLog.LineNum() == 5);
+			REQUIRE(restoredLog.IsTextLine(0) == true); // the sky spectrum has no fit-result
+			REQUIRE(restoredLog.IsTextLine(2) == false);
+			REQUIRE(restoredLog.IsTextLine(4) == false);
+
+			REQUIRE(SUCCESS == restoredLog.WriteTextLog(s_textLogFileName));
+			REQUIRE(ReadTextFile(s_textLogFileName) == original);
+		}
+
+		SECTION("Log which has not been written to file can also be regenerated")
+		{
+			REQUIRE(SUCCESS == binaryLog.WriteTextLog(s_textLogFileName));
+			REQUIRE(ReadTextFile(s_textLogFileName) == original);
+		}
+
+		SECTION("Fails if the file cannot be created")
+		{
+			REQUIRE(FAIL == binaryLog.WriteTextLog("nonexistent_directory/UnitTest_BinaryEvaluationLog.txt"));
+		}
+
+		remove(s_binaryLogFileName);
+		remove(s_textLogFileName);
+	}
+
+	TEST_CASE("CBinaryEvaluationLog GetFileName", "[BinaryEvaluationLog]")
+	{
+		REQUIRE(FileHandler::CBinaryEvaluationLog::GetFileName("scan_flux.txt").std_str() == "scan_flux.txt.bin");
+		REQUIRE(FileHandler::CBinaryEvaluationLog::GetFileName("scan_flux.txt.gz").std_str() == "scan_flux.txt.bin");
+	}
+}
@@ -1,5 +1,16 @@
 #include "catch.hpp"
 #include <PPPLib/CFileUtils.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4996)
+#endif
 
 namespace novac
 {
@@ -19,6 +30,14 @@ namespace novac
 			REQUIRE(serial.std_str() == "I2J98765");
 		}
 
+		SECTION("Keeps the full serial when it is longer than CFileNameInfo can hold")
+		{
+			REQUIRE(CFileUtils::GetInfoFromFileName("/novac/MAYP11435MAYP11435MAYP11435MAYP11435_170129_0317_1.pak", start, serial, channel, mode));
+			REQUIRE(serial.std_str() == "MAYP11435MAYP11435MAYP11435MAYP11435");
+			REQUIRE(start.hour == 3);
+			REQUIRE(channel == 1);
+		}
+
 		SECTION("Finds correct date")
 		{
 			CFileUtils::GetInfoFromFileName("D2J2134_170129_0317_1.pak", start, serial, channel, mode);
@@ -48,5 +67,267 @@ namespace novac
 			CFileUtils::GetInfoFromFileName("D2J2134_170129_0317_1_wind.pak", start, serial, channel, mode);
 			REQUIRE(mode == MODE_WINDSPEED);
 		}
+
+		SECTION("Removes the path")
+		{
+			CFileUtils::GetInfoFromFileName("C:\\Novac\\D2J_2134\\I2J98765_170129_0317_1.pak", start, serial, channel, mode);
+			REQUIRE(serial.std_str() == "I2J98765");
+			REQUIRE(start.day == 29);
+
+			CFileUtils::GetInfoFromFileName("/home/novac/D2J_2134/I2J98765_170129_0317_1.pak", start, serial, channel, mode);
+			REQUIRE(serial.std_str() == "I2J98765");
+			REQUIRE(channel == 1);
+		}
+
+		SECTION("Fails on incomplete names")
+		{
+			REQUIRE(CFileUtils::GetInfoFromFileName("D2J2134_170129_0317_1.pak", start, serial, channel, mode));
+			REQUIRE(CFileUtils::GetInfoFromFileName("D2J2134_170129_0317.pak", start, serial, channel, mode) == false);
+			REQUIRE(CFileUtils::GetInfoFromFileName("Upload.pak", start, serial, channel, mode) == false);
+			REQUIRE(CFileUtils::GetInfoFromFileName("", start, serial, channel, mode) == false);
+			REQUIRE(CFileUtils::GetInfoFromFileName("D2J2134_170129_0317_1_.pak", start, serial, channel, mode));
+			REQUIRE(CFileUtils::GetInfoFromFileName("D2J2134_170129_0317_1_", start, serial, channel, mode) == false);
+		}
+	}
+
+	// The parsing of the file names as it was done using CString::Tokenize, used to verify the allocation-free parsing
+	static bool ReferenceGetInfoFromFileName(const CString& fileName, CDateTime& start, CString& serial, int& channel, MEASUREMENT_MODE& mode)
+	{
+		CString name, resToken;
+		int iDate = 0, iTime = 0;
+		int curPos = 0;
+
+		start = CDateTime();
+		serial = "";
+		channel = 0;
+		mode = MODE_FLUX;
+
+		name.Format(fileName);
+		CFileUtils::GetFileName(name);
+
+		resToken = name.Tokenize("_", curPos);
+		if (resToken == "")
+			return false;
+		serial.Format(resToken);
+		if (curPos == -1)
+			return false;
+
+		resToken = name.Tokenize("_", curPos);
+		if (resToken == "")
+			return false;
+		sscanf(resToken, "%d", &iDate);
+		start.year = (unsigned char)(iDate / 10000);
+		start.month = (unsigned char)((iDate - start.year * 10000) / 100);
+		start.day = (unsigned char)(iDate % 100);
+		start.year += 2000;
+		if (curPos == -1)
+			return false;
+
+		resToken = name.Tokenize("_", curPos);
+		if (resToken == "")
+			return false;
+		sscanf(resToken, "%d", &iTime);
+		start.hour = (unsigned char)(iTime / 100);
+		start.minute = (unsigned char)((iTime - start.hour * 100));
+		start.second = 0;
+		if (curPos == -1)
+			return false;
+
+		resToken = name.Tokenize("_", curPos);
+		if (resToken == "")
+			return false;
+		sscanf(resToken, "%d", &channel);
+		if (curPos == -1)
+			return true;
+
+		resToken = name.Tokenize("_", curPos);
+		if (resToken == "")
+			return false;
+		const char* modes[] = { "flux", "wind", "stra", "dsun", "comp", "luna", "trop", "maxd" };
+		const MEASUREMENT_MODE modeValues[] = { MODE_FLUX, MODE_WINDSPEED, MODE_STRATOSPHERE, MODE_DIRECT_SUN, MODE_COMPOSITION, MODE_LUNAR, MODE_TROPOSPHERE, MODE_MAXDOAS };
+		mode = MODE_UNKNOWN;
+		for (int k = 0; k < 8; ++k)
+		{
+			if (Equals(resToken, modes[k], 4))
+			{
+				mode = modeValues[k];
+				break;
+			}
+		}
+		return true;
+	}
+
+	static std::vector<std::string> CreateFileNames(int count)
+	{
+		const char* serials[] = { "D2J2134", "I2J98765", "2009175M1", "D2J2200" };
+		const char* suffixes[] = { ".pak", "_wind.pak", "_0.txt", "_flux.txt", "_dsun_2.txt" };
+		std::vector<std::string> names;
+		char buffer[256];
+		for (int ii = 0; ii < count; ++ii)
+		{
+			snprintf(buffer, sizeof(buffer), "/novac/output/%s_%02d%02d%02d_%02d%02d_%d%s", serials[ii % 4], 10 + ii % 10, 1 + ii % 12, 1 + ii % 28, ii % 24, ii % 60, ii % 2, suffixes[ii % 5]);
+			names.push_back(buffer);
+		}
+		return names;
 	}
-}
\ No newline at end of file
+
+	TEST_CASE("GetInfoFromFileName gives the same result as CString::Tokenize", "[CFileUtils]")
+	{
+		std::vector<std::string> names = CreateFileNames(200);
+		const char* unusualNames[] = { "D2J2134_170129_0317_1.pak", "D2J2134__170129_0317_1.pak", "_D2J2134_170129_0317_1.pak",
+			"D2J2134_170129_0317_1_", "D2J2134_170129_0317_1__", "D2J2134_170129_0317_1_WIND.pak", "D2J2134_170129_0317_1_wi.pak",
+			"D2J2134_xx_0317_1.pak", "D2J2134", "D2J2134_", "___", "", "D2J2134_170129_0317_1_maxdoas_12.txt", "C:\\a\\b_c\\" };
+		for (const char* name : unusualNames)
+		{
+			names.push_back(name);
+		}
+
+		for (int pass = 0; pass < 2; ++pass) // the second pass uses the remembered results
+		{
+			for (const std::string& name : names)
+			{
+				CDateTime expectedStart, start;
+				CString expectedSerial, serial;
+				int expectedChannel = -1, channel = -1;
+				MEASUREMENT_MODE expectedMode = MODE_UNKNOWN, mode = MODE_UNKNOWN;
+
+				const bool expectedResult = ReferenceGetInfoFromFileName(CString(name), expectedStart, expectedSerial, expectedChannel, expectedMode);
+				const bool result = CFileUtils::GetInfoFromFileName(CString(name), start, serial, channel, mode);
+
+				INFO(name);
+				REQUIRE(result == expectedResult);
+				REQUIRE(serial.std_str() == expectedSerial.std_str());
+				REQUIRE(channel == expectedChannel);
+				REQUIRE(mode == expectedMode);
+				REQUIRE(start.year == expectedStart.year);
+				REQUIRE(start.month == expectedStart.month);
+				REQUIRE(start.day == expectedStart.day);
+				REQUIRE(start.hour == expectedStart.hour);
+				REQUIRE(start.minute == expectedStart.minute);
+				REQUIRE(start.second == expectedStart.second);
+			}
+		}
+	}
+
+	TEST_CASE("GetInfoFromFileName into CFileNameInfo behaves as expected", "[CFileUtils]")
+	{
+		CFileNameInfo info;
+
+		SECTION("Name need not be null-terminated")
+		{
+			const char* name = "D2J2134_170129_0317_1_wind.pak";
+			REQUIRE(CFileUtils::GetInfoFromFileName(name, strlen("D2J2134_170129_0317_1"), info));
+			REQUIRE(std::string(info.serial) == "D2J2134");
+			REQUIRE(info.channel == 1);
+			REQUIRE(info.mode == MODE_FLUX);
+		}
+
+		SECTION("Fails if the serial is too long")
+		{
+			const std::string name = "MAYP11435MAYP11435MAYP11435MAYP11435_170129_0317_1.pak";
+			REQUIRE(CFileUtils::GetInfoFromFileName(name.c_str(), name.size(), info) == false);
+			REQUIRE(std::string(info.serial) == "");
+			REQUIRE(info.serialLength == 36);
+			REQUIRE(info.channel == 1);
+
+			const std::string longestName = "I2J5678901234567_170129_0317_1.pak";
+			REQUIRE(CFileUtils::GetInfoFromFileName(longestName.c_str(), longestName.size(), info));
+			REQUIRE(std::string(info.serial) == "I2J5678901234567");
+		}
+
+		SECTION("Can be used from several threads")
+		{
+			const std::vector<std::string> names = CreateFileNames(1000);
+			std::vector<int> nCorrect(4, 0);
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; ++t)
+			{
+				threads.push_back(std::thread([&names, &nCorrect, t] {
+					CFileNameInfo threadInfo;
+					for (int repetition = 0; repetition < 3; ++repetition)
+					{
+						for (size_t ii = 0; ii < names.size(); ++ii)
+						{
+							CFileUtils::GetInfoFromFileName(names[ii].c_str(), names[ii].size(), threadInfo);
+							nCorrect[t] += (threadInfo.channel == (int)(ii % 2) && threadInfo.startTime.minute == ii % 60) ? 1 : 0;
+						}
+					}
+				}));
+			}
+			for (std::thread& t : threads)
+			{
+				t.join();
+			}
+
+			for (int t = 0; t < 4; ++t)
+			{
+				REQUIRE(nCorrect[t] == 3000);
+			}
+		}
+	}
+
+	// Compares the time needed to parse file names using CString::Tokenize with the allocation-free parsing.
+	//  This is hidden by default, run it using the tag [benchmark].
+	TEST_CASE("GetInfoFromFileName benchmark", "[.][benchmark]")
+	{
+		const int nRepetitions = 200;
+		const std::vector<std::string> distinctNames = CreateFileNames(100);
+		std::vector<CString> names;
+		for (const std::string& name : distinctNames)
+		{
+			names.push_back(CString(name));
+		}
+
+		CDateTime start;
+		CString serial;
+		int channel = 0;
+		MEASUREMENT_MODE mode;
+		int checksum[3] = { 0, 0, 0 };
+
+		auto startTime = std::chrono::steady_clock::now();
+		for (int repetition = 0; repetition < nRepetitions; ++repetition)
+		{
+			for (const CString& name : names)
+			{
+				ReferenceGetInfoFromFileName(name, start, serial, channel, mode);
+				checksum[0] += channel + start.minute;
+			}
+		}
+		const double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		startTime = std::chrono::steady_clock::now();
+		for (int repetition = 0; repetition < nRepetitions; ++repetition)
+		{
+			for (const CString& name : names)
+			{
+				CFileUtils::GetInfoFromFileName(name, start, serial, channel, mode);
+				checksum[1] += channel + start.minute;
+			}
+		}
+		const double cStringSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		CFileNameInfo info;
+		startTime = std::chrono::steady_clock::now();
+		for (int repetition = 0; repetition < nRepetitions; ++repetition)
+		{
+			for (const std::string& name : distinctNames)
+			{
+				CFileUtils::GetInfoFromFileName(name.c_str(), name.size(), info);
+				checksum[2] += info.channel + info.startTime.minute;
+			}
+		}
+		const double infoSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+		const double nCalls = (double)nRepetitions * names.size();
+		std::cout << "GetInfoFromFileName, ns per call. Tokenize: " << 1e9 * referenceSeconds / nCalls
+			<< ", CString: " << 1e9 * cStringSeconds / nCalls
+			<< ", CFileNameInfo: " << 1e9 * infoSeconds / nCalls << std::endl;
+
+		REQUIRE(checksum[1] == checksum[0]);
+		REQUIRE(checksum[2] == checksum[0]);
+	}
+}
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
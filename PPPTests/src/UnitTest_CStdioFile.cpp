@@ -0,0 +1,163 @@
+#include "catch.hpp"
+#include <PPPLib/CStdioFile.h>
+#include <cstdio>
+#include <string>
+
+namespace novac
+{
+	static const char* s_testFileName = "UnitTest_CStdioFile.txt";
+
+	static void WriteTestFile(const std::string& contents)
+	{
+		FILE* f = fopen(s_testFileName, "wb");
+		REQUIRE(f != nullptr);
+		fwrite(contents.c_str(), 1, contents.size(), f);
+		fclose(f);
+	}
+
+	TEST_CASE("CStdioFile ReadString behaves as expected", "[CStdioFile]")
+	{
+		CStdioFile file;
+		CString line;
+
+		SECTION("Reads lines ending with LF and CRLF")
+		{
+			WriteTestFile("first\nsecond\r\n\nlast");
+			REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead | CStdioFile::typeText));
+
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "first");
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "second");
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "");
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "last");
+			REQUIRE(file.ReadString(line) == false);
+		}
+
+		SECTION("Final new-line does not give an extra line")
+		{
+			WriteTestFile("first\r\nsecond\r\n");
+			REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead));
+
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "first");
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "second");
+			REQUIRE(file.ReadString(line) == false);
+		}
+
+		SECTION("Empty file returns nothing")
+		{
+			WriteTestFile("");
+			REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead));
+
+			REQUIRE(file.ReadString(line) == false);
+		}
+
+		SECTION("Closed file returns nothing")
+		{
+			REQUIRE(file.ReadString(line) == false);
+		}
+
+		SECTION("Reads lines longer than the buffer")
+		{
+			const std::string longLine1(200000, 'a');
+			const std::string longLine2(70000, 'b');
+			WriteTestFile("short\n" + longLine1 + "\r\n" + longLine2 + "\nend\n");
+			REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead));
+
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "short");
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == longLine1);
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == longLine2);
+			REQUIRE(file.ReadString(line));
+			REQUIRE(line.std_str() == "end");
+			REQUIRE(file.ReadString(line) == false);
+		}
+
+		SECTION("Reads many lines across the block boundaries")
+		{
+			std::string contents;
+			for (int ii = 0; ii < 20000; ++ii)
+			{
+				contents += "line " + std::to_string(ii) + ((ii % 2 == 0) ? "\r\n" : "\n");
+			}
+			WriteTestFile(contents);
+			REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead));
+
+			int nLinesRead = 0;
+			bool allCorrect = true;
+			while (file.ReadString(line))
+			{
+				allCorrect = allCorrect && (line.std_str() == "line " + std::to_string(nLinesRead));
+				++nLinesRead;
+			}
+
+			REQUIRE(allCorrect);
+			REQUIRE(nLinesRead == 20000);
+		}
+
+		file.Close();
+		remove(s_testFileName);
+	}
+
+	TEST_CASE("CStdioFile ReadString into buffer behaves as expected", "[CStdioFile]")
+	{
+		CStdioFile file;
+		char buffer[8];
+
+		SECTION("Reads lines shorter than the buffer")
+		{
+			WriteTestFile("abc\r\ndefg\n");
+			REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead));
+
+			REQUIRE(file.ReadString(buffer, 8));
+			REQUIRE(std::string(buffer) == "abc");
+			REQUIRE(file.ReadString(buffer, 8));
+			REQUIRE(std::string(buffer) == "defg");
+			REQUIRE(file.ReadString(buffer, 8) == false);
+		}
+
+		SECTION("Long lines are returned in pieces")
+		{
+			WriteTestFile("0123456789abc\nnext");
+			REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead));
+
+			REQUIRE(file.ReadString(buffer, 8));
+			REQUIRE(std::string(buffer) == "0123456");
+			REQUIRE(file.ReadString(buffer, 8));
+			REQUIRE(std::string(buffer) == "789abc");
+			REQUIRE(file.ReadString(buffer, 8));
+			REQUIRE(std::string(buffer) == "next");
+			REQUIRE(file.ReadString(buffer, 8) == false);
+		}
+
+		file.Close();
+		remove(s_testFileName);
+	}
+
+	TEST_CASE("CStdioFile ReadLine behaves as expected", "[CStdioFile]")
+	{
+		CStdioFile file;
+		const char* line = nullptr;
+		size_t length = 0;
+
+		WriteTestFile("first\r\nsecond");
+		REQUIRE(file.Open(s_testFileName, CStdioFile::modeRead));
+
+		REQUIRE(file.ReadLine(line, length));
+		REQUIRE(length == 5);
+		REQUIRE(std::string(line) == "first");
+		REQUIRE(file.ReadLine(line, length));
+		REQUIRE(length == 6);
+		REQUIRE(std::string(line) == "second");
+		REQUIRE(file.ReadLine(line, length) == false);
+
+		file.Close();
+		remove(s_testFileName);
+	}
+}
@@ -145,6 +145,75 @@ namespace novac
 
 			REQUIRE(sut.ToStdString() == original);
 		}
+
+		SECTION("Numbers")
+		{
+			CString sut;
+			sut.Format("%d_%04d_%.2lf_%.2e_%c", -17, 42, 3.14159, 12345.678, 'x');
+
+			REQUIRE(sut.ToStdString() == "-17_0042_3.14_1.23e+04_x");
+		}
+
+		SECTION("Replaces previous contents")
+		{
+			CString sut{ original };
+			sut.Format("%s", "lamb");
+
+			REQUIRE(sut.ToStdString() == "lamb");
+		}
+
+		SECTION("Empty result")
+		{
+			CString sut{ original };
+			sut.Format("");
+
+			REQUIRE(sut.GetLength() == 0);
+		}
+
+		SECTION("Result longer than the stack buffer")
+		{
+			const std::string longString(5000, 'a');
+
+			CString sut;
+			sut.Format("<%s>", longString.c_str());
+
+			REQUIRE(sut.ToStdString() == "<" + longString + ">");
+		}
+
+		SECTION("Result longer than 65535 characters")
+		{
+			const std::string longString(100000, 'b');
+
+			CString sut;
+			sut.Format("%s%s", longString.c_str(), longString.c_str());
+
+			REQUIRE(sut.GetLength() == 200000);
+			REQUIRE(sut.ToStdString() == longString + longString);
+		}
+
+		SECTION("Own contents as argument")
+		{
+			CString sut{ original };
+			sut.Format("%s, %s", (const char*)sut, (const char*)sut);
+
+			REQUIRE(sut.ToStdString() == original + ", " + original);
+		}
+
+		SECTION("Own long contents as argument")
+		{
+			CString sut{ std::string(3000, 'c') };
+			sut.Format("%s-%s", (const char*)sut, (const char*)sut);
+
+			REQUIRE(sut.ToStdString() == std::string(3000, 'c') + "-" + std::string(3000, 'c'));
+		}
+
+		SECTION("FormatString")
+		{
+			const std::string longString(2000, 'd');
+
+			REQUIRE(CString::FormatString("%s %d", original.c_str(), 7).ToStdString() == original + " 7");
+			REQUIRE(CString::FormatString("%s", longString.c_str()).ToStdString() == longString);
+		}
 	}
 
 	TEST_CASE("AppendFormat behaves as expected", "[CString]")
@@ -172,6 +241,45 @@ namespace novac
 
 			REQUIRE(sut.ToStdString() == first + second);
 		}
+
+		SECTION("Many small appends")
+		{
+			std::string expected;
+			CString sut;
+			for (int k = 0; k < 1000; ++k)
+			{
+				sut.AppendFormat("%d,", k);
+				expected += std::to_string(k) + ",";
+			}
+
+			REQUIRE(sut.ToStdString() == expected);
+		}
+
+		SECTION("Result longer than the stack buffer")
+		{
+			const std::string longString(5000, 'a');
+
+			CString sut{ first };
+			sut.AppendFormat("%s", longString.c_str());
+
+			REQUIRE(sut.ToStdString() == first + longString);
+		}
+
+		SECTION("Own contents as argument")
+		{
+			CString sut{ first };
+			sut.AppendFormat("|%s", (const char*)sut);
+
+			REQUIRE(sut.ToStdString() == first + "|" + first);
+		}
+
+		SECTION("Own long contents as argument")
+		{
+			CString sut{ std::string(3000, 'c') };
+			sut.AppendFormat("|%s", (const char*)sut);
+
+			REQUIRE(sut.ToStdString() == std::string(3000, 'c') + "|" + std::string(3000, 'c'));
+		}
 	}
 
 	TEST_CASE("Append behaves as expected", "[CString]")
@@ -184,6 +292,60 @@ namespace novac
 			first.Append(second);
 			REQUIRE(first.ToStdString() == "Twinkle, twinkle little starMary had a little lamb");
 		}
+
+		SECTION("Part of char array")
+		{
+			first.Append(" and the lamb", 4);
+			REQUIRE(first.ToStdString() == "Twinkle, twinkle little star and");
+		}
+
+		SECTION("Single characters")
+		{
+			first.Reserve(100);
+			first.Append('!');
+			first.Append('?');
+			REQUIRE(first.ToStdString() == "Twinkle, twinkle little star!?");
+		}
+
+		SECTION("Own contents")
+		{
+			first.Append(first);
+			REQUIRE(first.ToStdString() == "Twinkle, twinkle little starTwinkle, twinkle little star");
+		}
+	}
+
+	TEST_CASE("CleanString behaves as expected", "[CString]")
+	{
+		SECTION("Removes control characters")
+		{
+			CString out;
+			CleanString("\tTwinkle,\r\n twinkle\x01", out);
+			REQUIRE(out.ToStdString() == "Twinkle, twinkle");
+		}
+
+		SECTION("Keeps characters above 127")
+		{
+			const char in[] = { 'a', (char)0xE5, '\n', 'b', 0 };
+			CString out;
+			CleanString(in, out);
+			REQUIRE(out.GetLength() == 3);
+			REQUIRE(out.GetAt(1) == (char)0xE5);
+		}
+
+		SECTION("CString input")
+		{
+			CString in{ "\ttwinkle\n" };
+			CString out{ "previous contents" };
+			CleanString(in, out);
+			REQUIRE(out.ToStdString() == "twinkle");
+		}
+
+		SECTION("Same string as input and output")
+		{
+			CString str{ "\ttwinkle\n little\tstar" };
+			CleanString(str, str);
+			REQUIRE(str.ToStdString() == "twinkle littlestar");
+		}
 	}
 
 	TEST_CASE("Trim behaves as expected", "[CString]")
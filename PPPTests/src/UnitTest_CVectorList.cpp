@@ -0,0 +1,333 @@
+#include <PPPLib/CVectorList.h>
+#include <PPPLib/CString.h>
+#include "catch.hpp"
+
+namespace novac
+{
+	TEST_CASE("VECTOR_POSITION")
+	{
+		SECTION("Construction from nullptr")
+		{
+			VECTOR_POSITION<int> p2 = nullptr;
+
+			REQUIRE_FALSE(p2.HasNext());
+		}
+
+		SECTION("Assignment to nullptr, does not alter list")
+		{
+			CVectorList<int> originalList;
+			originalList.AddTail(1);
+			originalList.AddTail(2);
+
+			VECTOR_POSITION<int> sut = originalList.GetHeadPosition();
+
+			REQUIRE(originalList.GetSize() == 2);
+
+			sut = nullptr;
+
+			REQUIRE(originalList.GetSize() == 2);
+			REQUIRE_FALSE(sut.HasNext());
+		}
+
+		SECTION("Remains valid when the list grows")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(1);
+			sut.AddTail(2);
+
+			auto p = sut.GetHeadPosition();
+			sut.GetNext(p);
+
+			for (int k = 3; k < 1000; ++k)
+			{
+				sut.AddTail(k);
+			}
+
+			REQUIRE(2 == sut.GetAt(p));
+			REQUIRE(1 == p.GetIndex());
+		}
+	}
+
+	TEST_CASE("VECTOR_REVERSE_POSITION")
+	{
+		SECTION("Construction from nullptr")
+		{
+			VECTOR_REVERSE_POSITION<int> p2 = nullptr;
+
+			REQUIRE_FALSE(p2.HasPrevious());
+		}
+	}
+
+	TEST_CASE("CVectorList Construction behaves as expected", "[CVectorList]")
+	{
+		SECTION("Default constructor")
+		{
+			CVectorList<int> defaultContructedCList;
+			REQUIRE(defaultContructedCList.GetSize() == 0);
+			REQUIRE(defaultContructedCList.GetCount() == 0);
+		}
+	}
+
+	TEST_CASE("CVectorList append and remove behaves as expected", "[CVectorList]")
+	{
+		SECTION("AddTail - increases size")
+		{
+			CVectorList<int> sut;
+			REQUIRE(0 == sut.GetSize());
+			sut.AddTail(2);
+			REQUIRE(1 == sut.GetSize());
+		}
+
+		SECTION("AddTail - appends new element")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(2);
+
+			auto p = sut.GetTailPosition();
+			REQUIRE(2 == sut.GetAt(p));
+		}
+
+		SECTION("AddHead - increases size")
+		{
+			CVectorList<int> sut;
+			REQUIRE(0 == sut.GetSize());
+			sut.AddHead(2);
+			REQUIRE(1 == sut.GetSize());
+		}
+
+		SECTION("AddHead - appends new element")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(4);
+			sut.AddHead(2);
+
+			auto p = sut.GetHeadPosition();
+			REQUIRE(2 == sut.GetAt(p));
+		}
+
+		SECTION("RemoveTail - removes last element")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(2);
+			sut.AddTail(4);
+			sut.AddTail(8);
+			REQUIRE(3 == sut.GetSize());
+
+			sut.RemoveTail();
+
+			REQUIRE(2 == sut.GetSize());
+
+			auto p = sut.GetTailPosition();
+			REQUIRE(4 == sut.GetAt(p));
+		}
+
+		SECTION("RemoveAll - removes all elements")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(2);
+			sut.AddTail(4);
+
+			sut.RemoveAll();
+
+			REQUIRE(0 == sut.GetSize());
+			REQUIRE_FALSE(sut.GetHeadPosition().HasNext());
+			REQUIRE_FALSE(sut.GetTailPosition().HasPrevious());
+		}
+
+		SECTION("InsertBefore - inserts one element before")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(2);
+
+			auto p = sut.GetHeadPosition();
+
+			sut.InsertBefore(p, 3);
+
+			REQUIRE(2 == sut.GetSize());
+
+			auto newHead = sut.GetHeadPosition();
+			REQUIRE(3 == sut.GetAt(newHead));
+		}
+
+		SECTION("InsertBefore - position keeps pointing at the same element")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(1);
+			sut.AddTail(2);
+			sut.AddTail(4);
+
+			auto p = sut.GetHeadPosition();
+			sut.GetNext(p);
+			sut.GetNext(p);
+			sut.InsertBefore(p, 3);
+
+			REQUIRE(4 == sut.GetAt(p));
+			for (int k = 0; k < 4; ++k)
+			{
+				REQUIRE(k + 1 == sut.GetAt(k));
+			}
+		}
+	}
+
+	TEST_CASE("CVectorList indexed access behaves as expected", "[CVectorList]")
+	{
+		CVectorList<CString, CString&> sut;
+		sut.AddTail(CString("anders"));
+		sut.AddTail(CString("berit"));
+		sut.AddTail(CString("calle"));
+
+		SECTION("GetAt - returns element with index")
+		{
+			REQUIRE(sut.GetAt(0).ToStdString() == "anders");
+			REQUIRE(sut.GetAt(2).ToStdString() == "calle");
+		}
+
+		SECTION("GetAt - element can be changed")
+		{
+			sut.GetAt(1) = CString("bertil");
+
+			auto p = sut.GetHeadPosition();
+			sut.GetNext(p);
+			REQUIRE(sut.GetAt(p).ToStdString() == "bertil");
+		}
+
+		SECTION("GetNext - returns reference to element")
+		{
+			auto p = sut.GetHeadPosition();
+			sut.GetNext(p).Append("son");
+
+			REQUIRE(sut.GetAt(0).ToStdString() == "andersson");
+		}
+	}
+
+	TEST_CASE("CVectorList iteration behaves as expected", "[CVectorList]")
+	{
+		SECTION("Empty list")
+		{
+			CVectorList<CString> sut;
+			int nItems = 0;
+
+			auto p = sut.GetHeadPosition();
+			while (p.HasNext())
+			{
+				++nItems;
+
+				sut.GetNext(p);
+			}
+
+			REQUIRE(0 == nItems);
+		}
+
+		SECTION("Forward in 5 item list")
+		{
+			CVectorList<CString> sut;
+			sut.AddTail(CString("anders"));
+			sut.AddTail(CString("berit"));
+			sut.AddTail(CString("calle"));
+			sut.AddTail(CString("dennis"));
+			sut.AddTail(CString("eva"));
+
+			std::string allItems;
+			int nItems = 0;
+
+			auto p = sut.GetHeadPosition();
+			while (p.HasNext())
+			{
+				++nItems;
+
+				allItems += sut.GetNext(p).ToStdString();
+			}
+
+			REQUIRE(5 == nItems);
+			REQUIRE("andersberitcalledenniseva" == allItems);
+		}
+
+		SECTION("Forward in 5 item list - Comparison with nullptr")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(1);
+			sut.AddTail(2);
+			sut.AddTail(3);
+			sut.AddTail(4);
+			sut.AddTail(5);
+
+			int nItems = 0;
+
+			auto p = sut.GetHeadPosition();
+			while (p != nullptr)
+			{
+				++nItems;
+
+				sut.GetNext(p);
+			}
+
+			REQUIRE(5 == nItems);
+		}
+
+		SECTION("Forward in const list")
+		{
+			CVectorList<int> list;
+			list.AddTail(1);
+			list.AddTail(2);
+			list.AddTail(3);
+			const CVectorList<int>& sut = list;
+
+			int sum = 0;
+
+			auto p = sut.GetHeadPosition();
+			while (p != nullptr)
+			{
+				sum += sut.GetNext(p);
+			}
+
+			REQUIRE(6 == sum);
+		}
+
+		SECTION("Backwards in 5 item list")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(1);
+			sut.AddTail(2);
+			sut.AddTail(3);
+			sut.AddTail(4);
+			sut.AddTail(5);
+
+			int nItems = 0;
+			int previous = 6;
+
+			auto p = sut.GetTailPosition();
+			while (p.HasPrevious())
+			{
+				++nItems;
+
+				const int item = sut.GetPrev(p);
+				REQUIRE(previous - 1 == item);
+				previous = item;
+			}
+
+			REQUIRE(5 == nItems);
+		}
+
+		SECTION("Backwards in 5 item list - Comparison with nullptr")
+		{
+			CVectorList<int> sut;
+			sut.AddTail(1);
+			sut.AddTail(2);
+			sut.AddTail(3);
+			sut.AddTail(4);
+			sut.AddTail(5);
+
+			int nItems = 0;
+
+			auto p = sut.GetTailPosition();
+			while (p != nullptr)
+			{
+				++nItems;
+
+				sut.GetPrev(p);
+			}
+
+			REQUIRE(5 == nItems);
+		}
+	}
+}
@@ -0,0 +1,652 @@
+#include <PPPLib/ThreadUtils.h>
+#include <chrono>
+#include <iostream>
+#include "catch.hpp"
+
+namespace novac
+{
+	struct SortItem
+	{
+		int key;
+		int originalIndex;
+	};
+
+	static bool CompareByKey(const SortItem& item1, const SortItem& item2)
+	{
+		return item1.key < item2.key;
+	}
+
+	static std::vector<SortItem> CreateItemsToSort(int count, int nDistinctKeys)
+	{
+		std::vector<SortItem> items;
+		for (int ii = 0; ii < count; ++ii)
+		{
+			SortItem item;
+			item.key = (ii * 7919) % nDistinctKeys;
+			item.originalIndex = ii;
+			items.push_back(item);
+		}
+		return items;
+	}
+
+	static bool IsStablySorted(const std::vector<SortItem>& items)
+	{
+		for (size_t ii = 1; ii < items.size(); ++ii)
+		{
+			if (items[ii].key < items[ii - 1].key)
+			{
+				return false;
+			}
+			if (items[ii].key == items[ii - 1].key && items[ii].originalIndex < items[ii - 1].originalIndex)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	TEST_CASE("ParallelStableSort behaves as expected", "[ThreadUtils]")
+	{
+		SECTION("Empty list")
+		{
+			std::vector<SortItem> items;
+			ParallelStableSort(items, CompareByKey, 4);
+
+			REQUIRE(items.size() == 0);
+		}
+
+		SECTION("Small list is sorted")
+		{
+			std::vector<SortItem> items = CreateItemsToSort(100, 10);
+			ParallelStableSort(items, CompareByKey, 4);
+
+			REQUIRE(items.size() == 100);
+			REQUIRE(IsStablySorted(items));
+		}
+
+		SECTION("Large list is sorted using one thread")
+		{
+			std::vector<SortItem> items = CreateItemsToSort(50000, 1000);
+			ParallelStableSort(items, CompareByKey, 1);
+
+			REQUIRE(items.size() == 50000);
+			REQUIRE(IsStablySorted(items));
+		}
+
+		SECTION("Large list is sorted using several threads")
+		{
+			std::vector<SortItem> items = CreateItemsToSort(50000, 1000);
+			ParallelStableSort(items, CompareByKey, 5);
+
+			REQUIRE(items.size() == 50000);
+			REQUIRE(IsStablySorted(items));
+		}
+
+		SECTION("Already sorted list is unchanged")
+		{
+			std::vector<SortItem> items = CreateItemsToSort(20000, 20000);
+			std::stable_sort(begin(items), end(items), CompareByKey);
+			std::vector<SortItem> expected = items;
+
+			ParallelStableSort(items, CompareByKey, 3);
+
+			REQUIRE(items.size() == expected.size());
+			for (size_t ii = 0; ii < items.size(); ++ii)
+			{
+				REQUIRE(items[ii].originalIndex == expected[ii].originalIndex);
+			}
+		}
+	}
+
+	TEST_CASE("RingBuffer behaves as expected", "[ThreadUtils]")
+	{
+		SECTION("Capacity is rounded up to a power of two")
+		{
+			RingBuffer<int> buffer(5);
+
+			REQUIRE(buffer.Capacity() == 8);
+		}
+
+		SECTION("Empty buffer returns nothing")
+		{
+			RingBuffer<int> buffer(4);
+			int item = 0;
+
+			REQUIRE(buffer.TryPop(item) == false);
+		}
+
+		SECTION("Items are returned in order")
+		{
+			RingBuffer<int> buffer(4);
+			for (int ii = 1; ii <= 3; ++ii)
+			{
+				REQUIRE(buffer.TryPush(ii));
+			}
+
+			int item = 0;
+			REQUIRE(buffer.TryPop(item));
+			REQUIRE(item == 1);
+			REQUIRE(buffer.TryPop(item));
+			REQUIRE(item == 2);
+			REQUIRE(buffer.TryPop(item));
+			REQUIRE(item == 3);
+			REQUIRE(buffer.TryPop(item) == false);
+		}
+
+		SECTION("Full buffer rejects new items")
+		{
+			RingBuffer<int> buffer(4);
+			for (int ii = 0; ii < 4; ++ii)
+			{
+				REQUIRE(buffer.TryPush(ii));
+			}
+			int rejected = 4;
+			REQUIRE(buffer.TryPush(rejected) == false);
+
+			int item = 0;
+			REQUIRE(buffer.TryPop(item));
+			REQUIRE(item == 0);
+			REQUIRE(buffer.TryPush(rejected));
+		}
+
+		SECTION("Full buffer keeps the rejected item")
+		{
+			RingBuffer<std::string> buffer(2);
+			std::string first = "first";
+			std::string second = "second";
+			std::string third = "third";
+			REQUIRE(buffer.TryPush(first));
+			REQUIRE(buffer.TryPush(second));
+
+			REQUIRE(buffer.TryPush(third) == false);
+			REQUIRE(third == "third");
+
+			std::string item;
+			REQUIRE(buffer.TryPop(item));
+			REQUIRE(item == "first");
+			REQUIRE(buffer.TryPush(third));
+			REQUIRE(third.empty());
+		}
+
+		SECTION("All items from several producers are received")
+		{
+			const int nProducers = 4;
+			const int itemsPerProducer = 20000;
+			RingBuffer<int> buffer(64);
+
+			std::vector<std::thread> producers;
+			for (int producer = 0; producer < nProducers; ++producer)
+			{
+				producers.push_back(std::thread([&buffer, producer, itemsPerProducer] {
+					for (int ii = 0; ii < itemsPerProducer; ++ii)
+					{
+						int item = producer * itemsPerProducer + ii;
+						while (!buffer.TryPush(item))
+						{
+							std::this_thread::yield();
+						}
+					}
+				}));
+			}
+
+			std::vector<int> received(nProducers * itemsPerProducer, 0);
+			std::vector<int> lastFromProducer(nProducers, -1);
+			bool inOrder = true;
+			for (int nReceived = 0; nReceived < nProducers * itemsPerProducer; )
+			{
+				int item = 0;
+				if (buffer.TryPop(item))
+				{
+					++received[item];
+					inOrder = inOrder && (item % itemsPerProducer > lastFromProducer[item / itemsPerProducer]);
+					lastFromProducer[item / itemsPerProducer] = item % itemsPerProducer;
+					++nReceived;
+				}
+			}
+			for (std::thread& t : producers)
+			{
+				t.join();
+			}
+
+			REQUIRE(inOrder);
+			REQUIRE(std::count(begin(received), end(received), 1) == nProducers * itemsPerProducer);
+		}
+	}
+
+	TEST_CASE("BoundedQueue behaves as expected", "[ThreadUtils]")
+	{
+		SECTION("Items are returned in order")
+		{
+			BoundedQueue<int> queue(4);
+			REQUIRE(queue.Push(1));
+			REQUIRE(queue.Push(2));
+			REQUIRE(queue.Push(3));
+			REQUIRE(queue.Size() == 3);
+
+			int item = 0;
+			REQUIRE(queue.Pop(item));
+			REQUIRE(item == 1);
+			REQUIRE(queue.TryPop(item));
+			REQUIRE(item == 2);
+			REQUIRE(queue.Pop(item));
+			REQUIRE(item == 3);
+			REQUIRE(queue.TryPop(item) == false);
+			REQUIRE(queue.Size() == 0);
+		}
+
+		SECTION("Full queue rejects TryPush and keeps the item")
+		{
+			BoundedQueue<std::string> queue(2);
+			std::string first = "first";
+			std::string second = "second";
+			std::string third = "third";
+			REQUIRE(queue.TryPush(first));
+			REQUIRE(queue.TryPush(second));
+
+			REQUIRE(queue.TryPush(third) == false);
+			REQUIRE(third == "third");
+
+			std::string item;
+			REQUIRE(queue.TryPop(item));
+			REQUIRE(item == "first");
+			REQUIRE(queue.TryPush(third));
+		}
+
+		SECTION("Push waits until there is free space")
+		{
+			BoundedQueue<int> queue(1);
+			REQUIRE(queue.Push(1));
+
+			std::atomic<bool> pushed{ false };
+			std::thread producer([&queue, &pushed] {
+				queue.Push(2);
+				pushed = true;
+			});
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			REQUIRE(pushed == false);
+
+			int item = 0;
+			REQUIRE(queue.Pop(item));
+			REQUIRE(item == 1);
+			producer.join();
+
+			REQUIRE(pushed == true);
+			REQUIRE(queue.Pop(item));
+			REQUIRE(item == 2);
+		}
+
+		SECTION("Close wakes up the waiting consumers")
+		{
+			BoundedQueue<int> queue(4);
+			std::atomic<int> nFailedPops{ 0 };
+
+			std::vector<std::thread> consumers;
+			for (int ii = 0; ii < 3; ++ii)
+			{
+				consumers.push_back(std::thread([&queue, &nFailedPops] {
+					int item = 0;
+					if (!queue.Pop(item))
+					{
+						++nFailedPops;
+					}
+				}));
+			}
+
+			queue.Close();
+			for (std::thread& t : consumers)
+			{
+				t.join();
+			}
+
+			REQUIRE(nFailedPops == 3);
+			REQUIRE(queue.IsClosed());
+		}
+
+		SECTION("Closed queue rejects new items but returns the remaining ones")
+		{
+			BoundedQueue<int> queue(4);
+			REQUIRE(queue.Push(1));
+			REQUIRE(queue.Push(2));
+			queue.Close();
+
+			REQUIRE(queue.Push(3) == false);
+			int rejected = 4;
+			REQUIRE(queue.TryPush(rejected) == false);
+
+			int item = 0;
+			REQUIRE(queue.Pop(item));
+			REQUIRE(item == 1);
+			REQUIRE(queue.Pop(item));
+			REQUIRE(item == 2);
+			REQUIRE(queue.Pop(item) == false);
+		}
+
+		SECTION("PopBatch returns the available items in order")
+		{
+			BoundedQueue<int> queue(8);
+			for (int ii = 0; ii < 5; ++ii)
+			{
+				REQUIRE(queue.Push(ii));
+			}
+
+			std::vector<int> items;
+			REQUIRE(queue.PopBatch(items, 3) == 3);
+			REQUIRE(items == std::vector<int>({ 0, 1, 2 }));
+
+			REQUIRE(queue.TryPopBatch(items, 10) == 2);
+			REQUIRE(items == std::vector<int>({ 3, 4 }));
+
+			REQUIRE(queue.TryPopBatch(items, 10) == 0);
+			REQUIRE(items.size() == 0);
+
+			queue.Close();
+			REQUIRE(queue.PopBatch(items, 10) == 0);
+		}
+
+		SECTION("All items from several producers are received by several consumers")
+		{
+			const int nProducers = 4;
+			const int nConsumers = 3;
+			const int itemsPerProducer = 20000;
+			BoundedQueue<int> queue(16);
+
+			std::vector<std::thread> producers;
+			for (int producer = 0; producer < nProducers; ++producer)
+			{
+				producers.push_back(std::thread([&queue, producer, itemsPerProducer] {
+					for (int ii = 0; ii < itemsPerProducer; ++ii)
+					{
+						queue.Push(producer * itemsPerProducer + ii);
+					}
+				}));
+			}
+
+			std::vector<std::vector<int>> receivedByConsumer(nConsumers);
+			std::vector<std::thread> consumers;
+			for (int consumer = 0; consumer < nConsumers; ++consumer)
+			{
+				std::vector<int>& received = receivedByConsumer[consumer];
+				consumers.push_back(std::thread([&queue, &received, consumer] {
+					std::vector<int> batch;
+					int item = 0;
+					while (true)
+					{
+						// mix single and batch pops
+						if (consumer == 0)
+						{
+							if (!queue.Pop(item))
+							{
+								return;
+							}
+							received.push_back(item);
+						}
+						else
+						{
+							if (0 == queue.PopBatch(batch, 8))
+							{
+								return;
+							}
+							received.insert(end(received), begin(batch), end(batch));
+						}
+					}
+				}));
+			}
+
+			for (std::thread& t : producers)
+			{
+				t.join();
+			}
+			queue.Close();
+			for (std::thread& t : consumers)
+			{
+				t.join();
+			}
+
+			// every item is received exactly once and each consumer sees the items of each producer in order
+			std::vector<int> received(nProducers * itemsPerProducer, 0);
+			bool inOrder = true;
+			for (const std::vector<int>& consumerItems : receivedByConsumer)
+			{
+				std::vector<int> lastFromProducer(nProducers, -1);
+				for (int item : consumerItems)
+				{
+					++received[item];
+					inOrder = inOrder && (item % itemsPerProducer > lastFromProducer[item / itemsPerProducer]);
+					lastFromProducer[item / itemsPerProducer] = item % itemsPerProducer;
+				}
+			}
+
+			REQUIRE(inOrder);
+			REQUIRE(std::count(begin(received), end(received), 1) == nProducers * itemsPerProducer);
+			REQUIRE(queue.Size() == 0);
+		}
+	}
+
+	// Lets 'nThreads' workers drain the queue at the same time and counts how many times each job was retrieved
+	static std::vector<int> DrainInParallel(WorkStealingQueue<int>& queue, int nJobs, int nThreads)
+	{
+		std::vector<std::vector<int>> retrievedByThread(nThreads);
+		std::vector<std::thread> workers;
+		for (int threadIndex = 0; threadIndex < nThreads; ++threadIndex)
+		{
+			workers.push_back(std::thread([&queue, &retrievedByThread, threadIndex] {
+				int item = 0;
+				while (queue.PopFront((size_t)threadIndex, item))
+				{
+					retrievedByThread[threadIndex].push_back(item);
+				}
+			}));
+		}
+		for (std::thread& t : workers)
+		{
+			t.join();
+		}
+
+		std::vector<int> timesRetrieved(nJobs, 0);
+		for (const std::vector<int>& retrieved : retrievedByThread)
+		{
+			for (int item : retrieved)
+			{
+				++timesRetrieved[item];
+			}
+		}
+		return timesRetrieved;
+	}
+
+	TEST_CASE("WorkStealingQueue behaves as expected", "[ThreadUtils]")
+	{
+		WorkStealingQueue<int> queue;
+		int item = 0;
+
+		SECTION("Empty queue returns nothing")
+		{
+			REQUIRE(queue.PopFront(0, item) == false);
+
+			queue.Reset(2);
+			REQUIRE(queue.PopFront(0, item) == false);
+			REQUIRE(queue.PopFront(1, item) == false);
+			REQUIRE(queue.Size() == 0);
+		}
+
+		SECTION("Distributed jobs are returned longest first")
+		{
+			queue.Reset(1);
+			queue.Distribute({ { 0, 1.0 }, { 1, 5.0 }, { 2, 3.0 }, { 3, 5.0 }, { 4, 2.0 } });
+			REQUIRE(queue.Size() == 5);
+
+			// jobs with the same cost keep their order
+			const int expectedOrder[] = { 1, 3, 2, 4, 0 };
+			for (int expected : expectedOrder)
+			{
+				REQUIRE(queue.PopFront(0, item));
+				REQUIRE(item == expected);
+			}
+			REQUIRE(queue.PopFront(0, item) == false);
+		}
+
+		SECTION("Distributed jobs go to the worker with the least remaining cost")
+		{
+			queue.Reset(2);
+			queue.Distribute({ { 0, 4.0 }, { 1, 3.0 }, { 2, 2.0 }, { 3, 1.0 } });
+
+			// worker 0 gets the jobs costing 4 and 1, worker 1 the jobs costing 3 and 2
+			REQUIRE(queue.PopFront(0, item));
+			REQUIRE(item == 0);
+			REQUIRE(queue.PopFront(1, item));
+			REQUIRE(item == 1);
+			REQUIRE(queue.PopFront(1, item));
+			REQUIRE(item == 2);
+			REQUIRE(queue.PopFront(0, item));
+			REQUIRE(item == 3);
+			REQUIRE(queue.Size() == 0);
+		}
+
+		SECTION("Worker with an empty queue steals from the worker with the most remaining cost")
+		{
+			queue.Reset(3);
+			queue.AddItem(0, 0, 1.0);
+			queue.AddItem(0, 1, 2.0);
+			queue.AddItem(0, 2, 3.0);
+			queue.AddItem(1, 3, 10.0);
+
+			// worker 2 has nothing of its own, it first takes the only job of worker 1 (cost 10 > 6)
+			REQUIRE(queue.PopFront(2, item));
+			REQUIRE(item == 3);
+
+			// ... and then the first job of worker 0
+			REQUIRE(queue.PopFront(2, item));
+			REQUIRE(item == 0);
+
+			// worker 1 now steals as well, worker 0 takes the last job from its own queue
+			REQUIRE(queue.PopFront(1, item));
+			REQUIRE(item == 1);
+			REQUIRE(queue.PopFront(0, item));
+			REQUIRE(item == 2);
+
+			REQUIRE(queue.PopFront(0, item) == false);
+			REQUIRE(queue.PopFront(2, item) == false);
+			REQUIRE(queue.Size() == 0);
+		}
+
+		SECTION("Reset removes all jobs")
+		{
+			queue.Reset(2);
+			queue.AddItem(0, 1, 1.0);
+			queue.AddItem(1, 2, 1.0);
+
+			queue.Reset(2);
+			REQUIRE(queue.Size() == 0);
+			REQUIRE(queue.PopFront(0, item) == false);
+		}
+
+		SECTION("Every distributed job is retrieved exactly once by several workers")
+		{
+			const int nThreads = 4;
+			const int nJobs = 20000;
+			queue.Reset(nThreads);
+
+			std::vector<std::pair<int, double>> jobs;
+			for (int ii = 0; ii < nJobs; ++ii)
+			{
+				jobs.push_back(std::make_pair(ii, (double)((ii * 7919) % 100)));
+			}
+			queue.Distribute(jobs);
+
+			const std::vector<int> timesRetrieved = DrainInParallel(queue, nJobs, nThreads);
+
+			REQUIRE(std::count(begin(timesRetrieved), end(timesRetrieved), 1) == nJobs);
+			REQUIRE(queue.Size() == 0);
+		}
+
+		SECTION("Every job is retrieved exactly once when all workers but one must steal")
+		{
+			const int nThreads = 4;
+			const int nJobs = 20000;
+			queue.Reset(nThreads);
+			for (int ii = 0; ii < nJobs; ++ii)
+			{
+				queue.AddItem(0, ii, 1.0);
+			}
+
+			const std::vector<int> timesRetrieved = DrainInParallel(queue, nJobs, nThreads);
+
+			REQUIRE(std::count(begin(timesRetrieved), end(timesRetrieved), 1) == nJobs);
+			REQUIRE(queue.Size() == 0);
+		}
+	}
+
+	TEST_CASE("GuardedList CopyTo returns the items", "[ThreadUtils]")
+	{
+		GuardedList<int> list;
+		list.AddItem(1);
+		list.AddItem(2);
+		list.AddItem(3);
+
+		std::vector<int> copy = { 7, 8 };
+		list.CopyTo(copy);
+
+		REQUIRE(copy == std::vector<int>({ 1, 2, 3 }));
+	}
+
+	// Measures the throughput of the BoundedQueue with many producers and consumers.
+	//  This is hidden by default, run it using the tag [benchmark].
+	TEST_CASE("BoundedQueue contention benchmark", "[.][benchmark]")
+	{
+		const int nThreads = std::max(4, (int)std::thread::hardware_concurrency());
+		const int itemsPerProducer = 200000;
+		const size_t batchSizes[] = { 1, 16 };
+
+		for (size_t batchSize : batchSizes)
+		{
+			BoundedQueue<int> queue(64);
+			std::atomic<long long> sum{ 0 };
+
+			const auto startTime = std::chrono::steady_clock::now();
+
+			std::vector<std::thread> threads;
+			for (int ii = 0; ii < nThreads; ++ii)
+			{
+				threads.push_back(std::thread([&queue, itemsPerProducer] {
+					for (int jj = 0; jj < itemsPerProducer; ++jj)
+					{
+						queue.Push(jj);
+					}
+				}));
+			}
+			std::vector<std::thread> consumers;
+			for (int ii = 0; ii < nThreads; ++ii)
+			{
+				consumers.push_back(std::thread([&queue, &sum, batchSize] {
+					std::vector<int> batch;
+					long long localSum = 0;
+					while (queue.PopBatch(batch, batchSize) > 0)
+					{
+						for (int item : batch)
+						{
+							localSum += item;
+						}
+					}
+					sum += localSum;
+				}));
+			}
+
+			for (std::thread& t : threads)
+			{
+				t.join();
+			}
+			queue.Close();
+			for (std::thread& t : consumers)
+			{
+				t.join();
+			}
+
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			const double nItems = (double)nThreads * itemsPerProducer;
+			std::cout << nThreads << " producers and consumers, batch size " << batchSize << ": "
+				<< nItems / seconds / 1e6 << " million items per second" << std::endl;
+
+			REQUIRE(sum == (long long)nThreads * itemsPerProducer * (itemsPerProducer - 1) / 2);
+		}
+	}
+}